@@ -7,17 +7,28 @@
 #include <vulkan-cpp/vk_swapchain.hpp>
 #include <vulkan-cpp/vk_shader.hpp>
 #include <vulkan-cpp/vk_pipeline.hpp>
+#include <vulkan-cpp/vk_pipeline_registry.hpp>
 #include <vulkan-cpp/vk_vertex_buffer.hpp>
 #include <vulkan-cpp/vk_uniform_buffer.hpp>
 #include <vulkan-cpp/uniforms.hpp>
 #include <vulkan-cpp/vk_texture.hpp>
+#include <vulkan-cpp/vk_upload_batch.hpp>
+#include <vulkan-cpp/vk_staging_pool.hpp>
 #include <vulkan-cpp/vk_descriptor_set.hpp>
+#include <vulkan-cpp/vk_descriptor_cache.hpp>
+#include <vulkan-cpp/vk_descriptor_binder.hpp>
+#include <vulkan-cpp/vk_dynamic_state.hpp>
+#include <vulkan-cpp/vk_shader_watcher.hpp>
+#include <vulkan-cpp/vk_shader_bundle.hpp>
+#include <vulkan-cpp/vk_parallel_recorder.hpp>
+#include <vulkan-cpp/vk_static_chunk_cache.hpp>
 #include <imgui.h>
 #include <vulkan-cpp/vk_imgui.hpp>
 
 
 
 #include <tiny_obj_loader.h>
+#include <filesystem>
 #include <vulkan-cpp/perspective_camera.hpp>
 
 #define GLM_ENABLE_EXPERIMENTAL
@@ -185,22 +196,55 @@ main() {
       vk::vk_physical_driver(initiating_vulkan);
     vk::vk_driver main_driver = vk::vk_driver(main_physical_device);
 
+    //! @note Shared staging memory used for uploading textures
+    vk::vk_staging_pool staging_pool =
+      vk::vk_staging_pool(vk::vk_staging_pool::DefaultRetainedBytes);
+
     //! @note 4.) Initializing Swapchain
     vk::vk_swapchain main_window_swapchain =
-      vk::vk_swapchain(main_physical_device, main_driver, main_window);
+      vk::vk_swapchain(main_physical_device, main_driver, main_window, true);
     main_window_swapchain.set_background_color({ 0.f, 0.f, 0.f, 1.f });
 
-    vk::vk_shader test_shader = vk::vk_shader("shaders/vert.spv", "shaders/frag.spv");
-	// vk::vk_shader test_shader = vk::vk_shader("shader_useful_directory/geometry/vert.spv","shader_useful_directory/geometry/frag.spv");
-    test_shader.set_vertex_attributes({
-		{.location = 0, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = offsetof(vk::vertex, Position)},
-		{.location = 1, .binding = 0, .format = VK_FORMAT_R32G32B32A32_SFLOAT, .offset = offsetof(vk::vertex, Color)},
-		{.location = 2, .binding = 0, .format = VK_FORMAT_R32G32_SFLOAT, .offset = offsetof(vk::vertex, Uv)}
-    });
+    // every shader lives in one mapped bundle, repacked when a .spv is newer
+    std::vector<vk::shader_bundle_source> bundle_sources = {
+		vk::shader_bundle_source{
+			.Name = "shaders/vert.spv",
+			.Filename = "shaders/vert.spv",
+			.Stage = VK_SHADER_STAGE_VERTEX_BIT,
+			.VertexBindings = {
+				{.binding = 0, .stride = sizeof(vk::vertex), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX}
+			},
+			.VertexAttributes = {
+				{.location = 0, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = offsetof(vk::vertex, Position)},
+				{.location = 1, .binding = 0, .format = VK_FORMAT_R32G32B32A32_SFLOAT, .offset = offsetof(vk::vertex, Color)},
+				{.location = 2, .binding = 0, .format = VK_FORMAT_R32G32_SFLOAT, .offset = offsetof(vk::vertex, Uv)}
+			} },
+		vk::shader_bundle_source{
+			.Name = "shaders/frag.spv",
+			.Filename = "shaders/frag.spv",
+			.Stage = VK_SHADER_STAGE_FRAGMENT_BIT }
+	};
+	// every permutation that has been compiled goes in under its permutation_filename, variant() finds it there
+	for (uint32_t bits = 1; bits < (1u << vk::ShaderFeatureNames.size()); bits++) {
+		std::string vert_permutation = vk::permutation_filename("shaders/vert.spv", bits);
+		std::string frag_permutation = vk::permutation_filename("shaders/frag.spv", bits);
+		if (!std::filesystem::exists(vert_permutation) or !std::filesystem::exists(frag_permutation)) {
+			continue;
+		}
 
-	test_shader.set_vertex_bind_attributes({
-		{.binding = 0, .stride = sizeof(vk::vertex), .inputRate = VK_VERTEX_INPUT_RATE_VERTEX}
-	});
+		vk::shader_bundle_source vert_source = bundle_sources[0];
+		vert_source.Name = vert_permutation;
+		vert_source.Filename = vert_permutation;
+		bundle_sources.push_back(vert_source);
+		bundle_sources.push_back(vk::shader_bundle_source{ .Name = frag_permutation, .Filename = frag_permutation, .Stage = VK_SHADER_STAGE_FRAGMENT_BIT });
+	}
+	if (!vk::vk_shader_bundle::is_up_to_date("shaders/shaders.bundle", bundle_sources)) {
+		vk::vk_shader_bundle::write("shaders/shaders.bundle", bundle_sources);
+	}
+	vk::vk_shader_bundle shader_bundle = vk::vk_shader_bundle("shaders/shaders.bundle");
+
+    vk::vk_shader test_shader = vk::vk_shader(shader_bundle, "shaders/vert.spv", "shaders/frag.spv");
+	// vk::vk_shader test_shader = vk::vk_shader("shader_useful_directory/geometry/vert.spv","shader_useful_directory/geometry/frag.spv");
 
     // adding descriptor sets
     // creating our vertex and index buffers
@@ -209,11 +253,13 @@ main() {
     vk::vk_vertex_buffer test_vertex_buffer = new_mesh.get_vertex();
     vk::vk_index_buffer test_index_buffer = new_mesh.get_index();
 
-    uint32_t size_of_bytes = sizeof(camera_data_uniform);
+    // view-projection is per frame, the model matrix goes through push constants
+    uint32_t size_of_bytes = sizeof(global_frame_uniform);
 
-    // creating uniforms
+    // creating uniforms, one per frame in flight since a frame slot is only reused once the GPU is done with it
+    uint32_t frames_in_flight = vk::swapchain_configs::MaxFramesInFlight;
     std::vector<vk::vk_uniform_buffer> test_uniforms;
-    test_uniforms.resize(main_window_swapchain.image_size());
+    test_uniforms.resize(frames_in_flight);
 
     for (size_t i = 0; i < test_uniforms.size(); i++) {
         test_uniforms[i] = vk::vk_uniform_buffer(size_of_bytes);
@@ -227,20 +273,6 @@ main() {
        objects (like textures, etc)
     */
 
-    uint32_t image_count = main_window_swapchain.image_size();
-
-    //! @note Now without needing to manually set the layout bindings manually,
-    //! this will set up the descriptor sets automatically
-    // this descriptor set layout is for shaders/shader.*
-    /*
-	std::vector<vk::vk_descriptor_set_properties> descriptor_layouts = {
-        { "in_Vertices", 0, vk::descriptor_type::STORAGE_BUFFER, vk::shader_stage::VERTEX },
-        { "ubo", 1, vk::descriptor_type::UNIFORM_BUFFER, vk::shader_stage::VERTEX },
-        { "texSampler", 2, vk::descriptor_type::IMAGE_AND_SAMPLER, vk::shader_stage::FRAGMENT }
-    };
-
-    vk::vk_descriptor_set test_descriptor_sets = vk::vk_descriptor_set(image_count, descriptor_layouts);
-	*/
 	
 	/*
 	
@@ -248,32 +280,69 @@ main() {
 		- Used to specify what kinds of data will this descriptor set be containing
 
 	*/
-	vk::vk_descriptor_set test_descriptor_sets = vk::vk_descriptor_set(image_count,
-	{
-		{.binding = 0, .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, .descriptorCount = 1, .stageFlags = VK_SHADER_STAGE_VERTEX_BIT, .pImmutableSamplers  = nullptr},
-		{.binding = 1, .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, .descriptorCount = 1, .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT, .pImmutableSamplers  = nullptr}
-	}
-	);
+	vk::vk_descriptor_allocator descriptor_allocator = vk::vk_descriptor_allocator(vk::vk_descriptor_allocator::DefaultSetsPerPool);
 
-    // Vulkan Pipeline Specifications
-    // specifically binding descriptions for pipeline
-    std::vector<vk::vertex_binding_description> binding_descriptions = {
-        { "Vertex", 0, sizeof(vk::vertex), VK_VERTEX_INPUT_RATE_VERTEX }
-    };
+	// layouts and pipeline layouts are deduped, materials declaring the same bindings share one handle
+	vk::vk_descriptor_layout_cache layout_cache = vk::vk_descriptor_layout_cache();
 
-    // specifically vertex attributes
-    std::vector<vk::pipeline_vertex_attributes> vertex_attributes = {
-        { "inPosition", 0, 0, offsetof(vk::vertex, Position), VK_FORMAT_R32G32B32A32_SFLOAT },
-        { "inColor", 0, 1, offsetof(vk::vertex, Color), VK_FORMAT_R32G32B32A32_SFLOAT },
-        { "inTexCoords", 0, 2, offsetof(vk::vertex, Uv), VK_FORMAT_R32G32B32A32_SFLOAT }
-    };
+	// sets are split by how often they change: set 0 = per-frame camera data, set 1 = material (texture)
+	std::array<VkDescriptorSetLayoutBinding, 1> global_bindings = {
+		VkDescriptorSetLayoutBinding{.binding = 0, .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, .descriptorCount = 1, .stageFlags = VK_SHADER_STAGE_VERTEX_BIT, .pImmutableSamplers  = nullptr}
+	};
+	std::array<VkDescriptorSetLayoutBinding, 1> material_bindings = {
+		VkDescriptorSetLayoutBinding{.binding = 0, .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, .descriptorCount = 1, .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT, .pImmutableSamplers  = nullptr}
+	};
+
+	vk::frequency_set_layouts test_set_layouts = {
+		.Global = layout_cache.create_layout(global_bindings),
+		.Material = layout_cache.create_layout(material_bindings)
+	};
+
+	vk::vk_descriptor_set global_descriptor_sets = vk::vk_descriptor_set(descriptor_allocator, frames_in_flight, test_set_layouts.Global);
+	vk::vk_descriptor_set material_descriptor_set = vk::vk_descriptor_set(descriptor_allocator, 1, test_set_layouts.Material);
 
     // setting up vulkan pipeline
-    vk::vk_pipeline test_pipeline = vk::vk_pipeline(main_window_swapchain.get_renderpass(),test_shader, test_descriptor_sets.get_layout());
+    std::array<VkDescriptorSetLayout, vk::DescriptorFrequencyCount> test_pipeline_set_layouts = vk::resolve_set_layouts(layout_cache, test_set_layouts);
+    std::array<VkPushConstantRange, 1> test_push_constants = {
+        VkPushConstantRange{ .stageFlags = VK_SHADER_STAGE_VERTEX_BIT, .offset = 0, .size = sizeof(object_push_constants) }
+    };
 
-    // Loading and using textures
-    vk::vk_texture test_texture("models/viking_room.png");
-    // vk::vk_texture test_texture("textures/bricks.jpg");
+	// pipelines are looked up by their full state, the viking room is opaque so it skips blending and culls back faces
+	vk::vk_pipeline_registry pipeline_registry = vk::vk_pipeline_registry();
+	// the viking room needs neither alpha testing nor vertex colors, so both are compiled out of its variant
+	vk::shader_variant_key opaque_key = 0;
+	vk::shader_variant opaque_variant = test_shader.variant(opaque_key);
+	vk::pipeline_description opaque_description = {
+		.VertexModule = opaque_variant.VertexModule,
+		.FragmentModule = opaque_variant.FragmentModule,
+		.SpecializationConstants = opaque_variant.SpecializationConstants,
+		.VertexBindings = { test_shader.get_vertex_bind_attributes().begin(), test_shader.get_vertex_bind_attributes().end() },
+		.VertexAttributes = { test_shader.get_vertex_attributes().begin(), test_shader.get_vertex_attributes().end() },
+		.Layout = layout_cache.create_pipeline_layout(test_pipeline_set_layouts, test_push_constants),
+		// null when the swapchain uses dynamic rendering, the formats are used instead
+		.RenderPass = main_window_swapchain.get_renderpass(),
+		.ColorFormats = { main_window_swapchain.color_format() },
+		.DepthFormat = main_window_swapchain.depth_format(),
+	};
+	opaque_description.Raster.CullMode = VK_CULL_MODE_BACK_BIT;
+	opaque_description.Blend.Enable = false;
+	// cull, depth and blend state are set while recording, other variants of this description share the pipeline
+	opaque_description.DynamicState = true;
+	vk::vk_pipeline& test_pipeline = pipeline_registry.get(opaque_description);
+
+	// shader objects skip the pipeline entirely when the device has them, the pipeline stays as the fallback and for its layout
+	bool use_shader_objects = main_window_swapchain.uses_dynamic_rendering() and vk::vk_driver::driver_context().enabled_features().ShaderObject and test_shader.create_shader_objects(test_pipeline_set_layouts, test_push_constants, opaque_key);
+	main_window_swapchain.set_shader_objects(use_shader_objects);
+
+    // Loading and using textures, every texture loaded here is uploaded with one submission
+    vk::vk_upload_batch texture_uploads;
+    vk::vk_texture test_texture("models/viking_room.png", texture_uploads);
+    // vk::vk_texture test_texture("textures/bricks.jpg", texture_uploads);
+    texture_uploads.submit();
+    texture_uploads.destroy();
+
+    // done loading textures, no need to keep the staging memory around
+    staging_pool.trim();
 
     // updating descriptor sets
     /*
@@ -292,11 +361,9 @@ main() {
         descriptor_set[i].update_descriptor_set(uniform_buffer[i]);
     */
 
-    // test_descriptor_sets.update_uniforms(test_uniforms);
-    // test_descriptor_sets.update_texture(&test_texture);
-    // test_descriptor_sets.update_vertex(test_vertex_buffer);
+	global_descriptor_sets.update_uniforms(test_uniforms);
+	material_descriptor_set.update_texture(&test_texture);
 
-	test_descriptor_sets.update_test_descriptors(test_uniforms, test_vertex_buffer, test_texture);
 
     /*
 
@@ -314,30 +381,71 @@ main() {
 
     */
 
-    // recording clear colors for all swapchain command buffers
-    main_window_swapchain.record([&main_window_swapchain, &test_pipeline, &test_vertex_buffer, &test_index_buffer, &test_descriptor_sets](const VkCommandBuffer& p_command_buffer) {
-          test_pipeline.bind(p_command_buffer);
+    // the mesh is split into index ranges that stand in for a scene with many draws
+    uint32_t scene_chunk_count = 4;
 
-          test_descriptor_sets.bind(p_command_buffer,
-                                    main_window_swapchain.current_frame(),
-                                    test_pipeline.get_layout());
+    // p_slot is the frame slot (vk_swapchain::frame_index()), each slot has its own global set. p_model is the object's transform, pushed per draw
+    auto record_scene = [&main_window_swapchain, &test_pipeline, &test_vertex_buffer, &test_index_buffer, &global_descriptor_sets, &material_descriptor_set, &opaque_description, &test_shader, opaque_key, use_shader_objects, scene_chunk_count](const VkCommandBuffer& p_command_buffer, uint32_t p_slot, uint32_t p_chunk, const glm::mat4& p_model) {
+          // secondaries start without any state
+          vk::vk_descriptor_binder descriptor_binder;
+          vk::vk_dynamic_state dynamic_state;
+
+          if (use_shader_objects) {
+              test_shader.bind_shader_objects(p_command_buffer, opaque_key);
+              dynamic_state.begin(p_command_buffer, true);
+              dynamic_state.set_viewport(main_window_swapchain.get_extent());
+          }
+          else {
+              test_pipeline.bind(p_command_buffer);
+              dynamic_state.begin(p_command_buffer);
+          }
+          dynamic_state.apply(opaque_description);
+
+          descriptor_binder.begin(p_command_buffer);
+          descriptor_binder.bind(test_pipeline.get_layout(), vk::GLOBAL, global_descriptor_sets.get(p_slot));
+          descriptor_binder.bind(test_pipeline.get_layout(), vk::MATERIAL, material_descriptor_set.get(0));
+
+          object_push_constants object = {};
+          object.Model = p_model;
+          test_pipeline.push_constants(p_command_buffer, VK_SHADER_STAGE_VERTEX_BIT, object);
 
           test_vertex_buffer.bind(p_command_buffer);
           test_index_buffer.bind(p_command_buffer);
 
           if (test_index_buffer.has_indices()) {
-              test_index_buffer.draw(p_command_buffer);
+              // ranges are whole triangles
+              vk::chunk_range triangles = vk::split_chunk(p_chunk, scene_chunk_count, test_index_buffer.count() / 3);
+              test_index_buffer.draw(p_command_buffer, triangles.First * 3, triangles.Count * 3);
           }
-          else {
+          else if (p_chunk == 0) {
               test_vertex_buffer.draw(p_command_buffer);
           }
-	});
+	};
+
+	glm::mat4 mesh_scale = glm::scale(glm::mat4(1.f), glm::vec3(0.5f, 0.5f, 0.5f));
+
+	// a copy of the mesh that never moves, its chunks are recorded once and executed as they are every frame, until what they bind changes
+	glm::mat4 static_model = glm::translate(glm::mat4(1.f), glm::vec3(-1.5f, 0.f, 0.f)) * mesh_scale;
+	vk::vk_static_chunk_cache scene_cache = vk::vk_static_chunk_cache(main_window_swapchain.queue_family(), frames_in_flight);
+	std::vector<uint32_t> scene_chunks;
+	for (uint32_t i = 0; i < scene_chunk_count; i++) {
+		scene_chunks.push_back(scene_cache.add([&record_scene, i, static_model](const VkCommandBuffer& p_command_buffer, uint32_t p_slot) {
+			record_scene(p_command_buffer, p_slot, i, static_model);
+		}));
+	}
 
-	glm::vec3 Position = {0.f, 0.f, 0.f};
+	// the spinning copy pushes a new model matrix every frame, so its chunks are recorded again every frame on the recorder's threads
+	vk::vk_parallel_recorder scene_recorder = vk::vk_parallel_recorder(main_window_swapchain.queue_family(), frames_in_flight);
 
+	// saving shaders/shader.vert or shader.frag recompiles it and rebuilds the pipelines using it
+	vk::vk_shader_watcher shader_watcher = vk::vk_shader_watcher();
+	shader_watcher.watch_source("shaders/shader.vert", "shaders/vert.spv");
+	shader_watcher.watch_source("shaders/shader.frag", "shaders/frag.spv");
 
 	perspective_camera camera = perspective_camera((float)width / height);
 
+	auto startTime = std::chrono::high_resolution_clock::now();
+
     // vk::vk_imgui test_imgui = vk::vk_imgui();
     // VkRenderPass rp = main_window_swapchain.get_renderpass();
     // test_imgui.initialize(initiating_vulkan, main_physical_device,
@@ -355,62 +463,79 @@ main() {
         // draw (after recording)
 
 		if(glfwGetKey(main_window, GLFW_KEY_W) == GLFW_PRESS) {
-			// Position.x += (0.1f) * dt;
 			camera.ProcessKeyboard(FORWARD, dt);
 		}
 		if(glfwGetKey(main_window, GLFW_KEY_S) == GLFW_PRESS) {
 			camera.ProcessKeyboard(BACKWARD, dt);
 		}
 		if(glfwGetKey(main_window, GLFW_KEY_Q) == GLFW_PRESS) {
-			// Position.y += (0.1f) * dt;
 			camera.ProcessKeyboard(UP, dt);
 		}
 		if(glfwGetKey(main_window, GLFW_KEY_E) == GLFW_PRESS) {
-			// Position.y -= (0.1f) * dt;
 			camera.ProcessKeyboard(DOWN, dt);
 		}
 
 		if(glfwGetKey(main_window, GLFW_KEY_A) == GLFW_PRESS) {
-			// Position.z += (0.1f) * dt;
 			camera.ProcessKeyboard(RIGHT, dt);
 		}
 		if(glfwGetKey(main_window, GLFW_KEY_D) == GLFW_PRESS) {
-			// Position.z -= (0.1f) * dt;
 			camera.ProcessKeyboard(LEFT, dt);
 		}
 
 		camera.UpdateProjView();
-		
-        //! TODO: Could be relocated. All this needs to know is the current
-        //! frame to update the uniforms
-        main_window_swapchain.update_uniforms([&test_uniforms, &main_window, width, height, &Position, &camera](const uint32_t& p_frame_index) {
-			static auto startTime = std::chrono::high_resolution_clock::now();
 
-			auto currentTime = std::chrono::high_resolution_clock::now();
-			float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+		// shader objects are replaced right away, pipelines once their rebuild finished
+		if (vk::vk_shader_watcher::is_changed(shader_watcher.changed(), test_shader)) {
+			pipeline_registry.rebuild(test_shader.reload());
+		}
+
+		// picks up variants that finished compiling in the background
+		pipeline_registry.update();
+		// modules replaced by a reload are kept until the rebuilds using them are collected
+		test_shader.begin_frame(pipeline_registry.pending() > 0);
+		// pipelines of permutations nobody asked for in a while go with their modules, test_pipeline is still referenced so its modules stay
+		pipeline_registry.evict(test_shader.evict_unused(pipeline_registry.used_modules()));
+
+		// hot reload and optimized relinks swap the handles the chunks bind, which re-records them
+		size_t scene_state = vk::vk_static_chunk_cache::state_hash(test_pipeline.handle(), test_shader.get_vertex_object(opaque_key), test_shader.get_fragment_object(opaque_key));
+		for (uint32_t chunk : scene_chunks) {
+			scene_cache.set_state(chunk, scene_state);
+		}
+
+		auto currentTime = std::chrono::high_resolution_clock::now();
+		float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+		glm::mat4 spinning_model = glm::rotate(glm::mat4(1.f), time * glm::radians(90.0f), glm::vec3(5.0f, 5.0f, 5.0f)) * mesh_scale;
 
-			camera_data_uniform ubo{};
+		// waits for this frame slot's previous submit, so the slot's uniforms and secondaries are free to reuse
+		VkCommandBuffer frame_command_buffer = main_window_swapchain.begin_frame(true);
+		uint32_t frame_slot = main_window_swapchain.frame_index();
+
+        // per-frame uniforms and the global set are indexed by the frame slot, not the acquired image
+        {
 			// ubo.Model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(1.f, 0.f, 1.0f));
 			// ubo.View = glm::lookAt(glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
 			// ubo.Projection = glm::perspective(glm::radians(45.0f), width / (float) height, 0.9f, 10.0f);
 			// ubo.Projection[1][1] *= -1;
-			ubo.Model = glm::mat4(1.f);
-			ubo.Model = glm::translate(ubo.Model, glm::vec3(0.f, 0.f, 0.f));
-			// ubo.Model = glm::translate(ubo.Model, camera.Position);
-			ubo.Model =glm::scale(ubo.Model, glm::vec3(0.5f, 0.5f, 0.5f));
-			ubo.Model = glm::rotate(ubo.Model, time * glm::radians(90.0f), glm::vec3(5.0f, 5.0f, 5.0f));
 			// ubo.View = camera.get_view();
 			// ubo.Projection = camera.get_projection();
-			ubo.View = glm::lookAt(glm::vec3(2.0f, 2.0f, 5.0f), glm::vec3(0.0f, 0.0f, -0.50f), glm::vec3(0.0f, 0.0f, 1.0f));
-			ubo.Projection = glm::perspective(glm::radians(45.0f), (float)width / height, 0.0f, 1000.0f);
-			ubo.Projection[1][1] *= -1;
+			glm::mat4 view = glm::lookAt(glm::vec3(2.0f, 2.0f, 5.0f), glm::vec3(0.0f, 0.0f, -0.50f), glm::vec3(0.0f, 0.0f, 1.0f));
+			glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)width / height, 0.0f, 1000.0f);
+			projection[1][1] *= -1;
+
+			// shared by every object, each object pushes its own model matrix
+			global_frame_uniform ubo{};
+			ubo.ViewProjection = projection * view;
+
+			test_uniforms[frame_slot].update(&ubo, sizeof(ubo));
+		}
 
-			// test_uniforms[p_frame_index].update(&mvp, sizeof(mvp));
-			test_uniforms[p_frame_index].update(&ubo, sizeof(ubo));
+        scene_cache.execute(frame_command_buffer, main_window_swapchain.frame_inheritance(), frame_slot);
+        main_window_swapchain.execute_parallel(scene_recorder, scene_chunk_count, [&record_scene, frame_slot, &spinning_model](const VkCommandBuffer& p_command_buffer, uint32_t p_chunk) {
+			record_scene(p_command_buffer, frame_slot, p_chunk, spinning_model);
 		});
 
         // presenting frame (after drawing that frame)
-        main_window_swapchain.present();
+        main_window_swapchain.end_frame();
 
         glfwPollEvents();
     }
@@ -430,11 +555,19 @@ main() {
         test_uniforms[i].destroy();
     }
 
-    test_descriptor_sets.destroy();
+    global_descriptor_sets.destroy();
+    material_descriptor_set.destroy();
+    descriptor_allocator.destroy();
     test_index_buffer.destroy();
     test_vertex_buffer.destroy();
-    test_pipeline.destroy();
+    shader_watcher.destroy();
+    scene_cache.destroy();
+    scene_recorder.destroy();
+    pipeline_registry.destroy();
+    layout_cache.destroy();
     test_shader.destroy();
+    shader_bundle.destroy();
     main_window_swapchain.destroy();
+    staging_pool.destroy();
     main_driver.destroy();
 }
\ No newline at end of file
@@ -1,18 +1,13 @@
 #pragma once
 #include <cstdint>
+#include <functional>
 #include <unordered_map>
 
-// namespace {
-//     // template <typename T, typename... Rest>
-//     // void hash_combine(size_t &seed, const T &v, const Rest &...rest) {
-//     //     seed ^= std::hash<T>()(v) + 0x9e3779b9 + (seed << 6) + (seed <<
-//     2);
-//     //     (hash_combine(seed, rest), ...);
-//     // }
-//     // template <typename T, typename... Rest>
-//     // void hash_combine(size_t &seed, const T &v, const Rest &...rest) {
-//     //     seed ^= std::hash<T>()(v) + 0x9e3779b9 + (seed << 6) + (seed <<
-//     2);
-//     //     (hash_combine(seed, rest), ...);
-//     // }
-// }
\ No newline at end of file
+namespace vk {
+    //! @note Mixes the hash of every value in v, rest... into seed
+    template<typename T, typename... Rest>
+    void hash_combine(size_t& seed, const T& v, const Rest&... rest) {
+        seed ^= std::hash<T>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        (hash_combine(seed, rest), ...);
+    }
+};
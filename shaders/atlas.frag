@@ -0,0 +1,20 @@
+#version 460
+
+// Variant of shader.frag for meshes packed into a texture_atlas, the atlas is
+// one 2D array texture and the draw picks the layer its region lives on
+layout (set = 1, binding = 0) uniform sampler2DArray atlas;
+
+// offset 64 skips the vertex stage's ObjectConstants (mat4 Model)
+layout (push_constant) uniform DrawConstants {
+	layout(offset = 64) uint Layer;
+} draw;
+
+// already remapped into the atlas region, see vk::remap_uvs
+layout (location = 1) in vec2 fragTexCoords;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    outColor = texture(atlas, vec3(fragTexCoords, float(draw.Layer)));
+}
@@ -0,0 +1,23 @@
+#version 460
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Bindless variant of shader.frag, every texture lives in one array
+// (vk_bindless_texture_table) and the draw picks its texture by index
+layout (set = 1, binding = 0) uniform sampler2D textures[];
+
+// offset 64 skips the vertex stage's ObjectConstants (mat4 Model)
+layout (push_constant) uniform DrawConstants {
+	layout(offset = 64) uint TextureIndex;
+} draw;
+
+layout (location = 0) in vec4 fragColor;
+layout (location = 1) in vec2 fragTexCoords;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    // nonuniformEXT keeps this correct when the index comes from a material
+    // buffer and differs within a subgroup, it is free for push constants
+    outColor = texture(textures[nonuniformEXT(draw.TextureIndex)], fragTexCoords);
+}
@@ -1,3 +1,7 @@
 glslc.exe shader.vert -o vert.spv
 glslc.exe shader.frag -o frag.spv
+glslc.exe bindless.frag -o bindless_frag.spv
+glslc.exe atlas.frag -o atlas_frag.spv
+glslc.exe shader.vert -o vert_2.spv
+glslc.exe -DVERTEX_COLORS=true shader.frag -o frag_2.spv
 pause
\ No newline at end of file
@@ -1,2 +1,12 @@
 /Users/zhangyifan/Documents/VulkanSDK/1.3.204.0/macOS/bin/glslc shader.vert -o vert.spv
 /Users/zhangyifan/Documents/VulkanSDK/1.3.204.0/macOS/bin/glslc shader.frag -o frag.spv
+/Users/zhangyifan/Documents/VulkanSDK/1.3.204.0/macOS/bin/glslc bindless.frag -o bindless_frag.spv
+/Users/zhangyifan/Documents/VulkanSDK/1.3.204.0/macOS/bin/glslc atlas.frag -o atlas_frag.spv
+
+# features that cannot be specialization constants get one binary per
+# combination, named after the hex feature bits (see vk::shader_feature), ie
+# glslc -DFEATURE_NAME=true shader.frag -o frag_4.spv
+
+# VERTEX_COLORS (0x2) compiled in, for shaders that do not specialize it
+/Users/zhangyifan/Documents/VulkanSDK/1.3.204.0/macOS/bin/glslc shader.vert -o vert_2.spv
+/Users/zhangyifan/Documents/VulkanSDK/1.3.204.0/macOS/bin/glslc -DVERTEX_COLORS=true shader.frag -o frag_2.spv
@@ -34,16 +34,36 @@
 
 // layout(binding = 2) uniform sampler2D texSampler;
 
-layout (binding = 1) uniform sampler2D texSampler;
+// set 1 is the per-material set (see vk::descriptor_frequency)
+layout (set = 1, binding = 0) uniform sampler2D texSampler;
 layout (location = 0) in vec4 fragColor;
 layout (location = 1) in vec2 fragTexCoords;
 
 layout(location = 0) out vec4 outColor;
 
+// variant features (see vk::shader_feature), disabled ones are compiled out.
+// Permutations define the features they compile in, ie -DVERTEX_COLORS=true
+#ifndef ALPHA_TEST
+layout (constant_id = 0) const bool ALPHA_TEST = false;
+#endif
+#ifndef VERTEX_COLORS
+layout (constant_id = 1) const bool VERTEX_COLORS = false;
+#endif
+
 void main() 
 {
     // vec4 color = vec4(0.0, 0.0, 1.0, 1.0);
     // vec4 color = vec4(0.5, 0.5, 0.5, 1.0);
     // out_Color = texture(texSampler, uv) * color;
-    outColor = texture(texSampler, fragTexCoords);
+    vec4 color = texture(texSampler, fragTexCoords);
+
+    if (VERTEX_COLORS) {
+        color *= fragColor;
+    }
+
+    if (ALPHA_TEST && color.a < 0.5) {
+        discard;
+    }
+
+    outColor = color;
 }
\ No newline at end of file
@@ -95,12 +95,18 @@ layout(location = 2) in vec2 inTexCoords;
 layout(location = 0) out vec4 fragColor;
 layout(location = 1) out vec2 fragTexCoords;
 
-layout (binding = 0) uniform UniformBuffer {
-	mat4 MVP;
-} ubo;
+// set 0 is the per-frame global set (see vk::descriptor_frequency)
+layout (set = 0, binding = 0) uniform GlobalUniform {
+	mat4 ViewProjection;
+} global;
+
+// per-object transform, pushed per draw (object_push_constants)
+layout (push_constant) uniform ObjectConstants {
+	mat4 Model;
+} object;
 
 void main() {
-	gl_Position = ubo.MVP * vec4(inPosition, 1.0);
+	gl_Position = global.ViewProjection * object.Model * vec4(inPosition, 1.0);
 	fragColor = inColor;
 	fragTexCoords = inTexCoords;
 }
\ No newline at end of file
@@ -117,8 +117,20 @@ namespace vk {
          * - Physical device enumerate all the physical hardware on your machine
          *
          */
+        // buffers read through their device address (ie from a descriptor
+        // buffer) need memory that was allocated with an address
+        VkMemoryAllocateFlagsInfo memory_flags_info = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+            .pNext = nullptr,
+            .flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
+            .deviceMask = 0
+        };
+
         VkMemoryAllocateInfo memory_alloc_info = {
             .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .pNext = (p_usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT)
+                       ? &memory_flags_info
+                       : nullptr,
             .allocationSize = memory_requirements.size,
             .memoryTypeIndex = memory_type_index
         };
@@ -0,0 +1,232 @@
+#include <vulkan-cpp/vk_bindless_texture_table.hpp>
+#include <vulkan-cpp/vk_physical_driver.hpp>
+#include <vulkan-cpp/vk_swapchain.hpp>
+#include <vulkan-cpp/helper_functions.hpp>
+#include <vulkan-cpp/logger.hpp>
+#include <algorithm>
+
+namespace vk {
+
+    //! @note Combined image samplers count against both the sampler and the
+    //! sampled image limits, so the table is capped by the smallest of them
+    static uint32_t max_bindless_descriptors() {
+        VkPhysicalDeviceVulkan12Properties properties_12 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES,
+            .pNext = nullptr
+        };
+        VkPhysicalDeviceProperties2 properties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+            .pNext = &properties_12
+        };
+        vkGetPhysicalDeviceProperties2(vk_physical_driver::physical_driver(),
+                                       &properties);
+
+        return std::min(
+          { properties_12.maxPerStageDescriptorUpdateAfterBindSamplers,
+            properties_12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+            properties_12.maxDescriptorSetUpdateAfterBindSamplers,
+            properties_12.maxDescriptorSetUpdateAfterBindSampledImages });
+    }
+
+    vk_bindless_texture_table::vk_bindless_texture_table(
+      vk_descriptor_layout_cache& p_layout_cache,
+      uint32_t p_capacity) {
+        vk_driver& driver = vk_driver::driver_context();
+        m_driver = driver;
+
+        if (!driver.enabled_features().DescriptorIndexing) {
+            console_log_error("vk_bindless_texture_table: descriptor indexing "
+                              "is not supported by this device!!!");
+            return;
+        }
+
+        m_capacity = std::min(p_capacity, max_bindless_descriptors());
+        m_live.resize(m_capacity, false);
+        if (m_capacity < p_capacity) {
+            console_log_warn("vk_bindless_texture_table: capacity clamped from "
+                             "{} to {} by device limits",
+                             p_capacity,
+                             m_capacity);
+        }
+
+        VkDescriptorSetLayoutBinding textures_binding = {
+            .binding = TextureBinding,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = m_capacity,
+            .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .pImmutableSamplers = nullptr
+        };
+
+        // slots that were never written are fine as long as they are never
+        // sampled, and unused slots can be rewritten while frames are pending
+        VkDescriptorBindingFlags textures_binding_flags =
+          VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+          VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+          VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+        m_layout = p_layout_cache.create_layout(
+          { &textures_binding, 1 },
+          VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+          { &textures_binding_flags, 1 });
+
+        VkDescriptorPoolSize pool_size = {
+            .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = m_capacity
+        };
+
+        VkDescriptorPoolCreateInfo desc_pool_ci = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+            .maxSets = 1,
+            .poolSizeCount = 1,
+            .pPoolSizes = &pool_size
+        };
+
+        vk_check(vkCreateDescriptorPool(
+                   m_driver, &desc_pool_ci, nullptr, &m_descriptor_pool),
+                 "vkCreateDescriptorPool",
+                 __FUNCTION__);
+
+        VkDescriptorSetAllocateInfo descriptor_set_alloc_info = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .descriptorPool = m_descriptor_pool,
+            .descriptorSetCount = 1,
+            .pSetLayouts = &m_layout
+        };
+
+        vk_check(vkAllocateDescriptorSets(
+                   m_driver, &descriptor_set_alloc_info, &m_descriptor_set),
+                 "vkAllocateDescriptorSets",
+                 __FUNCTION__);
+
+        console_log_trace("vk_bindless_texture_table created with {} slots",
+                          m_capacity);
+    }
+
+    uint32_t vk_bindless_texture_table::add(const vk_texture& p_texture) {
+        return add(p_texture.image_view(), p_texture.sampler());
+    }
+
+    uint32_t vk_bindless_texture_table::add(VkImageView p_image_view,
+                                            VkSampler p_sampler) {
+        uint32_t index = InvalidIndex;
+
+        if (!m_free_indices.empty()) {
+            index = m_free_indices.back();
+            m_free_indices.pop_back();
+        }
+        else if (m_next_index < m_capacity) {
+            index = m_next_index++;
+        }
+        else {
+            console_log_error("vk_bindless_texture_table: all {} slots are in "
+                              "use!!!",
+                              m_capacity);
+            return InvalidIndex;
+        }
+
+        write(index, p_image_view, p_sampler);
+        m_live[index] = true;
+        m_size++;
+        return index;
+    }
+
+    void vk_bindless_texture_table::replace(uint32_t p_index,
+                                            VkImageView p_image_view,
+                                            VkSampler p_sampler) {
+        if (!is_live(p_index)) {
+            console_log_error("vk_bindless_texture_table: index {} is not in "
+                              "use!!!",
+                              p_index);
+            return;
+        }
+
+        write(p_index, p_image_view, p_sampler);
+    }
+
+    void vk_bindless_texture_table::remove(uint32_t p_index) {
+        // a second remove would retire the index twice and hand it out to
+        // two textures later on
+        if (!is_live(p_index)) {
+            console_log_error("vk_bindless_texture_table: index {} is not in "
+                              "use, it was never added or already "
+                              "removed!!!",
+                              p_index);
+            return;
+        }
+
+        // the slot keeps its old descriptor until in-flight frames are done
+        m_live[p_index] = false;
+        m_retired_indices.push_back({ .Index = p_index, .Frame = m_frame });
+        m_size--;
+    }
+
+    void vk_bindless_texture_table::begin_frame() {
+        m_frame++;
+
+        auto expired = std::partition(
+          m_retired_indices.begin(),
+          m_retired_indices.end(),
+          [this](const retired_index& p_retired) {
+              return m_frame - p_retired.Frame <
+                     swapchain_configs::MaxFramesInFlight;
+          });
+
+        for (auto it = expired; it != m_retired_indices.end(); ++it) {
+            m_free_indices.push_back(it->Index);
+        }
+        m_retired_indices.erase(expired, m_retired_indices.end());
+    }
+
+    void vk_bindless_texture_table::bind(
+      const VkCommandBuffer& p_command_buffer,
+      VkPipelineLayout p_pipeline_layout,
+      uint32_t p_set) {
+        vkCmdBindDescriptorSets(p_command_buffer,
+                                VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                p_pipeline_layout,
+                                p_set,
+                                1,
+                                &m_descriptor_set,
+                                0,
+                                nullptr);
+    }
+
+    void vk_bindless_texture_table::write(uint32_t p_index,
+                                          VkImageView p_image_view,
+                                          VkSampler p_sampler) {
+        VkDescriptorImageInfo image_info = {
+            .sampler = p_sampler,
+            .imageView = p_image_view,
+            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        };
+
+        VkWriteDescriptorSet write_descriptor = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = nullptr,
+            .dstSet = m_descriptor_set,
+            .dstBinding = TextureBinding,
+            .dstArrayElement = p_index,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .pImageInfo = &image_info
+        };
+
+        vkUpdateDescriptorSets(m_driver, 1, &write_descriptor, 0, nullptr);
+    }
+
+    void vk_bindless_texture_table::destroy() {
+        // the set layout belongs to the layout cache
+        if (m_descriptor_pool != nullptr) {
+            vkDestroyDescriptorPool(m_driver, m_descriptor_pool, nullptr);
+        }
+
+        m_descriptor_pool = nullptr;
+        m_descriptor_set = nullptr;
+        m_free_indices.clear();
+        m_retired_indices.clear();
+        m_live.clear();
+    }
+};
@@ -5,6 +5,85 @@
 
 namespace vk {
 
+    //! @note vkCmdPushDescriptorSetKHR is only loaded when the device has
+    //! VK_KHR_push_descriptor, without it nothing gets written
+    static void push_descriptor_set(
+      const VkCommandBuffer& p_command_buffer,
+      VkPipelineLayout p_pipeline_layout,
+      uint32_t p_set,
+      const VkWriteDescriptorSet& p_write_descriptor) {
+        vk_driver& driver = vk_driver::driver_context();
+        if (!driver.enabled_features().PushDescriptor) {
+            console_log_error("push descriptors are not supported by this "
+                              "device, binding {} of set {} was not "
+                              "written!!!",
+                              p_write_descriptor.dstBinding,
+                              p_set);
+            return;
+        }
+
+        driver.push_descriptor().CmdPushDescriptorSet(
+          p_command_buffer,
+          VK_PIPELINE_BIND_POINT_GRAPHICS,
+          p_pipeline_layout,
+          p_set,
+          1,
+          &p_write_descriptor);
+    }
+
+    void push_uniform_buffer(const VkCommandBuffer& p_command_buffer,
+                             VkPipelineLayout p_pipeline_layout,
+                             uint32_t p_set,
+                             uint32_t p_binding,
+                             VkBuffer p_buffer,
+                             VkDeviceSize p_offset,
+                             VkDeviceSize p_range) {
+        VkDescriptorBufferInfo buffer_info = { .buffer = p_buffer,
+                                               .offset = p_offset,
+                                               .range = p_range };
+
+        VkWriteDescriptorSet write_descriptor = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = nullptr,
+            .dstSet = nullptr, // ignored for push descriptors
+            .dstBinding = p_binding,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .pBufferInfo = &buffer_info
+        };
+
+        push_descriptor_set(
+          p_command_buffer, p_pipeline_layout, p_set, write_descriptor);
+    }
+
+    void push_image_sampler(const VkCommandBuffer& p_command_buffer,
+                            VkPipelineLayout p_pipeline_layout,
+                            uint32_t p_set,
+                            uint32_t p_binding,
+                            VkImageView p_image_view,
+                            VkSampler p_sampler) {
+        VkDescriptorImageInfo image_info = {
+            .sampler = p_sampler,
+            .imageView = p_image_view,
+            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        };
+
+        VkWriteDescriptorSet write_descriptor = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = nullptr,
+            .dstSet = nullptr, // ignored for push descriptors
+            .dstBinding = p_binding,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .pImageInfo = &image_info
+        };
+
+        push_descriptor_set(
+          p_command_buffer, p_pipeline_layout, p_set, write_descriptor);
+    }
+
     VkCommandBufferLevel to_command_buffer_level(
       const command_buffer_levels& p_level_input) {
         switch (p_level_input) {
@@ -0,0 +1,148 @@
+#include <vulkan-cpp/vk_descriptor_allocator.hpp>
+#include <vulkan-cpp/helper_functions.hpp>
+#include <vulkan-cpp/logger.hpp>
+#include <algorithm>
+#include <array>
+
+namespace vk {
+    static constexpr std::array<descriptor_pool_ratio, 6> default_ratios = {
+        descriptor_pool_ratio{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1.f },
+        descriptor_pool_ratio{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2.f },
+        descriptor_pool_ratio{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 2.f },
+        descriptor_pool_ratio{ VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f },
+        descriptor_pool_ratio{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1.f },
+        descriptor_pool_ratio{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+                               0.5f },
+    };
+
+    vk_descriptor_allocator::vk_descriptor_allocator(
+      uint32_t p_sets_per_pool,
+      std::span<const descriptor_pool_ratio> p_ratios)
+      : m_sets_per_pool(p_sets_per_pool) {
+        m_driver = vk_driver::driver_context();
+
+        if (p_ratios.empty()) {
+            p_ratios = default_ratios;
+        }
+        m_ratios.assign(p_ratios.begin(), p_ratios.end());
+
+        m_current_pool = create_pool(m_sets_per_pool);
+    }
+
+    VkDescriptorPool vk_descriptor_allocator::create_pool(
+      uint32_t p_set_count) {
+        std::vector<VkDescriptorPoolSize> pool_sizes;
+        pool_sizes.reserve(m_ratios.size());
+        for (const descriptor_pool_ratio& ratio : m_ratios) {
+            uint32_t count = static_cast<uint32_t>(ratio.Ratio * p_set_count);
+            pool_sizes.push_back({ .type = ratio.Type,
+                                   .descriptorCount = std::max(count, 1u) });
+        }
+
+        VkDescriptorPoolCreateInfo desc_pool_ci = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .maxSets = p_set_count,
+            .poolSizeCount = static_cast<uint32_t>(pool_sizes.size()),
+            .pPoolSizes = pool_sizes.data()
+        };
+
+        VkDescriptorPool pool = nullptr;
+        vk_check(
+          vkCreateDescriptorPool(m_driver, &desc_pool_ci, nullptr, &pool),
+          "vkCreateDescriptorPool",
+          __FUNCTION__);
+
+        console_log_trace("vk_descriptor_allocator created pool for {} sets",
+                          p_set_count);
+        return pool;
+    }
+
+    VkDescriptorPool vk_descriptor_allocator::acquire_pool() {
+        if (!m_ready_pools.empty()) {
+            VkDescriptorPool pool = m_ready_pools.back();
+            m_ready_pools.pop_back();
+            return pool;
+        }
+
+        // grow so a scene that keeps running out settles on a few large pools
+        m_sets_per_pool = std::min(m_sets_per_pool + m_sets_per_pool / 2,
+                                   MaxSetsPerPool);
+        return create_pool(m_sets_per_pool);
+    }
+
+    VkDescriptorSet vk_descriptor_allocator::allocate(
+      VkDescriptorSetLayout p_layout) {
+        VkDescriptorSet descriptor_set = nullptr;
+        allocate_sets(&p_layout, 1, &descriptor_set);
+        return descriptor_set;
+    }
+
+    void vk_descriptor_allocator::allocate(VkDescriptorSetLayout p_layout,
+                                           std::span<VkDescriptorSet> p_sets) {
+        std::vector<VkDescriptorSetLayout> layouts(p_sets.size(), p_layout);
+        allocate_sets(layouts.data(),
+                      static_cast<uint32_t>(layouts.size()),
+                      p_sets.data());
+    }
+
+    void vk_descriptor_allocator::allocate_sets(
+      const VkDescriptorSetLayout* p_layouts,
+      uint32_t p_count,
+      VkDescriptorSet* p_sets) {
+        VkDescriptorSetAllocateInfo descriptor_set_alloc_info = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .descriptorPool = m_current_pool,
+            .descriptorSetCount = p_count,
+            .pSetLayouts = p_layouts
+        };
+
+        VkResult result = vkAllocateDescriptorSets(
+          m_driver, &descriptor_set_alloc_info, p_sets);
+
+        // the current pool ran out, retry once on a pool with room to spare
+        if (result == VK_ERROR_OUT_OF_POOL_MEMORY or
+            result == VK_ERROR_FRAGMENTED_POOL) {
+            m_full_pools.push_back(m_current_pool);
+            m_current_pool = acquire_pool();
+
+            descriptor_set_alloc_info.descriptorPool = m_current_pool;
+            result = vkAllocateDescriptorSets(
+              m_driver, &descriptor_set_alloc_info, p_sets);
+        }
+
+        vk_check(result, "vkAllocateDescriptorSets", __FUNCTION__);
+    }
+
+    void vk_descriptor_allocator::reset() {
+        vk_check(vkResetDescriptorPool(m_driver, m_current_pool, 0),
+                 "vkResetDescriptorPool",
+                 __FUNCTION__);
+
+        for (VkDescriptorPool pool : m_full_pools) {
+            vk_check(vkResetDescriptorPool(m_driver, pool, 0),
+                     "vkResetDescriptorPool",
+                     __FUNCTION__);
+            m_ready_pools.push_back(pool);
+        }
+        m_full_pools.clear();
+    }
+
+    void vk_descriptor_allocator::destroy() {
+        vkDestroyDescriptorPool(m_driver, m_current_pool, nullptr);
+
+        for (VkDescriptorPool pool : m_ready_pools) {
+            vkDestroyDescriptorPool(m_driver, pool, nullptr);
+        }
+
+        for (VkDescriptorPool pool : m_full_pools) {
+            vkDestroyDescriptorPool(m_driver, pool, nullptr);
+        }
+
+        m_current_pool = nullptr;
+        m_ready_pools.clear();
+        m_full_pools.clear();
+    }
+};
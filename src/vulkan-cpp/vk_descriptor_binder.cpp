@@ -0,0 +1,106 @@
+#include <vulkan-cpp/vk_descriptor_binder.hpp>
+#include <vulkan-cpp/logger.hpp>
+#include <algorithm>
+
+namespace vk {
+
+    std::array<VkDescriptorSetLayout, DescriptorFrequencyCount>
+    resolve_set_layouts(vk_descriptor_layout_cache& p_layout_cache,
+                        const frequency_set_layouts& p_layouts) {
+        // deduped by the cache, every pipeline shares the same empty layout
+        VkDescriptorSetLayout empty_layout = nullptr;
+        if (p_layouts.Global == nullptr or p_layouts.Material == nullptr or
+            p_layouts.Object == nullptr) {
+            empty_layout = p_layout_cache.create_layout({});
+        }
+
+        return { p_layouts.Global != nullptr ? p_layouts.Global : empty_layout,
+                 p_layouts.Material != nullptr ? p_layouts.Material
+                                               : empty_layout,
+                 p_layouts.Object != nullptr ? p_layouts.Object
+                                             : empty_layout };
+    }
+
+    void vk_descriptor_binder::begin(const VkCommandBuffer& p_command_buffer) {
+        m_command_buffer = p_command_buffer;
+        m_pipeline_layout = nullptr;
+        m_bound_sets = {};
+        m_binds = 0;
+        m_skipped = 0;
+    }
+
+    void vk_descriptor_binder::use_pipeline_layout(
+      VkPipelineLayout p_pipeline_layout) {
+        if (p_pipeline_layout == m_pipeline_layout) {
+            return;
+        }
+
+        // without the cache compatibility is unknown, so nothing stays bound
+        if (!vk_descriptor_layout_cache::has_layout_cache()) {
+            std::fill(m_bound_sets.begin(), m_bound_sets.end(), bound_set{});
+            m_pipeline_layout = p_pipeline_layout;
+            return;
+        }
+
+        // sets stay bound up to the first set the two layouts disagree on,
+        // everything from there on has to be bound again
+        vk_descriptor_layout_cache& layout_cache =
+          vk_descriptor_layout_cache::layout_cache();
+        for (uint32_t set = 0; set < DescriptorFrequencyCount; set++) {
+            if (m_pipeline_layout == nullptr or
+                !layout_cache.is_compatible(
+                  m_pipeline_layout, p_pipeline_layout, set)) {
+                std::fill(m_bound_sets.begin() + set,
+                          m_bound_sets.end(),
+                          bound_set{});
+                break;
+            }
+        }
+
+        m_pipeline_layout = p_pipeline_layout;
+    }
+
+    void vk_descriptor_binder::bind(
+      VkPipelineLayout p_pipeline_layout,
+      descriptor_frequency p_frequency,
+      VkDescriptorSet p_descriptor_set,
+      std::span<const uint32_t> p_dynamic_offsets) {
+        if (p_dynamic_offsets.size() > MaxDynamicOffsets) {
+            console_log_error("vk_descriptor_binder: {} dynamic offsets "
+                              "requested, at most {} are supported!!!",
+                              p_dynamic_offsets.size(),
+                              MaxDynamicOffsets);
+            return;
+        }
+
+        use_pipeline_layout(p_pipeline_layout);
+
+        bound_set& bound = m_bound_sets[p_frequency];
+        if (bound.DescriptorSet == p_descriptor_set and
+            std::equal(bound.DynamicOffsets.begin(),
+                       bound.DynamicOffsets.begin() + bound.DynamicOffsetCount,
+                       p_dynamic_offsets.begin(),
+                       p_dynamic_offsets.end())) {
+            m_skipped++;
+            return;
+        }
+
+        vkCmdBindDescriptorSets(
+          m_command_buffer,
+          VK_PIPELINE_BIND_POINT_GRAPHICS,
+          p_pipeline_layout,
+          p_frequency,
+          1,
+          &p_descriptor_set,
+          static_cast<uint32_t>(p_dynamic_offsets.size()),
+          p_dynamic_offsets.data());
+        m_binds++;
+
+        bound.DescriptorSet = p_descriptor_set;
+        bound.DynamicOffsetCount =
+          static_cast<uint32_t>(p_dynamic_offsets.size());
+        std::copy(p_dynamic_offsets.begin(),
+                  p_dynamic_offsets.end(),
+                  bound.DynamicOffsets.begin());
+    }
+};
@@ -0,0 +1,91 @@
+#include <vulkan-cpp/vk_descriptor_buffer.hpp>
+#include <vulkan-cpp/helper_functions.hpp>
+#include <vulkan-cpp/logger.hpp>
+
+namespace vk {
+
+    vk_descriptor_buffer::vk_descriptor_buffer(uint32_t p_size_in_bytes) {
+        vk_driver& driver = vk_driver::driver_context();
+        if (!driver.enabled_features().DescriptorBuffer) {
+            console_log_error("vk_descriptor_buffer: descriptor buffers are "
+                              "not supported by this device!!!");
+            return;
+        }
+
+        m_driver = driver;
+        const VkPhysicalDeviceDescriptorBufferPropertiesEXT& properties =
+          driver.descriptor_buffer_properties();
+        m_alignment = properties.descriptorBufferOffsetAlignment;
+
+        // resource and sampler descriptors share the buffer, so a single
+        // binding covers every set
+        m_usage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT |
+                  VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT;
+
+        m_buffer = create_buffer(p_size_in_bytes,
+                                 m_usage |
+                                   VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                   VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+        // stays mapped, descriptors get written in place for its lifetime
+        void* mapped = nullptr;
+        vk_check(vkMapMemory(m_driver,
+                             m_buffer.DeviceMemory,
+                             0,
+                             VK_WHOLE_SIZE,
+                             0,
+                             &mapped),
+                 "vkMapMemory",
+                 __FUNCTION__);
+        m_mapped = static_cast<uint8_t*>(mapped);
+
+        VkBufferDeviceAddressInfo address_info = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+            .pNext = nullptr,
+            .buffer = m_buffer.BufferHandler
+        };
+        m_address = vkGetBufferDeviceAddress(m_driver, &address_info);
+    }
+
+    VkDeviceSize vk_descriptor_buffer::allocate(VkDeviceSize p_size_in_bytes) {
+        VkDeviceSize offset = (m_used + m_alignment - 1) & ~(m_alignment - 1);
+        if (offset + p_size_in_bytes > m_buffer.AllocateDeviceSize) {
+            console_log_error("vk_descriptor_buffer: {} bytes do not fit, {} "
+                              "of {} bytes are used!!!",
+                              p_size_in_bytes,
+                              m_used,
+                              m_buffer.AllocateDeviceSize);
+            return UINT64_MAX;
+        }
+
+        m_used = offset + p_size_in_bytes;
+        return offset;
+    }
+
+    void vk_descriptor_buffer::bind(
+      const VkCommandBuffer& p_command_buffer) const {
+        VkDescriptorBufferBindingInfoEXT binding_info = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT,
+            .pNext = nullptr,
+            .address = m_address,
+            .usage = m_usage
+        };
+        vk_driver::driver_context()
+          .descriptor_buffer()
+          .CmdBindDescriptorBuffers(p_command_buffer, 1, &binding_info);
+    }
+
+    void vk_descriptor_buffer::destroy() {
+        if (m_buffer.BufferHandler == nullptr) {
+            return;
+        }
+
+        vkUnmapMemory(m_driver, m_buffer.DeviceMemory);
+        vkFreeMemory(m_driver, m_buffer.DeviceMemory, nullptr);
+        vkDestroyBuffer(m_driver, m_buffer.BufferHandler, nullptr);
+        m_buffer = {};
+        m_mapped = nullptr;
+        m_used = 0;
+    }
+};
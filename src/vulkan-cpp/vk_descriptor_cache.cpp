@@ -0,0 +1,369 @@
+#include <vulkan-cpp/vk_descriptor_cache.hpp>
+#include <vulkan-cpp/helper_functions.hpp>
+#include <vulkan-cpp/logger.hpp>
+#include <renderer/hash.hpp>
+#include <algorithm>
+#include <cassert>
+
+namespace vk {
+
+    static bool same_binding(const VkDescriptorSetLayoutBinding& p_a,
+                             const VkDescriptorSetLayoutBinding& p_b) {
+        return p_a.binding == p_b.binding and
+               p_a.descriptorType == p_b.descriptorType and
+               p_a.descriptorCount == p_b.descriptorCount and
+               p_a.stageFlags == p_b.stageFlags and
+               p_a.pImmutableSamplers == p_b.pImmutableSamplers;
+    }
+
+    static bool same_push_constant_range(const VkPushConstantRange& p_a,
+                                         const VkPushConstantRange& p_b) {
+        return p_a.stageFlags == p_b.stageFlags and
+               p_a.offset == p_b.offset and p_a.size == p_b.size;
+    }
+
+    bool vk_descriptor_layout_cache::layout_key::operator==(
+      const layout_key& p_other) const {
+        return Flags == p_other.Flags and
+               BindingFlags == p_other.BindingFlags and
+               std::equal(Bindings.begin(),
+                          Bindings.end(),
+                          p_other.Bindings.begin(),
+                          p_other.Bindings.end(),
+                          same_binding);
+    }
+
+    size_t vk_descriptor_layout_cache::layout_key_hash::operator()(
+      const layout_key& p_key) const {
+        size_t seed = 0;
+        hash_combine(seed, p_key.Flags, p_key.Bindings.size());
+
+        for (const VkDescriptorSetLayoutBinding& binding : p_key.Bindings) {
+            hash_combine(seed,
+                         binding.binding,
+                         static_cast<uint32_t>(binding.descriptorType),
+                         binding.descriptorCount,
+                         binding.stageFlags,
+                         binding.pImmutableSamplers);
+        }
+
+        for (VkDescriptorBindingFlags binding_flags : p_key.BindingFlags) {
+            hash_combine(seed, binding_flags);
+        }
+
+        return seed;
+    }
+
+    bool vk_descriptor_layout_cache::pipeline_layout_key::operator==(
+      const pipeline_layout_key& p_other) const {
+        return SetLayouts == p_other.SetLayouts and
+               std::equal(PushConstants.begin(),
+                          PushConstants.end(),
+                          p_other.PushConstants.begin(),
+                          p_other.PushConstants.end(),
+                          same_push_constant_range);
+    }
+
+    size_t vk_descriptor_layout_cache::pipeline_layout_key_hash::operator()(
+      const pipeline_layout_key& p_key) const {
+        size_t seed = 0;
+        for (VkDescriptorSetLayout layout : p_key.SetLayouts) {
+            hash_combine(seed, layout);
+        }
+
+        for (const VkPushConstantRange& range : p_key.PushConstants) {
+            hash_combine(seed, range.stageFlags, range.offset, range.size);
+        }
+
+        return seed;
+    }
+
+    vk_descriptor_layout_cache* vk_descriptor_layout_cache::s_instance =
+      nullptr;
+
+    vk_descriptor_layout_cache::vk_descriptor_layout_cache() {
+        m_driver = vk_driver::driver_context();
+        s_instance = this;
+    }
+
+    vk_descriptor_layout_cache& vk_descriptor_layout_cache::layout_cache() {
+        if (s_instance == nullptr) {
+            console_log_error("vk_descriptor_layout_cache: no layout cache "
+                              "exists, create one before any descriptor "
+                              "set!!!");
+        }
+        assert(s_instance != nullptr);
+        return *s_instance;
+    }
+
+    VkDescriptorSetLayout vk_descriptor_layout_cache::create_layout(
+      std::span<const VkDescriptorSetLayoutBinding> p_bindings,
+      VkDescriptorSetLayoutCreateFlags p_flags,
+      std::span<const VkDescriptorBindingFlags> p_binding_flags) {
+        if (!p_binding_flags.empty() and
+            p_binding_flags.size() != p_bindings.size()) {
+            console_log_error("vk_descriptor_layout_cache: expected one "
+                              "binding flag per binding!!!");
+            p_binding_flags = {};
+        }
+
+        // sorting indices so binding flags stay paired with their binding
+        std::vector<uint32_t> order(p_bindings.size());
+        for (uint32_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](uint32_t p_a, uint32_t p_b) {
+            return p_bindings[p_a].binding < p_bindings[p_b].binding;
+        });
+
+        layout_key key = { .Flags = p_flags };
+        key.Bindings.reserve(order.size());
+        for (uint32_t index : order) {
+            key.Bindings.push_back(p_bindings[index]);
+            if (!p_binding_flags.empty()) {
+                key.BindingFlags.push_back(p_binding_flags[index]);
+            }
+        }
+
+        auto cached = m_layouts.find(key);
+        if (cached != m_layouts.end()) {
+            return cached->second;
+        }
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_ci = {
+            .sType =
+              VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+            .pNext = nullptr,
+            .bindingCount = static_cast<uint32_t>(key.BindingFlags.size()),
+            .pBindingFlags = key.BindingFlags.data()
+        };
+
+        VkDescriptorSetLayoutCreateInfo descriptor_set_layout_ci = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .pNext = key.BindingFlags.empty() ? nullptr : &binding_flags_ci,
+            .flags = p_flags,
+            .bindingCount = static_cast<uint32_t>(key.Bindings.size()),
+            .pBindings = key.Bindings.data()
+        };
+
+        VkDescriptorSetLayout layout = nullptr;
+        vk_check(vkCreateDescriptorSetLayout(
+                   m_driver, &descriptor_set_layout_ci, nullptr, &layout),
+                 "vkCreateDescriptorSetLayout",
+                 __FUNCTION__);
+
+        m_layout_keys[layout] = key;
+        m_layouts.emplace(std::move(key), layout);
+        return layout;
+    }
+
+    VkPipelineLayout vk_descriptor_layout_cache::create_pipeline_layout(
+      std::span<const VkDescriptorSetLayout> p_set_layouts,
+      std::span<const VkPushConstantRange> p_push_constants) {
+        pipeline_layout_key key = {
+            .SetLayouts = std::vector<VkDescriptorSetLayout>(
+              p_set_layouts.begin(), p_set_layouts.end()),
+            .PushConstants = std::vector<VkPushConstantRange>(
+              p_push_constants.begin(), p_push_constants.end())
+        };
+
+        auto cached = m_pipeline_layouts.find(key);
+        if (cached != m_pipeline_layouts.end()) {
+            return cached->second;
+        }
+
+        VkPipelineLayoutCreateInfo pipeline_layout_ci = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .setLayoutCount = static_cast<uint32_t>(key.SetLayouts.size()),
+            .pSetLayouts = key.SetLayouts.data(),
+            .pushConstantRangeCount =
+              static_cast<uint32_t>(key.PushConstants.size()),
+            .pPushConstantRanges = key.PushConstants.data()
+        };
+
+        VkPipelineLayout pipeline_layout = nullptr;
+        vk_check(vkCreatePipelineLayout(
+                   m_driver, &pipeline_layout_ci, nullptr, &pipeline_layout),
+                 "vkCreatePipelineLayout",
+                 __FUNCTION__);
+
+        m_pipeline_layout_keys[pipeline_layout] = key;
+        m_pipeline_layouts.emplace(std::move(key), pipeline_layout);
+        return pipeline_layout;
+    }
+
+    std::span<const VkDescriptorSetLayoutBinding>
+    vk_descriptor_layout_cache::bindings(VkDescriptorSetLayout p_layout) const {
+        auto key = m_layout_keys.find(p_layout);
+        if (key == m_layout_keys.end()) {
+            console_log_error("vk_descriptor_layout_cache: layout was not "
+                              "created by this cache!!!");
+            return {};
+        }
+
+        return key->second.Bindings;
+    }
+
+    bool vk_descriptor_layout_cache::is_compatible(VkPipelineLayout p_a,
+                                                   VkPipelineLayout p_b,
+                                                   uint32_t p_set) const {
+        if (p_a == p_b) {
+            return true;
+        }
+
+        auto a = m_pipeline_layout_keys.find(p_a);
+        auto b = m_pipeline_layout_keys.find(p_b);
+        if (a == m_pipeline_layout_keys.end() or
+            b == m_pipeline_layout_keys.end()) {
+            return false;
+        }
+
+        const pipeline_layout_key& key_a = a->second;
+        const pipeline_layout_key& key_b = b->second;
+        if (p_set >= key_a.SetLayouts.size() or
+            p_set >= key_b.SetLayouts.size()) {
+            return false;
+        }
+
+        // set layouts are deduped, so identical layouts share one handle
+        return std::equal(key_a.SetLayouts.begin(),
+                          key_a.SetLayouts.begin() + p_set + 1,
+                          key_b.SetLayouts.begin()) and
+               std::equal(key_a.PushConstants.begin(),
+                          key_a.PushConstants.end(),
+                          key_b.PushConstants.begin(),
+                          key_b.PushConstants.end(),
+                          same_push_constant_range);
+    }
+
+    VkDescriptorSetLayoutCreateFlags vk_descriptor_layout_cache::layout_flags(
+      VkDescriptorSetLayout p_layout) const {
+        auto key = m_layout_keys.find(p_layout);
+        return key != m_layout_keys.end() ? key->second.Flags : 0;
+    }
+
+    void vk_descriptor_layout_cache::destroy() {
+        for (auto& [key, pipeline_layout] : m_pipeline_layouts) {
+            vkDestroyPipelineLayout(m_driver, pipeline_layout, nullptr);
+        }
+
+        for (auto& [key, layout] : m_layouts) {
+            vkDestroyDescriptorSetLayout(m_driver, layout, nullptr);
+        }
+
+        m_pipeline_layouts.clear();
+        m_pipeline_layout_keys.clear();
+        m_layouts.clear();
+        m_layout_keys.clear();
+
+        if (s_instance == this) {
+            s_instance = nullptr;
+        }
+    }
+
+    bool descriptor_resource::operator==(
+      const descriptor_resource& p_other) const {
+        return Binding == p_other.Binding and Type == p_other.Type and
+               Buffer == p_other.Buffer and Offset == p_other.Offset and
+               Range == p_other.Range and ImageView == p_other.ImageView and
+               Sampler == p_other.Sampler and
+               ImageLayout == p_other.ImageLayout;
+    }
+
+    bool vk_descriptor_set_cache::set_key::operator==(
+      const set_key& p_other) const {
+        return Layout == p_other.Layout and Resources == p_other.Resources;
+    }
+
+    size_t vk_descriptor_set_cache::set_key_hash::operator()(
+      const set_key& p_key) const {
+        size_t seed = 0;
+        hash_combine(seed, p_key.Layout);
+
+        for (const descriptor_resource& resource : p_key.Resources) {
+            hash_combine(seed,
+                         resource.Binding,
+                         static_cast<uint32_t>(resource.Type),
+                         resource.Buffer,
+                         resource.Offset,
+                         resource.Range,
+                         resource.ImageView,
+                         resource.Sampler);
+        }
+
+        return seed;
+    }
+
+    vk_descriptor_set_cache::vk_descriptor_set_cache(
+      vk_descriptor_allocator& p_allocator)
+      : m_allocator(&p_allocator) {
+        m_driver = vk_driver::driver_context();
+    }
+
+    VkDescriptorSet vk_descriptor_set_cache::get(
+      VkDescriptorSetLayout p_layout,
+      std::span<const descriptor_resource> p_resources) {
+        set_key key = { .Layout = p_layout,
+                        .Resources = std::vector<descriptor_resource>(
+                          p_resources.begin(), p_resources.end()) };
+
+        auto cached = m_sets.find(key);
+        if (cached != m_sets.end()) {
+            m_hits++;
+            return cached->second;
+        }
+
+        m_misses++;
+        VkDescriptorSet descriptor_set = m_allocator->allocate(p_layout);
+        write(descriptor_set, p_resources);
+
+        m_sets.emplace(std::move(key), descriptor_set);
+        return descriptor_set;
+    }
+
+    void vk_descriptor_set_cache::write(
+      VkDescriptorSet p_set,
+      std::span<const descriptor_resource> p_resources) {
+        std::vector<VkDescriptorBufferInfo> buffer_infos(p_resources.size());
+        std::vector<VkDescriptorImageInfo> image_infos(p_resources.size());
+        std::vector<VkWriteDescriptorSet> write_descriptors;
+        write_descriptors.reserve(p_resources.size());
+
+        for (size_t i = 0; i < p_resources.size(); i++) {
+            const descriptor_resource& resource = p_resources[i];
+
+            VkWriteDescriptorSet write_descriptor = {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .pNext = nullptr,
+                .dstSet = p_set,
+                .dstBinding = resource.Binding,
+                .dstArrayElement = 0,
+                .descriptorCount = 1,
+                .descriptorType = resource.Type
+            };
+
+            if (resource.ImageView != nullptr or resource.Sampler != nullptr) {
+                image_infos[i] = { .sampler = resource.Sampler,
+                                   .imageView = resource.ImageView,
+                                   .imageLayout = resource.ImageLayout };
+                write_descriptor.pImageInfo = &image_infos[i];
+            }
+            else {
+                buffer_infos[i] = { .buffer = resource.Buffer,
+                                    .offset = resource.Offset,
+                                    .range = resource.Range };
+                write_descriptor.pBufferInfo = &buffer_infos[i];
+            }
+
+            write_descriptors.push_back(write_descriptor);
+        }
+
+        vkUpdateDescriptorSets(m_driver,
+                               static_cast<uint32_t>(write_descriptors.size()),
+                               write_descriptors.data(),
+                               0,
+                               nullptr);
+    }
+};
@@ -60,23 +60,7 @@ namespace vk {
 
         console_log_trace("successfully pool descriptor sets initialization!!");
 
-        // automate -- setting up descriptor set layouts
-        std::vector<VkDescriptorSetLayoutBinding> layout_bindings(p_layouts);
-        
-        VkDescriptorSetLayoutCreateInfo descriptor_set_layout_ci = {
-            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-            .pNext = nullptr,
-            .flags = 0,
-            .bindingCount = static_cast<uint32_t>(layout_bindings.size()),
-            .pBindings = layout_bindings.data()
-        };
-
-        vk_check(vkCreateDescriptorSetLayout(m_driver,
-                                             &descriptor_set_layout_ci,
-                                             nullptr,
-                                             &m_descriptor_set_layout),
-                 "vkCreateDescriptorSetLayout",
-                 __FUNCTION__);
+        create_layout(p_layouts);
 
         // Now that we setup the layouts we can just setup now start allocating
         // based on our layout setup
@@ -100,15 +84,366 @@ namespace vk {
                  __FUNCTION__);
     }
 
+    vk_descriptor_set::vk_descriptor_set(
+      vk_descriptor_allocator& p_allocator,
+      uint32_t p_descriptor_count,
+      const std::initializer_list<VkDescriptorSetLayoutBinding>& p_layouts)
+      : m_descriptor_count(p_descriptor_count) {
+        m_driver = vk_driver::driver_context();
+
+        create_layout(p_layouts);
+
+        // sets live inside of p_allocator's pools, so we do not own a pool
+        m_descriptor_sets.resize(m_descriptor_count);
+        p_allocator.allocate(m_descriptor_set_layout, m_descriptor_sets);
+    }
+
+    vk_descriptor_set::vk_descriptor_set(vk_descriptor_allocator& p_allocator,
+                                         uint32_t p_descriptor_count,
+                                         VkDescriptorSetLayout p_layout)
+      : m_descriptor_count(p_descriptor_count) {
+        m_driver = vk_driver::driver_context();
+
+        if (!vk_descriptor_layout_cache::has_layout_cache()) {
+            console_log_error("vk_descriptor_set: p_layout has to come from a "
+                              "vk_descriptor_layout_cache!!!");
+            return;
+        }
+
+        // layouts from vk_descriptor_layout_cache are shared, not owned
+        m_descriptor_set_layout = p_layout;
+        m_owns_layout = false;
+        create_update_template(
+          vk_descriptor_layout_cache::layout_cache().bindings(p_layout));
+
+        m_descriptor_sets.resize(m_descriptor_count);
+        p_allocator.allocate(m_descriptor_set_layout, m_descriptor_sets);
+    }
+
+    vk_descriptor_set::vk_descriptor_set(uint32_t p_descriptor_count,
+                                         VkDescriptorSetLayout p_layout)
+      : m_descriptor_count(p_descriptor_count) {
+        m_driver = vk_driver::driver_context();
+
+        // bind() would call a vkCmdPushDescriptorSetKHR that was never loaded
+        if (!vk_driver::driver_context().enabled_features().PushDescriptor) {
+            console_log_error("vk_descriptor_set: push descriptors are not "
+                              "supported by this device, use the "
+                              "vk_descriptor_allocator constructor!!!");
+            return;
+        }
+
+        if (!vk_descriptor_layout_cache::has_layout_cache()) {
+            console_log_error("vk_descriptor_set: p_layout has to come from a "
+                              "vk_descriptor_layout_cache!!!");
+            return;
+        }
+
+        vk_descriptor_layout_cache& layout_cache =
+          vk_descriptor_layout_cache::layout_cache();
+        if ((layout_cache.layout_flags(p_layout) &
+             VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR) == 0) {
+            console_log_error("vk_descriptor_set: layout was not created for "
+                              "push descriptors!!!");
+            return;
+        }
+
+        m_push_descriptors = true;
+        m_descriptor_set_layout = p_layout;
+        m_owns_layout = false;
+
+        // no VkDescriptorUpdateTemplate, push_descriptors() consumes the
+        // packed template data itself
+        m_update_template = vk_descriptor_update_template(
+          p_layout, layout_cache.bindings(p_layout), false);
+        m_template_data.resize(m_descriptor_count);
+    }
+
+    vk_descriptor_set::vk_descriptor_set(
+      vk_descriptor_buffer& p_descriptor_buffer,
+      uint32_t p_descriptor_count,
+      VkDescriptorSetLayout p_layout)
+      : m_descriptor_count(p_descriptor_count) {
+        m_driver = vk_driver::driver_context();
+
+        if (!vk_descriptor_layout_cache::has_layout_cache()) {
+            console_log_error("vk_descriptor_set: p_layout has to come from a "
+                              "vk_descriptor_layout_cache!!!");
+            return;
+        }
+
+        vk_descriptor_layout_cache& layout_cache =
+          vk_descriptor_layout_cache::layout_cache();
+        if ((layout_cache.layout_flags(p_layout) &
+             VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT) == 0) {
+            console_log_error("vk_descriptor_set: layout was not created for "
+                              "descriptor buffers!!!");
+            return;
+        }
+
+        if (!p_descriptor_buffer.is_valid()) {
+            console_log_error("vk_descriptor_set: the descriptor buffer was "
+                              "never created!!!");
+            return;
+        }
+
+        m_descriptor_set_layout = p_layout;
+        m_owns_layout = false;
+
+        // no VkDescriptorUpdateTemplate, write_descriptor_buffer() consumes
+        // the packed template data itself
+        m_update_template = vk_descriptor_update_template(
+          p_layout, layout_cache.bindings(p_layout), false);
+        m_template_data.resize(m_descriptor_count);
+
+        create_descriptor_buffer(p_descriptor_buffer);
+    }
+
+    void vk_descriptor_set::create_descriptor_buffer(
+      vk_descriptor_buffer& p_descriptor_buffer) {
+        vk_driver& driver = vk_driver::driver_context();
+        const descriptor_buffer_dispatch& dispatch = driver.descriptor_buffer();
+        VkDeviceSize alignment =
+          driver.descriptor_buffer_properties().descriptorBufferOffsetAlignment;
+
+        // every set gets its own aligned region, bind() offsets into it
+        VkDeviceSize layout_size = 0;
+        dispatch.GetDescriptorSetLayoutSize(
+          m_driver, m_descriptor_set_layout, &layout_size);
+        m_set_stride = (layout_size + alignment - 1) & ~(alignment - 1);
+
+        std::span<const descriptor_template_slot> slots =
+          m_update_template.slots();
+        m_binding_offsets.resize(slots.size());
+        for (size_t i = 0; i < slots.size(); i++) {
+            dispatch.GetDescriptorSetLayoutBindingOffset(
+              m_driver,
+              m_descriptor_set_layout,
+              slots[i].Binding,
+              &m_binding_offsets[i]);
+        }
+
+        VkDeviceSize offset =
+          p_descriptor_buffer.allocate(m_set_stride * m_descriptor_count);
+        if (offset == UINT64_MAX) {
+            return;
+        }
+
+        m_descriptor_buffer = &p_descriptor_buffer;
+        m_descriptor_buffer_offset = offset;
+    }
+
+    void vk_descriptor_set::write_descriptor_buffer(size_t p_index) {
+        vk_driver& driver = vk_driver::driver_context();
+        const VkPhysicalDeviceDescriptorBufferPropertiesEXT& properties =
+          driver.descriptor_buffer_properties();
+        const descriptor_template_data& data = m_template_data[p_index];
+        std::span<const descriptor_template_slot> slots =
+          m_update_template.slots();
+
+        uint8_t* set_memory = m_descriptor_buffer->mapped(
+          m_descriptor_buffer_offset + m_set_stride * p_index);
+
+        for (size_t i = 0; i < slots.size(); i++) {
+            const descriptor_template_slot& slot = slots[i];
+
+            for (uint32_t element = 0; element < slot.Count; element++) {
+                const descriptor_template_entry& entry =
+                  data.Entries[slot.FirstEntry + element];
+
+                VkDescriptorAddressInfoEXT address_info = {
+                    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT,
+                    .pNext = nullptr
+                };
+                VkDescriptorGetInfoEXT descriptor_info = {
+                    .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT,
+                    .pNext = nullptr,
+                    .type = slot.Type
+                };
+                size_t descriptor_size = 0;
+
+                switch (slot.Type) {
+                    case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+                    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER: {
+                        // unlike VkDescriptorBufferInfo, the address info
+                        // needs the real range
+                        if (entry.Buffer.range == VK_WHOLE_SIZE) {
+                            console_log_error("vk_descriptor_set: binding {} "
+                                              "was written with "
+                                              "VK_WHOLE_SIZE, descriptor "
+                                              "buffers need its size!!!",
+                                              slot.Binding);
+                            continue;
+                        }
+
+                        VkBufferDeviceAddressInfo buffer_address_info = {
+                            .sType =
+                              VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+                            .pNext = nullptr,
+                            .buffer = entry.Buffer.buffer
+                        };
+                        address_info.address =
+                          vkGetBufferDeviceAddress(m_driver,
+                                                   &buffer_address_info) +
+                          entry.Buffer.offset;
+                        address_info.range = entry.Buffer.range;
+                        address_info.format = VK_FORMAT_UNDEFINED;
+
+                        if (slot.Type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) {
+                            descriptor_info.data.pUniformBuffer = &address_info;
+                            descriptor_size =
+                              properties.uniformBufferDescriptorSize;
+                        }
+                        else {
+                            descriptor_info.data.pStorageBuffer = &address_info;
+                            descriptor_size =
+                              properties.storageBufferDescriptorSize;
+                        }
+                        break;
+                    }
+                    case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+                        descriptor_info.data.pCombinedImageSampler =
+                          &entry.Image;
+                        descriptor_size =
+                          properties.combinedImageSamplerDescriptorSize;
+                        break;
+                    default:
+                        console_log_error("vk_descriptor_set: descriptor type "
+                                          "{} is not supported by the "
+                                          "descriptor buffer backend!!!",
+                                          static_cast<int>(slot.Type));
+                        continue;
+                }
+
+                driver.descriptor_buffer().GetDescriptor(
+                  m_driver,
+                  &descriptor_info,
+                  descriptor_size,
+                  set_memory + m_binding_offsets[i] +
+                    element * descriptor_size);
+            }
+        }
+    }
+
+    void vk_descriptor_set::push_descriptors(
+      const VkCommandBuffer& p_command_buffer,
+      const VkPipelineLayout& p_pipeline_layout,
+      size_t p_index,
+      uint32_t p_set) {
+        vk_driver& driver = vk_driver::driver_context();
+        if (!driver.enabled_features().PushDescriptor) {
+            console_log_error("vk_descriptor_set: push descriptors are not "
+                              "supported by this device!!!");
+            return;
+        }
+
+        const descriptor_template_data& data = m_template_data[p_index];
+        if (!m_update_template.complete(data)) {
+            console_log_error("vk_descriptor_set: not every binding was "
+                              "written before pushing descriptors!!!");
+            return;
+        }
+
+        std::span<const descriptor_template_slot> slots =
+          m_update_template.slots();
+        std::array<VkWriteDescriptorSet, descriptor_template_data::MaxEntries>
+          write_descriptors;
+        uint32_t write_count = 0;
+
+        // one write per array element, entries are not laid out with the
+        // stride VkDescriptorImageInfo arrays would need
+        for (const descriptor_template_slot& slot : slots) {
+            for (uint32_t element = 0; element < slot.Count; element++) {
+                const descriptor_template_entry& entry =
+                  data.Entries[slot.FirstEntry + element];
+
+                VkWriteDescriptorSet& write_descriptor =
+                  write_descriptors[write_count++];
+                write_descriptor = {
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .pNext = nullptr,
+                    .dstSet = nullptr, // ignored for push descriptors
+                    .dstBinding = slot.Binding,
+                    .dstArrayElement = element,
+                    .descriptorCount = 1,
+                    .descriptorType = slot.Type
+                };
+
+                if (slot.Type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER) {
+                    write_descriptor.pImageInfo = &entry.Image;
+                }
+                else {
+                    write_descriptor.pBufferInfo = &entry.Buffer;
+                }
+            }
+        }
+
+        driver.push_descriptor().CmdPushDescriptorSet(
+          p_command_buffer,
+          VK_PIPELINE_BIND_POINT_GRAPHICS,
+          p_pipeline_layout,
+          p_set,
+          write_count,
+          write_descriptors.data());
+    }
+
+    void vk_descriptor_set::create_layout(
+      const std::initializer_list<VkDescriptorSetLayoutBinding>& p_layouts) {
+        // automate -- setting up descriptor set layouts
+        std::vector<VkDescriptorSetLayoutBinding> layout_bindings(p_layouts);
+
+        VkDescriptorSetLayoutCreateInfo descriptor_set_layout_ci = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .bindingCount = static_cast<uint32_t>(layout_bindings.size()),
+            .pBindings = layout_bindings.data()
+        };
+
+        vk_check(vkCreateDescriptorSetLayout(m_driver,
+                                             &descriptor_set_layout_ci,
+                                             nullptr,
+                                             &m_descriptor_set_layout),
+                 "vkCreateDescriptorSetLayout",
+                 __FUNCTION__);
+
+        create_update_template(layout_bindings);
+    }
+
     void vk_descriptor_set::bind(const VkCommandBuffer& p_command_buffer,
                                  uint32_t p_frame_index,
-                                 const VkPipelineLayout& p_pipeline_layout) {
+                                 const VkPipelineLayout& p_pipeline_layout,
+                                 uint32_t p_set) {
+        if (m_push_descriptors) {
+            push_descriptors(
+              p_command_buffer, p_pipeline_layout, p_frame_index, p_set);
+            return;
+        }
+
+        if (m_descriptor_buffer != nullptr) {
+            // the shared buffer is already bound by vk_descriptor_buffer,
+            // selecting a set is just an offset into it
+            uint32_t buffer_index = vk_descriptor_buffer::BufferIndex;
+            VkDeviceSize offset =
+              m_descriptor_buffer_offset + m_set_stride * p_frame_index;
+            vk_driver::driver_context()
+              .descriptor_buffer()
+              .CmdSetDescriptorBufferOffsets(p_command_buffer,
+                                             VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                             p_pipeline_layout,
+                                             p_set,
+                                             1,
+                                             &buffer_index,
+                                             &offset);
+            return;
+        }
+
 
         if (m_descriptor_sets.size() > 0) {
             vkCmdBindDescriptorSets(p_command_buffer,
                                     VK_PIPELINE_BIND_POINT_GRAPHICS,
                                     p_pipeline_layout,
-                                    0,
+                                    p_set,
                                     1,
                                     &m_descriptor_sets[p_frame_index],
                                     0,
@@ -118,160 +453,125 @@ namespace vk {
 
     void vk_descriptor_set::update_uniforms(
       const std::span<vk_uniform_buffer>& p_uniform_buffer) {
+        uint32_t binding =
+          m_update_template.find_binding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+        if (binding == UINT32_MAX or p_uniform_buffer.empty()) {
+            return;
+        }
 
-        std::vector<VkWriteDescriptorSet> write_descriptor_sets;
         for (size_t i = 0; i < m_descriptor_count; i++) {
-            if (p_uniform_buffer.size() > 0) {
-                VkDescriptorBufferInfo uniform_info = {
-                    .buffer = p_uniform_buffer[i],
-                    .offset = 0,
-                    .range = (VkDeviceSize)p_uniform_buffer.size_bytes()
-                };
-
-                // (dstBinding should be 1)
-                VkWriteDescriptorSet write_descriptor_set = {
-                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                    .pNext = nullptr,
-                    .dstSet = m_descriptor_sets[i],
-                    .dstBinding = 1,
-                    .dstArrayElement = 0,
-                    .descriptorCount = 1,
-                    .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                    .pBufferInfo = &uniform_info
-                };
-
-                write_descriptor_sets.push_back(write_descriptor_set);
-            }
+            m_update_template.write_buffer(m_template_data[i],
+                                           binding,
+                                           p_uniform_buffer[i],
+                                           0,
+                                           p_uniform_buffer[i].size_bytes());
+            flush(i);
         }
-
-        vkUpdateDescriptorSets(
-          m_driver,
-          static_cast<uint32_t>(write_descriptor_sets.size()),
-          write_descriptor_sets.data(),
-          0,
-          nullptr);
     }
 
     void vk_descriptor_set::update_vertex(
       const vk_vertex_buffer& p_vertex_buffer) {
-        std::vector<VkWriteDescriptorSet> write_descriptor_sets;
-        VkDescriptorBufferInfo descriptor_buffer_info = {
-            .buffer = p_vertex_buffer,
-            .offset = 0,
-            .range = (VkDeviceSize)p_vertex_buffer.size()
-        };
+        uint32_t binding =
+          m_update_template.find_binding(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+        if (binding == UINT32_MAX) {
+            return;
+        }
 
         for (size_t i = 0; i < m_descriptor_count; i++) {
-            VkWriteDescriptorSet vertex_buffer_write_descriptor_set = {
-                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                .pNext = nullptr,
-                .dstSet = m_descriptor_sets[i],
-                .dstBinding = 0,
-                .dstArrayElement = 0,
-                .descriptorCount = 1,
-                .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                .pBufferInfo = &descriptor_buffer_info
-            };
-            write_descriptor_sets.push_back(vertex_buffer_write_descriptor_set);
+            m_update_template.write_buffer(m_template_data[i],
+                                           binding,
+                                           p_vertex_buffer,
+                                           0,
+                                           p_vertex_buffer.size());
+            flush(i);
         }
-
-        vkUpdateDescriptorSets(
-          m_driver,
-          static_cast<uint32_t>(write_descriptor_sets.size()),
-          write_descriptor_sets.data(),
-          0,
-          nullptr);
     }
 
     void vk_descriptor_set::update_texture(const vk_texture* p_texture) {
-        std::vector<VkWriteDescriptorSet> write_descriptor_sets;
-        VkDescriptorImageInfo texture_descriptor_image_info;
-
-        if (p_texture != nullptr) {
-            console_log_fatal("p_texture != nullptr and so we add "
-                              "texture_descriptor_image_info!!!");
-            if (p_texture->image_view() != nullptr) {
-                console_log_trace("image_view NOT NULL!!!");
-            }
-
-            if (p_texture->sampler() != nullptr) {
-                console_log_trace("sampler NOT NULL!!!");
-            }
-
-            texture_descriptor_image_info = {
-                .sampler = p_texture->sampler(),
-                .imageView = p_texture->image_view(),
-                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-            };
+        uint32_t binding = m_update_template.find_binding(
+          VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+        if (binding == UINT32_MAX or p_texture == nullptr) {
+            return;
         }
 
         // Apply our texture to all descriptor sets
         for (size_t i = 0; i < m_descriptor_count; i++) {
-            VkWriteDescriptorSet texture_descriptor_set = {
-                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                .dstSet = m_descriptor_sets[i],
-                .dstBinding = 2, // Location 2
-                .dstArrayElement = 0,
-                .descriptorCount = 1,
-                .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                .pImageInfo = &texture_descriptor_image_info,
-            };
-
-            if (p_texture != nullptr) {
-                console_log_trace(
-                  "Loading writing descriptor sets for textures!!!");
-
-                write_descriptor_sets.push_back(texture_descriptor_set);
-            }
+            m_update_template.write_image(m_template_data[i],
+                                          binding,
+                                          p_texture->image_view(),
+                                          p_texture->sampler());
+            flush(i);
+        }
+    }
+
+    void vk_descriptor_set::update_test_descriptors(
+      const std::span<vk_uniform_buffer>& p_uniforms,
+      vk_vertex_buffer& p_vertex,
+      vk_texture& p_texture) {
+        uint32_t uniform_binding =
+          m_update_template.find_binding(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+        uint32_t texture_binding = m_update_template.find_binding(
+          VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+
+        for (size_t i = 0; i < m_descriptor_count; i++) {
+            m_update_template.write_buffer(m_template_data[i],
+                                           uniform_binding,
+                                           p_uniforms[i],
+                                           0,
+                                           p_uniforms[i].size_bytes());
+            m_update_template.write_image(m_template_data[i],
+                                          texture_binding,
+                                          p_texture.image_view(),
+                                          p_texture.sampler());
+            flush(i);
         }
+    }
 
-        vkUpdateDescriptorSets(
-          m_driver,
-          static_cast<uint32_t>(write_descriptor_sets.size()),
-          write_descriptor_sets.data(),
-          0,
-          nullptr);
+    void vk_descriptor_set::create_update_template(
+      std::span<const VkDescriptorSetLayoutBinding> p_bindings) {
+        m_update_template =
+          vk_descriptor_update_template(m_descriptor_set_layout, p_bindings);
+
+        // one packed block per set, allocated once here rather than per update
+        m_template_data.resize(m_descriptor_count);
     }
 
-    void vk_descriptor_set::update_test_descriptors(const std::span<vk_uniform_buffer>& p_uniforms, vk_vertex_buffer& p_vertex, vk_texture& p_texture) {
-        for(size_t i = 0; i < m_descriptor_count; i++) {
-            VkDescriptorBufferInfo bufferInfo{};
-            bufferInfo.buffer = p_uniforms[i];
-            bufferInfo.offset = 0;
-            bufferInfo.range = sizeof(camera_data_uniform);
-
-            VkDescriptorImageInfo imageInfo{};
-            imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            imageInfo.imageView = p_texture.image_view();
-            imageInfo.sampler = p_texture.sampler();
-
-            // std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
-            std::array<VkWriteDescriptorSet, 2> write_descriptors;
-
-            write_descriptors[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            write_descriptors[0].pNext = nullptr;
-            write_descriptors[0].dstSet = m_descriptor_sets[i];
-            write_descriptors[0].dstBinding = 0;
-            write_descriptors[0].dstArrayElement = 0;
-            write_descriptors[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-            write_descriptors[0].descriptorCount = 1;
-            write_descriptors[0].pBufferInfo = &bufferInfo;
-
-            write_descriptors[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            write_descriptors[1].pNext = nullptr;
-            write_descriptors[1].dstSet = m_descriptor_sets[i];
-            write_descriptors[1].dstBinding = 1;
-            write_descriptors[1].dstArrayElement = 0;
-            write_descriptors[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-            write_descriptors[1].descriptorCount = 1;
-            write_descriptors[1].pImageInfo = &imageInfo;
-            vkUpdateDescriptorSets(m_driver, static_cast<uint32_t>(write_descriptors.size()), write_descriptors.data(), 0, nullptr); 
+    void vk_descriptor_set::flush(size_t p_index) {
+        // the template writes every binding, so wait until all of them are
+        // set. Never complete when the layout did not fit into a template
+        if (!m_update_template.complete(m_template_data[p_index])) {
+            return;
         }
+
+        // push descriptors are written at bind() time, nothing to do here
+        if (m_push_descriptors) {
+            return;
+        }
+
+        if (m_descriptor_buffer != nullptr) {
+            write_descriptor_buffer(p_index);
+            return;
+        }
+
+        m_update_template.update(m_descriptor_sets[p_index],
+                                 m_template_data[p_index]);
     }
 
     void vk_descriptor_set::destroy() {
-        vkDestroyDescriptorPool(m_driver, m_descriptor_pool, nullptr);
-        vkDestroyDescriptorSetLayout(
-          m_driver, m_descriptor_set_layout, nullptr);
+        // sets from a vk_descriptor_allocator get released by its reset()
+        if (m_descriptor_pool != nullptr) {
+            vkDestroyDescriptorPool(m_driver, m_descriptor_pool, nullptr);
+        }
+
+        m_update_template.destroy();
+
+        // the region stays in the shared vk_descriptor_buffer until it is
+        // destroyed
+        m_descriptor_buffer = nullptr;
+
+        if (m_owns_layout) {
+            vkDestroyDescriptorSetLayout(
+              m_driver, m_descriptor_set_layout, nullptr);
+        }
     }
 };
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include <vulkan-cpp/vk_descriptor_template.hpp>
+#include <vulkan-cpp/helper_functions.hpp>
+#include <vulkan-cpp/logger.hpp>
+
+namespace vk {
+
+    vk_descriptor_update_template::vk_descriptor_update_template(
+      VkDescriptorSetLayout p_layout,
+      std::span<const VkDescriptorSetLayoutBinding> p_bindings,
+      bool p_create_template) {
+        m_driver = vk_driver::driver_context();
+
+        std::array<VkDescriptorUpdateTemplateEntry,
+                   descriptor_template_data::MaxEntries>
+          template_entries{};
+        uint32_t entry_count = 0;
+
+        for (const VkDescriptorSetLayoutBinding& binding : p_bindings) {
+            if (binding.descriptorCount == 0) {
+                continue;
+            }
+
+            if (entry_count + binding.descriptorCount >
+                descriptor_template_data::MaxEntries) {
+                console_log_error("vk_descriptor_update_template: layout needs "
+                                  "more than {} descriptors!!!",
+                                  descriptor_template_data::MaxEntries);
+                m_invalid = true;
+                return;
+            }
+
+            template_entries[m_slot_count] = {
+                .dstBinding = binding.binding,
+                .dstArrayElement = 0,
+                .descriptorCount = binding.descriptorCount,
+                .descriptorType = binding.descriptorType,
+                .offset = entry_count * sizeof(descriptor_template_entry),
+                .stride = sizeof(descriptor_template_entry)
+            };
+
+            m_slots[m_slot_count] = { .Binding = binding.binding,
+                                      .Type = binding.descriptorType,
+                                      .FirstEntry = entry_count,
+                                      .Count = binding.descriptorCount };
+            m_slot_count++;
+            entry_count += binding.descriptorCount;
+        }
+
+        m_entries_mask = (1u << entry_count) - 1;
+
+        if (!p_create_template) {
+            return;
+        }
+
+        VkDescriptorUpdateTemplateCreateInfo update_template_ci = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .descriptorUpdateEntryCount = m_slot_count,
+            .pDescriptorUpdateEntries = template_entries.data(),
+            .templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET,
+            .descriptorSetLayout = p_layout,
+            // only used by push descriptor templates
+            .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+            .pipelineLayout = nullptr,
+            .set = 0
+        };
+
+        vk_check(vkCreateDescriptorUpdateTemplate(
+                   m_driver, &update_template_ci, nullptr, &m_update_template),
+                 "vkCreateDescriptorUpdateTemplate",
+                 __FUNCTION__);
+    }
+
+    int32_t vk_descriptor_update_template::entry_index(
+      uint32_t p_binding,
+      uint32_t p_array_element) const {
+        for (uint32_t i = 0; i < m_slot_count; i++) {
+            const descriptor_template_slot& slot = m_slots[i];
+            if (slot.Binding == p_binding and p_array_element < slot.Count) {
+                return static_cast<int32_t>(slot.FirstEntry + p_array_element);
+            }
+        }
+
+        console_log_error("vk_descriptor_update_template: binding {}[{}] is "
+                          "not part of the layout!!!",
+                          p_binding,
+                          p_array_element);
+        return -1;
+    }
+
+    uint32_t vk_descriptor_update_template::find_binding(
+      VkDescriptorType p_type) const {
+        for (uint32_t i = 0; i < m_slot_count; i++) {
+            if (m_slots[i].Type == p_type) {
+                return m_slots[i].Binding;
+            }
+        }
+
+        return UINT32_MAX;
+    }
+
+    void vk_descriptor_update_template::write_buffer(
+      descriptor_template_data& p_data,
+      uint32_t p_binding,
+      VkBuffer p_buffer,
+      VkDeviceSize p_offset,
+      VkDeviceSize p_range,
+      uint32_t p_array_element) const {
+        int32_t index = entry_index(p_binding, p_array_element);
+        if (index < 0) {
+            return;
+        }
+
+        p_data.Entries[index].Buffer = {
+            .buffer = p_buffer, .offset = p_offset, .range = p_range
+        };
+        p_data.WrittenMask |= 1u << index;
+    }
+
+    void vk_descriptor_update_template::write_image(
+      descriptor_template_data& p_data,
+      uint32_t p_binding,
+      VkImageView p_image_view,
+      VkSampler p_sampler,
+      VkImageLayout p_layout,
+      uint32_t p_array_element) const {
+        int32_t index = entry_index(p_binding, p_array_element);
+        if (index < 0) {
+            return;
+        }
+
+        p_data.Entries[index].Image = { .sampler = p_sampler,
+                                        .imageView = p_image_view,
+                                        .imageLayout = p_layout };
+        p_data.WrittenMask |= 1u << index;
+    }
+
+    void vk_descriptor_update_template::update(
+      VkDescriptorSet p_set,
+      const descriptor_template_data& p_data) const {
+        if (!is_valid()) {
+            console_log_error("vk_descriptor_update_template: updating "
+                              "without a template!!!");
+            return;
+        }
+
+        vkUpdateDescriptorSetWithTemplate(
+          m_driver, p_set, m_update_template, p_data.Entries.data());
+    }
+
+    void vk_descriptor_update_template::destroy() {
+        if (m_update_template != nullptr) {
+            vkDestroyDescriptorUpdateTemplate(
+              m_driver, m_update_template, nullptr);
+        }
+        m_update_template = nullptr;
+    }
+};
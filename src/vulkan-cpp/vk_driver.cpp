@@ -1,5 +1,6 @@
 #include <vulkan-cpp/vk_driver.hpp>
 #include <vector>
+#include <cstring>
 #include <vulkan-cpp/logger.hpp>
 #include <vulkan-cpp/helper_functions.hpp>
 
@@ -46,6 +47,74 @@ namespace vk {
         return format;
     }
 
+    static bool has_device_extension(const VkPhysicalDevice& p_physical,
+                                     const char* p_extension) {
+        uint32_t extension_count = 0;
+        vkEnumerateDeviceExtensionProperties(
+          p_physical, nullptr, &extension_count, nullptr);
+        std::vector<VkExtensionProperties> extensions(extension_count);
+        vkEnumerateDeviceExtensionProperties(
+          p_physical, nullptr, &extension_count, extensions.data());
+
+        for (const VkExtensionProperties& extension : extensions) {
+            if (strcmp(extension.extensionName, p_extension) == 0) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    //! @note Host copies write images in whatever layout they end up being
+    //! sampled in, so SHADER_READ_ONLY_OPTIMAL has to be a valid destination
+    static bool host_copy_supports_sampled_layout(
+      const VkPhysicalDevice& p_physical) {
+        VkPhysicalDeviceHostImageCopyPropertiesEXT host_copy_properties = {
+            .sType =
+              VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT,
+            .pNext = nullptr
+        };
+
+        VkPhysicalDeviceProperties2 properties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+            .pNext = &host_copy_properties
+        };
+        vkGetPhysicalDeviceProperties2(p_physical, &properties);
+
+        std::vector<VkImageLayout> dst_layouts(
+          host_copy_properties.copyDstLayoutCount);
+        host_copy_properties.pCopyDstLayouts = dst_layouts.data();
+        vkGetPhysicalDeviceProperties2(p_physical, &properties);
+
+        for (VkImageLayout layout : dst_layouts) {
+            if (layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    //! @note Without fast linking, linking libraries can cost as much as
+    //! compiling the whole pipeline, which defeats the point of splitting it
+    static bool graphics_pipeline_library_fast_linking(
+      const VkPhysicalDevice& p_physical) {
+        VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT
+          library_properties = {
+              .sType =
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT,
+              .pNext = nullptr
+          };
+
+        VkPhysicalDeviceProperties2 properties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+            .pNext = &library_properties
+        };
+        vkGetPhysicalDeviceProperties2(p_physical, &properties);
+
+        return library_properties.graphicsPipelineLibraryFastLinking == VK_TRUE;
+    }
+
     static VkFormat s_depth_format_selected;
 
     vk_driver* vk_driver::s_instance = nullptr;
@@ -93,10 +162,344 @@ namespace vk {
             .ppEnabledExtensionNames = device_extension.data(),
         };
 
-        VkPhysicalDeviceFeatures features;
-        vkGetPhysicalDeviceFeatures(p_physical, &features);
-        features.robustBufferAccess = false;
-        create_info.pEnabledFeatures = &features;
+        //! @note Querying which of the Vulkan 1.3 features we rely on are
+        //! supported. Only the features we actually use get enabled.
+        VkPhysicalDeviceProperties device_properties;
+        vkGetPhysicalDeviceProperties(p_physical, &device_properties);
+
+        bool host_image_copy_available =
+          has_device_extension(p_physical,
+                               VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME) and
+          host_copy_supports_sampled_layout(p_physical);
+
+        bool descriptor_buffer_available = has_device_extension(
+          p_physical, VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+
+        bool extended_dynamic_state3_available = has_device_extension(
+          p_physical, VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+
+        bool vertex_input_dynamic_state_available = has_device_extension(
+          p_physical, VK_EXT_VERTEX_INPUT_DYNAMIC_STATE_EXTENSION_NAME);
+
+        bool shader_object_available = has_device_extension(
+          p_physical, VK_EXT_SHADER_OBJECT_EXTENSION_NAME);
+
+        bool graphics_pipeline_library_available =
+          has_device_extension(p_physical,
+                               VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) and
+          has_device_extension(
+            p_physical, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) and
+          graphics_pipeline_library_fast_linking(p_physical);
+
+        VkPhysicalDeviceDescriptorBufferFeaturesEXT
+          supported_descriptor_buffer = {
+              .sType =
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT,
+              .pNext = nullptr
+          };
+
+        VkPhysicalDeviceExtendedDynamicState3FeaturesEXT
+          supported_extended_dynamic_state3 = {
+              .sType =
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT,
+              .pNext = nullptr
+          };
+
+        VkPhysicalDeviceVertexInputDynamicStateFeaturesEXT
+          supported_vertex_input_dynamic_state = {
+              .sType =
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VERTEX_INPUT_DYNAMIC_STATE_FEATURES_EXT,
+              .pNext = nullptr
+          };
+
+        VkPhysicalDeviceShaderObjectFeaturesEXT supported_shader_object = {
+            .sType =
+              VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT,
+            .pNext = nullptr
+        };
+
+        VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT
+          supported_graphics_pipeline_library = {
+              .sType =
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT,
+              .pNext = nullptr
+          };
+
+        VkPhysicalDeviceHostImageCopyFeaturesEXT supported_host_image_copy = {
+            .sType =
+              VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT,
+            .pNext = nullptr
+        };
+
+        VkPhysicalDeviceVulkan13Features supported_features_13 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+            .pNext = host_image_copy_available ? &supported_host_image_copy
+                                               : nullptr
+        };
+
+        VkPhysicalDeviceVulkan12Features supported_features_12 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+            .pNext = nullptr
+        };
+
+        VkPhysicalDeviceFeatures2 supported_features = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = nullptr
+        };
+
+        if (device_properties.apiVersion >= VK_API_VERSION_1_2) {
+            supported_features.pNext = &supported_features_12;
+        }
+
+        if (device_properties.apiVersion >= VK_API_VERSION_1_3) {
+            supported_features_12.pNext = &supported_features_13;
+        }
+
+        if (descriptor_buffer_available) {
+            supported_descriptor_buffer.pNext = supported_features.pNext;
+            supported_features.pNext = &supported_descriptor_buffer;
+        }
+
+        if (extended_dynamic_state3_available) {
+            supported_extended_dynamic_state3.pNext = supported_features.pNext;
+            supported_features.pNext = &supported_extended_dynamic_state3;
+        }
+
+        if (vertex_input_dynamic_state_available) {
+            supported_vertex_input_dynamic_state.pNext =
+              supported_features.pNext;
+            supported_features.pNext = &supported_vertex_input_dynamic_state;
+        }
+
+        if (shader_object_available) {
+            supported_shader_object.pNext = supported_features.pNext;
+            supported_features.pNext = &supported_shader_object;
+        }
+
+        if (graphics_pipeline_library_available) {
+            supported_graphics_pipeline_library.pNext =
+              supported_features.pNext;
+            supported_features.pNext = &supported_graphics_pipeline_library;
+        }
+
+        vkGetPhysicalDeviceFeatures2(p_physical, &supported_features);
+
+        VkPhysicalDeviceHostImageCopyFeaturesEXT host_image_copy_features = {
+            .sType =
+              VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT,
+            .pNext = nullptr,
+            .hostImageCopy = supported_host_image_copy.hostImageCopy
+        };
+
+        VkPhysicalDeviceVulkan13Features features_13 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+            .pNext = nullptr,
+            .synchronization2 = supported_features_13.synchronization2,
+            .dynamicRendering = supported_features_13.dynamicRendering
+        };
+        m_enabled_features.Synchronization2 =
+          (supported_features_13.synchronization2 == VK_TRUE);
+        m_enabled_features.DynamicRendering =
+          (supported_features_13.dynamicRendering == VK_TRUE);
+
+        if (!m_enabled_features.Synchronization2) {
+            console_log_error("vk_driver: synchronization2 is not supported "
+                              "by this device!!!");
+        }
+
+        //! @note Descriptor indexing is what bindless textures are built on,
+        //! one large sampled image array indexed per draw from the shader
+        VkPhysicalDeviceVulkan12Features features_12 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+            .pNext = nullptr,
+            .shaderSampledImageArrayNonUniformIndexing =
+              supported_features_12.shaderSampledImageArrayNonUniformIndexing,
+            .descriptorBindingSampledImageUpdateAfterBind =
+              supported_features_12
+                .descriptorBindingSampledImageUpdateAfterBind,
+            .descriptorBindingUpdateUnusedWhilePending =
+              supported_features_12.descriptorBindingUpdateUnusedWhilePending,
+            .descriptorBindingPartiallyBound =
+              supported_features_12.descriptorBindingPartiallyBound,
+            .runtimeDescriptorArray =
+              supported_features_12.runtimeDescriptorArray,
+            .bufferDeviceAddress = supported_features_12.bufferDeviceAddress
+        };
+        m_enabled_features.DescriptorIndexing =
+          (features_12.shaderSampledImageArrayNonUniformIndexing and
+           features_12.descriptorBindingSampledImageUpdateAfterBind and
+           features_12.descriptorBindingUpdateUnusedWhilePending and
+           features_12.descriptorBindingPartiallyBound and
+           features_12.runtimeDescriptorArray);
+
+        VkPhysicalDeviceFeatures2 features = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = nullptr,
+            .features = supported_features.features
+        };
+        features.features.robustBufferAccess = false;
+
+        if (device_properties.apiVersion >= VK_API_VERSION_1_2) {
+            features.pNext = &features_12;
+        }
+        else {
+            m_enabled_features.DescriptorIndexing = false;
+        }
+
+        // descriptor buffers hold raw buffer addresses, so both are needed
+        m_enabled_features.DescriptorBuffer =
+          device_properties.apiVersion >= VK_API_VERSION_1_2 and
+          supported_descriptor_buffer.descriptorBuffer == VK_TRUE and
+          features_12.bufferDeviceAddress == VK_TRUE;
+
+        VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptor_buffer_features =
+          {
+              .sType =
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT,
+              .pNext = nullptr,
+              .descriptorBuffer = VK_TRUE
+          };
+
+        if (device_properties.apiVersion >= VK_API_VERSION_1_3) {
+            features_12.pNext = &features_13;
+
+            // host image copy only matters to us alongside synchronization2
+            m_enabled_features.HostImageCopy =
+              (supported_host_image_copy.hostImageCopy == VK_TRUE);
+        }
+
+        if (m_enabled_features.HostImageCopy) {
+            features_13.pNext = &host_image_copy_features;
+            device_extension.push_back(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME);
+            create_info.enabledExtensionCount =
+              static_cast<uint32_t>(device_extension.size());
+            create_info.ppEnabledExtensionNames = device_extension.data();
+        }
+
+        if (m_enabled_features.DescriptorBuffer) {
+            descriptor_buffer_features.pNext = features.pNext;
+            features.pNext = &descriptor_buffer_features;
+            device_extension.push_back(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+            create_info.enabledExtensionCount =
+              static_cast<uint32_t>(device_extension.size());
+            create_info.ppEnabledExtensionNames = device_extension.data();
+        }
+
+        //! @note Extended dynamic state 1 and 2 are core in 1.3. The pieces of
+        //! extended dynamic state 3 we use are polygon mode and the color
+        //! blend state, which is what most material variants differ in
+        m_enabled_features.ExtendedDynamicState =
+          device_properties.apiVersion >= VK_API_VERSION_1_3;
+
+        VkPhysicalDeviceExtendedDynamicState3FeaturesEXT
+          extended_dynamic_state3_features = {
+              .sType =
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT,
+              .pNext = nullptr,
+              .extendedDynamicState3PolygonMode = VK_TRUE,
+              .extendedDynamicState3ColorBlendEnable = VK_TRUE,
+              .extendedDynamicState3ColorBlendEquation = VK_TRUE,
+              .extendedDynamicState3ColorWriteMask = VK_TRUE
+          };
+        m_enabled_features.ExtendedDynamicState3 =
+          m_enabled_features.ExtendedDynamicState and
+          supported_extended_dynamic_state3.extendedDynamicState3PolygonMode and
+          supported_extended_dynamic_state3
+            .extendedDynamicState3ColorBlendEnable and
+          supported_extended_dynamic_state3
+            .extendedDynamicState3ColorBlendEquation and
+          supported_extended_dynamic_state3.extendedDynamicState3ColorWriteMask;
+
+        if (m_enabled_features.ExtendedDynamicState3) {
+            extended_dynamic_state3_features.pNext = features.pNext;
+            features.pNext = &extended_dynamic_state3_features;
+            device_extension.push_back(
+              VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+            create_info.enabledExtensionCount =
+              static_cast<uint32_t>(device_extension.size());
+            create_info.ppEnabledExtensionNames = device_extension.data();
+        }
+
+        VkPhysicalDeviceVertexInputDynamicStateFeaturesEXT
+          vertex_input_dynamic_state_features = {
+              .sType =
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VERTEX_INPUT_DYNAMIC_STATE_FEATURES_EXT,
+              .pNext = nullptr,
+              .vertexInputDynamicState = VK_TRUE
+          };
+        m_enabled_features.VertexInputDynamicState =
+          m_enabled_features.ExtendedDynamicState and
+          supported_vertex_input_dynamic_state.vertexInputDynamicState ==
+            VK_TRUE;
+
+        if (m_enabled_features.VertexInputDynamicState) {
+            vertex_input_dynamic_state_features.pNext = features.pNext;
+            features.pNext = &vertex_input_dynamic_state_features;
+            device_extension.push_back(
+              VK_EXT_VERTEX_INPUT_DYNAMIC_STATE_EXTENSION_NAME);
+            create_info.enabledExtensionCount =
+              static_cast<uint32_t>(device_extension.size());
+            create_info.ppEnabledExtensionNames = device_extension.data();
+        }
+
+        //! @note Shader objects can only be used with dynamic rendering, and
+        //! they rely on every state that extended dynamic state 1 and 2 cover
+        VkPhysicalDeviceShaderObjectFeaturesEXT shader_object_features = {
+            .sType =
+              VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT,
+            .pNext = nullptr,
+            .shaderObject = VK_TRUE
+        };
+        m_enabled_features.ShaderObject =
+          m_enabled_features.ExtendedDynamicState and
+          m_enabled_features.DynamicRendering and
+          supported_shader_object.shaderObject == VK_TRUE;
+
+        if (m_enabled_features.ShaderObject) {
+            shader_object_features.pNext = features.pNext;
+            features.pNext = &shader_object_features;
+            device_extension.push_back(VK_EXT_SHADER_OBJECT_EXTENSION_NAME);
+            create_info.enabledExtensionCount =
+              static_cast<uint32_t>(device_extension.size());
+            create_info.ppEnabledExtensionNames = device_extension.data();
+        }
+
+        VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT
+          graphics_pipeline_library_features = {
+              .sType =
+                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT,
+              .pNext = nullptr,
+              .graphicsPipelineLibrary = VK_TRUE
+          };
+        m_enabled_features.GraphicsPipelineLibrary =
+          supported_graphics_pipeline_library.graphicsPipelineLibrary ==
+          VK_TRUE;
+
+        if (m_enabled_features.GraphicsPipelineLibrary) {
+            graphics_pipeline_library_features.pNext = features.pNext;
+            features.pNext = &graphics_pipeline_library_features;
+            device_extension.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+            device_extension.push_back(
+              VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+            create_info.enabledExtensionCount =
+              static_cast<uint32_t>(device_extension.size());
+            create_info.ppEnabledExtensionNames = device_extension.data();
+        }
+
+        // push descriptors have no feature bit, the extension is enough
+        m_enabled_features.PushDescriptor = has_device_extension(
+          p_physical, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+
+        if (m_enabled_features.PushDescriptor) {
+            device_extension.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+            create_info.enabledExtensionCount =
+              static_cast<uint32_t>(device_extension.size());
+            create_info.ppEnabledExtensionNames = device_extension.data();
+        }
+
+        // features are passed through pNext, so pEnabledFeatures stays null
+        create_info.pNext = &features;
+        create_info.pEnabledFeatures = nullptr;
 
         vk_check(vkCreateDevice(p_physical, &create_info, nullptr, &m_driver),
                  "vkCreateDevice",
@@ -104,17 +507,199 @@ namespace vk {
 
         vkGetDeviceQueue(
           m_driver, graphics_index, 0, &m_device_queues.GraphicsQueue);
+
+        if (m_enabled_features.HostImageCopy) {
+            m_host_image_copy.CopyMemoryToImage =
+              reinterpret_cast<PFN_vkCopyMemoryToImageEXT>(
+                vkGetDeviceProcAddr(m_driver, "vkCopyMemoryToImageEXT"));
+            m_host_image_copy.TransitionImageLayout =
+              reinterpret_cast<PFN_vkTransitionImageLayoutEXT>(
+                vkGetDeviceProcAddr(m_driver, "vkTransitionImageLayoutEXT"));
+            console_log_trace("vk_driver: VK_EXT_host_image_copy enabled");
+        }
+
+        if (m_enabled_features.DescriptorBuffer) {
+            load_descriptor_buffer_dispatch();
+
+            m_descriptor_buffer_properties = {
+                .sType =
+                  VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT,
+                .pNext = nullptr
+            };
+            VkPhysicalDeviceProperties2 properties = {
+                .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+                .pNext = &m_descriptor_buffer_properties
+            };
+            vkGetPhysicalDeviceProperties2(p_physical, &properties);
+            console_log_trace("vk_driver: VK_EXT_descriptor_buffer enabled");
+        }
+
+        if (m_enabled_features.PushDescriptor) {
+            m_push_descriptor.CmdPushDescriptorSet =
+              reinterpret_cast<PFN_vkCmdPushDescriptorSetKHR>(
+                vkGetDeviceProcAddr(m_driver, "vkCmdPushDescriptorSetKHR"));
+            console_log_trace("vk_driver: VK_KHR_push_descriptor enabled");
+        }
+
+        if (m_enabled_features.ExtendedDynamicState3 or
+            m_enabled_features.VertexInputDynamicState or
+            m_enabled_features.ShaderObject) {
+            load_dynamic_state_dispatch();
+        }
+
+        if (m_enabled_features.ShaderObject) {
+            load_shader_object_dispatch();
+        }
+
+        if (m_enabled_features.GraphicsPipelineLibrary) {
+            console_log_trace(
+              "vk_driver: VK_EXT_graphics_pipeline_library enabled");
+        }
+
         console_log_info("vk_driver::vk_driver end initialization!!!\n\n");
 
         s_instance = this;
     }
 
+    void vk_driver::load_descriptor_buffer_dispatch() {
+        m_descriptor_buffer.GetDescriptorSetLayoutSize =
+          reinterpret_cast<PFN_vkGetDescriptorSetLayoutSizeEXT>(
+            vkGetDeviceProcAddr(m_driver, "vkGetDescriptorSetLayoutSizeEXT"));
+        m_descriptor_buffer.GetDescriptorSetLayoutBindingOffset =
+          reinterpret_cast<PFN_vkGetDescriptorSetLayoutBindingOffsetEXT>(
+            vkGetDeviceProcAddr(m_driver,
+                                "vkGetDescriptorSetLayoutBindingOffsetEXT"));
+        m_descriptor_buffer.GetDescriptor =
+          reinterpret_cast<PFN_vkGetDescriptorEXT>(
+            vkGetDeviceProcAddr(m_driver, "vkGetDescriptorEXT"));
+        m_descriptor_buffer.CmdBindDescriptorBuffers =
+          reinterpret_cast<PFN_vkCmdBindDescriptorBuffersEXT>(
+            vkGetDeviceProcAddr(m_driver, "vkCmdBindDescriptorBuffersEXT"));
+        m_descriptor_buffer.CmdSetDescriptorBufferOffsets =
+          reinterpret_cast<PFN_vkCmdSetDescriptorBufferOffsetsEXT>(
+            vkGetDeviceProcAddr(m_driver,
+                                "vkCmdSetDescriptorBufferOffsetsEXT"));
+    }
+
+    void vk_driver::load_dynamic_state_dispatch() {
+        if (m_enabled_features.ExtendedDynamicState3 or
+            m_enabled_features.ShaderObject) {
+            m_dynamic_state.CmdSetPolygonMode =
+              reinterpret_cast<PFN_vkCmdSetPolygonModeEXT>(
+                vkGetDeviceProcAddr(m_driver, "vkCmdSetPolygonModeEXT"));
+            m_dynamic_state.CmdSetColorBlendEnable =
+              reinterpret_cast<PFN_vkCmdSetColorBlendEnableEXT>(
+                vkGetDeviceProcAddr(m_driver, "vkCmdSetColorBlendEnableEXT"));
+            m_dynamic_state.CmdSetColorBlendEquation =
+              reinterpret_cast<PFN_vkCmdSetColorBlendEquationEXT>(
+                vkGetDeviceProcAddr(m_driver,
+                                    "vkCmdSetColorBlendEquationEXT"));
+            m_dynamic_state.CmdSetColorWriteMask =
+              reinterpret_cast<PFN_vkCmdSetColorWriteMaskEXT>(
+                vkGetDeviceProcAddr(m_driver, "vkCmdSetColorWriteMaskEXT"));
+            console_log_trace(
+              "vk_driver: VK_EXT_extended_dynamic_state3 enabled");
+        }
+
+        if (m_enabled_features.VertexInputDynamicState or
+            m_enabled_features.ShaderObject) {
+            m_dynamic_state.CmdSetVertexInput =
+              reinterpret_cast<PFN_vkCmdSetVertexInputEXT>(
+                vkGetDeviceProcAddr(m_driver, "vkCmdSetVertexInputEXT"));
+            console_log_trace(
+              "vk_driver: VK_EXT_vertex_input_dynamic_state enabled");
+        }
+    }
+
+    void vk_driver::load_shader_object_dispatch() {
+        m_shader_object.CreateShaders =
+          reinterpret_cast<PFN_vkCreateShadersEXT>(
+            vkGetDeviceProcAddr(m_driver, "vkCreateShadersEXT"));
+        m_shader_object.DestroyShader =
+          reinterpret_cast<PFN_vkDestroyShaderEXT>(
+            vkGetDeviceProcAddr(m_driver, "vkDestroyShaderEXT"));
+        m_shader_object.CmdBindShaders =
+          reinterpret_cast<PFN_vkCmdBindShadersEXT>(
+            vkGetDeviceProcAddr(m_driver, "vkCmdBindShadersEXT"));
+        m_shader_object.CmdSetRasterizationSamples =
+          reinterpret_cast<PFN_vkCmdSetRasterizationSamplesEXT>(
+            vkGetDeviceProcAddr(m_driver, "vkCmdSetRasterizationSamplesEXT"));
+        m_shader_object.CmdSetSampleMask =
+          reinterpret_cast<PFN_vkCmdSetSampleMaskEXT>(
+            vkGetDeviceProcAddr(m_driver, "vkCmdSetSampleMaskEXT"));
+        m_shader_object.CmdSetAlphaToCoverageEnable =
+          reinterpret_cast<PFN_vkCmdSetAlphaToCoverageEnableEXT>(
+            vkGetDeviceProcAddr(m_driver,
+                                "vkCmdSetAlphaToCoverageEnableEXT"));
+        m_shader_object.CmdSetAlphaToOneEnable =
+          reinterpret_cast<PFN_vkCmdSetAlphaToOneEnableEXT>(
+            vkGetDeviceProcAddr(m_driver, "vkCmdSetAlphaToOneEnableEXT"));
+        m_shader_object.CmdSetDepthClampEnable =
+          reinterpret_cast<PFN_vkCmdSetDepthClampEnableEXT>(
+            vkGetDeviceProcAddr(m_driver, "vkCmdSetDepthClampEnableEXT"));
+        m_shader_object.CmdSetLogicOpEnable =
+          reinterpret_cast<PFN_vkCmdSetLogicOpEnableEXT>(
+            vkGetDeviceProcAddr(m_driver, "vkCmdSetLogicOpEnableEXT"));
+        console_log_trace("vk_driver: VK_EXT_shader_object enabled");
+    }
+
     VkFormat vk_driver::depth_format() {
         return s_depth_format_selected;
     }
 
     vk_driver::~vk_driver() {}
 
+    bool vk_driver::supports_host_image_copy(VkFormat p_format,
+                                             VkImageUsageFlags p_usage) const {
+        if (!m_enabled_features.HostImageCopy) {
+            return false;
+        }
+
+        VkFormatProperties3 format_properties_3 = {
+            .sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3,
+            .pNext = nullptr
+        };
+        VkFormatProperties2 format_properties = {
+            .sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2,
+            .pNext = &format_properties_3
+        };
+        vkGetPhysicalDeviceFormatProperties2(
+          m_physical_driver, p_format, &format_properties);
+
+        if (!(format_properties_3.optimalTilingFeatures &
+              VK_FORMAT_FEATURE_2_HOST_IMAGE_TRANSFER_BIT_EXT)) {
+            return false;
+        }
+
+        // some devices lose compression when images allow host transfers,
+        // that costs more every frame than the upload saves once
+        VkHostImageCopyDevicePerformanceQueryEXT performance_query = {
+            .sType =
+              VK_STRUCTURE_TYPE_HOST_IMAGE_COPY_DEVICE_PERFORMANCE_QUERY_EXT,
+            .pNext = nullptr
+        };
+        VkImageFormatProperties2 image_format_properties = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2,
+            .pNext = &performance_query
+        };
+        VkPhysicalDeviceImageFormatInfo2 image_format_info = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2,
+            .pNext = nullptr,
+            .format = p_format,
+            .type = VK_IMAGE_TYPE_2D,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .usage = p_usage | VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT,
+            .flags = 0
+        };
+
+        VkResult result = vkGetPhysicalDeviceImageFormatProperties2(
+          m_physical_driver, &image_format_info, &image_format_properties);
+
+        return result == VK_SUCCESS and
+               (performance_query.optimalDeviceAccess == VK_TRUE or
+                performance_query.identicalMemoryLayout == VK_TRUE);
+    }
+
     void vk_driver::destroy() {
         vkDestroyDevice(m_driver, nullptr);
     }
@@ -0,0 +1,310 @@
+#include <vulkan-cpp/vk_dynamic_state.hpp>
+#include <vulkan-cpp/logger.hpp>
+#include <array>
+#include <vector>
+
+namespace vk {
+
+    void vk_dynamic_state::begin(const VkCommandBuffer& p_command_buffer,
+                                 bool p_shader_objects) {
+        vk_driver& driver = vk_driver::driver_context();
+        m_features = driver.enabled_features();
+        m_dispatch = driver.dynamic_state();
+        m_shader_object = driver.shader_object();
+        m_shader_objects = p_shader_objects and m_features.ShaderObject;
+
+        if (p_shader_objects and !m_features.ShaderObject) {
+            console_log_error("vk_dynamic_state: shader objects are not "
+                              "supported by this device!!!");
+        }
+
+        // the shader object extension provides these commands by itself
+        if (m_shader_objects) {
+            m_features.ExtendedDynamicState3 = true;
+            m_features.VertexInputDynamicState = true;
+        }
+
+        m_command_buffer = p_command_buffer;
+        m_state = {};
+        m_commands = 0;
+        m_skipped = 0;
+    }
+
+    void vk_dynamic_state::set_viewport(VkExtent2D p_extent) {
+        VkViewport viewport = {
+            .x = 0.0f,
+            .y = 0.0f,
+            .width = static_cast<float>(p_extent.width),
+            .height = static_cast<float>(p_extent.height),
+            .minDepth = 0.0f,
+            .maxDepth = 1.0f,
+        };
+
+        VkRect2D scissor = {
+            .offset = { 0, 0 },
+            .extent = p_extent,
+        };
+
+        if (m_shader_objects) {
+            vkCmdSetViewportWithCount(m_command_buffer, 1, &viewport);
+            vkCmdSetScissorWithCount(m_command_buffer, 1, &scissor);
+        }
+        else {
+            vkCmdSetViewport(m_command_buffer, 0, 1, &viewport);
+            vkCmdSetScissor(m_command_buffer, 0, 1, &scissor);
+        }
+        m_commands += 2;
+    }
+
+    void vk_dynamic_state::set_topology(VkPrimitiveTopology p_topology,
+                                        bool p_primitive_restart) {
+        if (!m_features.ExtendedDynamicState) {
+            return;
+        }
+
+        set_if_changed(m_state.Topology,
+                       p_topology,
+                       m_state.TopologyValid,
+                       [&]() {
+                           vkCmdSetPrimitiveTopology(m_command_buffer,
+                                                     p_topology);
+                       });
+
+        set_if_changed(m_state.PrimitiveRestart,
+                       p_primitive_restart,
+                       m_state.PrimitiveRestartValid,
+                       [&]() {
+                           vkCmdSetPrimitiveRestartEnable(m_command_buffer,
+                                                          p_primitive_restart);
+                       });
+    }
+
+    void vk_dynamic_state::set_raster(const pipeline_raster_state& p_raster) {
+        if (!m_features.ExtendedDynamicState) {
+            return;
+        }
+
+        pipeline_raster_state& current = m_state.Raster;
+
+        set_if_changed(
+          current.CullMode, p_raster.CullMode, m_state.CullModeValid, [&]() {
+              vkCmdSetCullMode(m_command_buffer, p_raster.CullMode);
+          });
+
+        set_if_changed(
+          current.FrontFace, p_raster.FrontFace, m_state.FrontFaceValid, [&]() {
+              vkCmdSetFrontFace(m_command_buffer, p_raster.FrontFace);
+          });
+
+        // the bias values only matter while biasing is enabled, they are set
+        // together with the enable so both are tracked as one
+        bool bias_changed =
+          !m_state.DepthBiasValid or
+          current.DepthBiasEnable != p_raster.DepthBiasEnable or
+          (p_raster.DepthBiasEnable and
+           (current.DepthBiasConstant != p_raster.DepthBiasConstant or
+            current.DepthBiasSlope != p_raster.DepthBiasSlope));
+
+        if (bias_changed) {
+            vkCmdSetDepthBiasEnable(m_command_buffer, p_raster.DepthBiasEnable);
+            vkCmdSetDepthBias(m_command_buffer,
+                              p_raster.DepthBiasConstant,
+                              0.0f,
+                              p_raster.DepthBiasSlope);
+            current.DepthBiasEnable = p_raster.DepthBiasEnable;
+            current.DepthBiasConstant = p_raster.DepthBiasConstant;
+            current.DepthBiasSlope = p_raster.DepthBiasSlope;
+            m_state.DepthBiasValid = true;
+            m_commands += 2;
+        }
+        else {
+            m_skipped += 2;
+        }
+
+        set_if_changed(
+          current.LineWidth, p_raster.LineWidth, m_state.LineWidthValid, [&]() {
+              vkCmdSetLineWidth(m_command_buffer, p_raster.LineWidth);
+          });
+
+        if (m_features.ExtendedDynamicState3) {
+            set_if_changed(current.PolygonMode,
+                           p_raster.PolygonMode,
+                           m_state.PolygonModeValid,
+                           [&]() {
+                               m_dispatch.CmdSetPolygonMode(
+                                 m_command_buffer, p_raster.PolygonMode);
+                           });
+        }
+    }
+
+    void vk_dynamic_state::set_depth(const pipeline_depth_state& p_depth) {
+        if (!m_features.ExtendedDynamicState) {
+            return;
+        }
+
+        pipeline_depth_state& current = m_state.Depth;
+
+        set_if_changed(current.TestEnable,
+                       p_depth.TestEnable,
+                       m_state.DepthTestValid,
+                       [&]() {
+                           vkCmdSetDepthTestEnable(m_command_buffer,
+                                                   p_depth.TestEnable);
+                       });
+
+        set_if_changed(current.WriteEnable,
+                       p_depth.WriteEnable,
+                       m_state.DepthWriteValid,
+                       [&]() {
+                           vkCmdSetDepthWriteEnable(m_command_buffer,
+                                                    p_depth.WriteEnable);
+                       });
+
+        set_if_changed(current.CompareOp,
+                       p_depth.CompareOp,
+                       m_state.DepthCompareValid,
+                       [&]() {
+                           vkCmdSetDepthCompareOp(m_command_buffer,
+                                                  p_depth.CompareOp);
+                       });
+    }
+
+    void vk_dynamic_state::set_blend(const pipeline_blend_state& p_blend,
+                                     uint32_t p_attachment_count) {
+        if (!m_features.ExtendedDynamicState3) {
+            return;
+        }
+
+        if (p_attachment_count > pipeline_description::MaxColorAttachments) {
+            console_log_error("vk_dynamic_state: {} color attachments, at most "
+                              "{} are supported!!!",
+                              p_attachment_count,
+                              pipeline_description::MaxColorAttachments);
+            return;
+        }
+
+        if (m_state.BlendValid and m_state.Blend == p_blend and
+            m_state.BlendAttachments == p_attachment_count) {
+            m_skipped += 3;
+            return;
+        }
+
+        std::array<VkBool32, pipeline_description::MaxColorAttachments>
+          enables;
+        enables.fill(p_blend.Enable);
+
+        std::array<VkColorBlendEquationEXT,
+                   pipeline_description::MaxColorAttachments>
+          equations;
+        equations.fill({ .srcColorBlendFactor = p_blend.SrcColor,
+                         .dstColorBlendFactor = p_blend.DstColor,
+                         .colorBlendOp = p_blend.ColorOp,
+                         .srcAlphaBlendFactor = p_blend.SrcAlpha,
+                         .dstAlphaBlendFactor = p_blend.DstAlpha,
+                         .alphaBlendOp = p_blend.AlphaOp });
+
+        std::array<VkColorComponentFlags,
+                   pipeline_description::MaxColorAttachments>
+          write_masks;
+        write_masks.fill(p_blend.WriteMask);
+
+        m_dispatch.CmdSetColorBlendEnable(
+          m_command_buffer, 0, p_attachment_count, enables.data());
+        m_dispatch.CmdSetColorBlendEquation(
+          m_command_buffer, 0, p_attachment_count, equations.data());
+        m_dispatch.CmdSetColorWriteMask(
+          m_command_buffer, 0, p_attachment_count, write_masks.data());
+
+        m_state.Blend = p_blend;
+        m_state.BlendAttachments = p_attachment_count;
+        m_state.BlendValid = true;
+        m_commands += 3;
+    }
+
+    void vk_dynamic_state::set_vertex_input(
+      std::span<const VkVertexInputBindingDescription> p_bindings,
+      std::span<const VkVertexInputAttributeDescription> p_attributes) {
+        if (!m_features.VertexInputDynamicState) {
+            return;
+        }
+
+        std::vector<VkVertexInputBindingDescription2EXT> bindings;
+        bindings.reserve(p_bindings.size());
+        for (const VkVertexInputBindingDescription& binding : p_bindings) {
+            bindings.push_back({
+              .sType = VK_STRUCTURE_TYPE_VERTEX_INPUT_BINDING_DESCRIPTION_2_EXT,
+              .pNext = nullptr,
+              .binding = binding.binding,
+              .stride = binding.stride,
+              .inputRate = binding.inputRate,
+              .divisor = 1,
+            });
+        }
+
+        std::vector<VkVertexInputAttributeDescription2EXT> attributes;
+        attributes.reserve(p_attributes.size());
+        for (const VkVertexInputAttributeDescription& attribute :
+             p_attributes) {
+            attributes.push_back({
+              .sType =
+                VK_STRUCTURE_TYPE_VERTEX_INPUT_ATTRIBUTE_DESCRIPTION_2_EXT,
+              .pNext = nullptr,
+              .location = attribute.location,
+              .binding = attribute.binding,
+              .format = attribute.format,
+              .offset = attribute.offset,
+            });
+        }
+
+        m_dispatch.CmdSetVertexInput(m_command_buffer,
+                                     static_cast<uint32_t>(bindings.size()),
+                                     bindings.data(),
+                                     static_cast<uint32_t>(attributes.size()),
+                                     attributes.data());
+        m_commands++;
+    }
+
+    void vk_dynamic_state::set_shader_object_state(
+      VkSampleCountFlagBits p_samples) {
+        if (m_state.SamplesValid and m_state.Samples == p_samples) {
+            return;
+        }
+
+        VkSampleMask sample_mask = UINT32_MAX;
+        m_shader_object.CmdSetRasterizationSamples(m_command_buffer,
+                                                   p_samples);
+        m_shader_object.CmdSetSampleMask(
+          m_command_buffer, p_samples, &sample_mask);
+        m_commands += 2;
+
+        // the rest never changes, so it only gets set along with the first
+        // sample count
+        if (!m_state.SamplesValid) {
+            m_shader_object.CmdSetAlphaToCoverageEnable(m_command_buffer,
+                                                        VK_FALSE);
+            m_shader_object.CmdSetAlphaToOneEnable(m_command_buffer, VK_FALSE);
+            m_shader_object.CmdSetDepthClampEnable(m_command_buffer, VK_FALSE);
+            m_shader_object.CmdSetLogicOpEnable(m_command_buffer, VK_FALSE);
+            vkCmdSetRasterizerDiscardEnable(m_command_buffer, VK_FALSE);
+            vkCmdSetDepthBoundsTestEnable(m_command_buffer, VK_FALSE);
+            vkCmdSetStencilTestEnable(m_command_buffer, VK_FALSE);
+            m_commands += 7;
+        }
+
+        m_state.Samples = p_samples;
+        m_state.SamplesValid = true;
+    }
+
+    void vk_dynamic_state::apply(const pipeline_description& p_description) {
+        if (m_shader_objects) {
+            set_shader_object_state(p_description.Samples);
+        }
+
+        set_topology(p_description.Topology, p_description.PrimitiveRestart);
+        set_raster(p_description.Raster);
+        set_depth(p_description.Depth);
+        set_blend(p_description.Blend, p_description.color_attachment_count());
+        set_vertex_input(p_description.VertexBindings,
+                         p_description.VertexAttributes);
+    }
+};
@@ -37,6 +37,13 @@ namespace vk {
         vkCmdDrawIndexed(p_command_buffer, m_indices_count, 1, 0, 0, 0);
     }
 
+    void vk_index_buffer::draw(const VkCommandBuffer& p_command_buffer,
+                               uint32_t p_first_index,
+                               uint32_t p_index_count) {
+        vkCmdDrawIndexed(
+          p_command_buffer, p_index_count, 1, p_first_index, 0, 0);
+    }
+
     void vk_index_buffer::destroy() {
         vkFreeMemory(m_driver, m_index_buffer_data.DeviceMemory, nullptr);
         vkDestroyBuffer(m_driver, m_index_buffer_data.BufferHandler, nullptr);
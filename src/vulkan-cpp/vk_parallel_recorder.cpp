@@ -0,0 +1,253 @@
+#include <vulkan-cpp/vk_parallel_recorder.hpp>
+#include <vulkan-cpp/vk_driver.hpp>
+#include <vulkan-cpp/helper_functions.hpp>
+#include <vulkan-cpp/logger.hpp>
+#include <algorithm>
+
+namespace vk {
+
+    chunk_range split_chunk(uint32_t p_chunk,
+                            uint32_t p_chunk_count,
+                            uint32_t p_count) {
+        // the first p_count % p_chunk_count chunks take one extra item
+        uint32_t base = p_count / p_chunk_count;
+        uint32_t extra = p_count % p_chunk_count;
+        return { .First = p_chunk * base + std::min(p_chunk, extra),
+                 .Count = base + (p_chunk < extra ? 1 : 0) };
+    }
+
+    void begin_secondary(const VkCommandBuffer& p_command_buffer,
+                         const secondary_inheritance& p_inheritance,
+                         VkCommandBufferUsageFlags p_usage) {
+        VkCommandBufferInheritanceRenderingInfo rendering_inheritance = {
+            .sType =
+              VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .viewMask = 0,
+            .colorAttachmentCount = 1,
+            .pColorAttachmentFormats = &p_inheritance.ColorFormat,
+            .depthAttachmentFormat = p_inheritance.DepthFormat,
+            .stencilAttachmentFormat = VK_FORMAT_UNDEFINED,
+            .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT
+        };
+
+        VkCommandBufferInheritanceInfo inheritance_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+            .pNext = p_inheritance.RenderPass == nullptr
+                       ? &rendering_inheritance
+                       : nullptr,
+            .renderPass = p_inheritance.RenderPass,
+            .subpass = 0,
+            .framebuffer = p_inheritance.Framebuffer,
+            .occlusionQueryEnable = false,
+            .queryFlags = 0,
+            .pipelineStatistics = 0
+        };
+
+        VkCommandBufferBeginInfo command_buffer_begin_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .pNext = nullptr,
+            .flags =
+              VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | p_usage,
+            .pInheritanceInfo = &inheritance_info
+        };
+
+        vk_check(
+          vkBeginCommandBuffer(p_command_buffer, &command_buffer_begin_info),
+          "vkBeginCommandBuffer",
+          __FUNCTION__);
+
+        VkViewport viewport = {
+            .x = 0.0f,
+            .y = 0.0f,
+            .width = static_cast<float>(p_inheritance.Extent.width),
+            .height = static_cast<float>(p_inheritance.Extent.height),
+            .minDepth = 0.0f,
+            .maxDepth = 1.0f,
+        };
+        VkRect2D scissor = { .offset = { 0, 0 },
+                             .extent = p_inheritance.Extent };
+
+        if (p_inheritance.ShaderObjects and
+            vk_driver::driver_context().enabled_features().ShaderObject) {
+            vkCmdSetViewportWithCount(p_command_buffer, 1, &viewport);
+            vkCmdSetScissorWithCount(p_command_buffer, 1, &scissor);
+        }
+        else {
+            vkCmdSetViewport(p_command_buffer, 0, 1, &viewport);
+            vkCmdSetScissor(p_command_buffer, 0, 1, &scissor);
+        }
+    }
+
+    vk_parallel_recorder::vk_parallel_recorder(uint32_t p_queue_family,
+                                               uint32_t p_slot_count,
+                                               uint32_t p_thread_count) {
+        m_driver = vk_driver::driver_context();
+        m_slot_count = p_slot_count;
+
+        if (p_thread_count == 0) {
+            p_thread_count = std::clamp(
+              std::thread::hardware_concurrency(), 1u, MaxThreads);
+        }
+        m_thread_count = p_thread_count;
+
+        // secondaries are re-recorded as a whole, so pools are reset in bulk
+        // rather than per command buffer
+        VkCommandPoolCreateInfo pool_ci = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .queueFamilyIndex = p_queue_family
+        };
+
+        m_pools.resize(m_thread_count * m_slot_count);
+        m_recorded.resize(m_slot_count);
+        for (thread_pool& pool : m_pools) {
+            vk_check(vkCreateCommandPool(
+                       m_driver, &pool_ci, nullptr, &pool.CommandPool),
+                     "vkCreateCommandPool",
+                     __FUNCTION__);
+        }
+
+        // thread 0 is whoever calls record()
+        for (uint32_t i = 1; i < m_thread_count; i++) {
+            m_workers.emplace_back([this, i]() { worker_loop(i); });
+        }
+
+        console_log_trace("vk_parallel_recorder started {} threads for {} "
+                          "slots",
+                          m_thread_count,
+                          m_slot_count);
+    }
+
+    std::span<const VkCommandBuffer> vk_parallel_recorder::record(
+      uint32_t p_slot,
+      const secondary_inheritance& p_inheritance,
+      uint32_t p_chunk_count,
+      const secondary_record_function& p_callable,
+      VkCommandBufferUsageFlags p_usage) {
+        if (p_slot >= m_slot_count) {
+            console_log_error("vk_parallel_recorder: slot {} is out of range, "
+                              "only {} slots were created!!!",
+                              p_slot,
+                              m_slot_count);
+            return {};
+        }
+
+        std::vector<VkCommandBuffer>& recorded = m_recorded[p_slot];
+        recorded.assign(p_chunk_count, nullptr);
+        if (p_chunk_count == 0) {
+            return {};
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_slot = p_slot;
+            m_chunk_count = p_chunk_count;
+            m_usage = p_usage;
+            m_inheritance = &p_inheritance;
+            m_callable = &p_callable;
+            m_remaining = m_thread_count - 1;
+            m_generation++;
+        }
+        m_condition.notify_all();
+
+        record_chunks(0);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_finished_condition.wait(lock, [this]() { return m_remaining == 0; });
+        return recorded;
+    }
+
+    void vk_parallel_recorder::worker_loop(uint32_t p_thread) {
+        uint64_t generation = 0;
+
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this, generation]() {
+                    return m_stop or m_generation != generation;
+                });
+
+                if (m_stop) {
+                    return;
+                }
+                generation = m_generation;
+            }
+
+            record_chunks(p_thread);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_remaining == 0) {
+                m_finished_condition.notify_one();
+            }
+        }
+    }
+
+    void vk_parallel_recorder::record_chunks(uint32_t p_thread) {
+        if (p_thread >= m_chunk_count) {
+            return;
+        }
+
+        thread_pool& pool = m_pools[p_thread * m_slot_count + m_slot];
+        vkResetCommandPool(m_driver, pool.CommandPool, 0);
+
+        // chunks p_thread, p_thread + m_thread_count, ...
+        uint32_t chunks =
+          (m_chunk_count - p_thread + m_thread_count - 1) / m_thread_count;
+        if (pool.CommandBuffers.size() < chunks) {
+            uint32_t allocated =
+              static_cast<uint32_t>(pool.CommandBuffers.size());
+            pool.CommandBuffers.resize(chunks);
+
+            VkCommandBufferAllocateInfo command_buffer_alloc_info = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .pNext = nullptr,
+                .commandPool = pool.CommandPool,
+                .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+                .commandBufferCount = chunks - allocated
+            };
+
+            vk_check(vkAllocateCommandBuffers(
+                       m_driver,
+                       &command_buffer_alloc_info,
+                       pool.CommandBuffers.data() + allocated),
+                     "vkAllocateCommandBuffers",
+                     __FUNCTION__);
+        }
+
+        uint32_t index = 0;
+        for (uint32_t chunk = p_thread; chunk < m_chunk_count;
+             chunk += m_thread_count) {
+            VkCommandBuffer command_buffer = pool.CommandBuffers[index++];
+            begin_secondary(command_buffer, *m_inheritance, m_usage);
+            (*m_callable)(command_buffer, chunk);
+
+            vkEndCommandBuffer(command_buffer);
+            m_recorded[m_slot][chunk] = command_buffer;
+        }
+    }
+
+    void vk_parallel_recorder::destroy() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_condition.notify_all();
+
+        for (std::thread& worker : m_workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+        m_workers.clear();
+
+        // destroying a pool frees the command buffers allocated from it
+        for (thread_pool& pool : m_pools) {
+            vkDestroyCommandPool(m_driver, pool.CommandPool, nullptr);
+        }
+        m_pools.clear();
+        m_recorded.clear();
+    }
+};
@@ -3,21 +3,88 @@
 #include <vulkan-cpp/helper_functions.hpp>
 #include <vulkan-cpp/logger.hpp>
 #include <vulkan-cpp/vk_driver.hpp>
-#include <vulkan-cpp/vk_window.hpp>
+#include <vulkan-cpp/vk_swapchain.hpp>
+#include <algorithm>
+#include <renderer/hash.hpp>
 
 namespace vk {
     vk_pipeline::vk_pipeline(
       const VkRenderPass& p_renderpass,
       vk_shader& p_shader_src,
-      const VkDescriptorSetLayout& p_descriptor_sets) {
-        int width = 0;
-        int height = 0;
+      const VkDescriptorSetLayout& p_descriptor_sets,
+      std::span<const VkPushConstantRange> p_push_constants) {
         m_driver = vk_driver::driver_context();
-        GLFWwindow* handle = vk_window::native_window();
+        m_owns_layout = true;
 
-        console_log_info("vk_pipeline begin initialization!!!");
+        VkPipelineLayoutCreateInfo pipeline_layout_ci = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+            .pushConstantRangeCount =
+              static_cast<uint32_t>(p_push_constants.size()),
+            .pPushConstantRanges = p_push_constants.data()
+        };
+
+		//! @note This is just to double-check that the descriptor set layout is valid.
+		//! @note If the descriptor set layout is invalid, then proceed but not use the descriptor set layout
+        VkDescriptorSetLayout layout = p_descriptor_sets;
+
+        if (layout != nullptr) {
+            pipeline_layout_ci.setLayoutCount = 1;
+            pipeline_layout_ci.pSetLayouts = &layout;
+        }
+        else {
+            pipeline_layout_ci.setLayoutCount = 0;
+            pipeline_layout_ci.pSetLayouts = nullptr;
+        }
+
+        vk::vk_check(
+          vkCreatePipelineLayout(
+            m_driver, &pipeline_layout_ci, nullptr, &m_pipeline_layout),
+          "vkCreatePipelineLayout",
+          __FUNCTION__);
+
+        create_pipeline(p_renderpass, p_shader_src);
+    }
+
+    vk_pipeline::vk_pipeline(
+      vk_descriptor_layout_cache& p_layout_cache,
+      const VkRenderPass& p_renderpass,
+      vk_shader& p_shader_src,
+      std::span<const VkDescriptorSetLayout> p_set_layouts,
+      std::span<const VkPushConstantRange> p_push_constants) {
+        m_driver = vk_driver::driver_context();
+
+        // pipelines sharing set layouts share one pipeline layout, which is
+        // owned by the cache
+        m_pipeline_layout = p_layout_cache.create_pipeline_layout(
+          p_set_layouts, p_push_constants);
+        m_owns_layout = false;
+
+        // set layouts living in descriptor buffers need a pipeline that
+        // reads its descriptors from descriptor buffers too
+        for (VkDescriptorSetLayout set_layout : p_set_layouts) {
+            if (p_layout_cache.layout_flags(set_layout) &
+                VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT) {
+                m_create_flags |= VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+            }
+        }
+
+        create_pipeline(p_renderpass, p_shader_src);
+    }
+
+    vk_pipeline::vk_pipeline(const pipeline_description& p_description,
+                             VkPipelineCache p_pipeline_cache) {
+        m_driver = vk_driver::driver_context();
+
+        // the layout comes from the description, whoever built it owns it
+        m_pipeline_layout = p_description.Layout;
+        m_owns_layout = false;
+        m_create_flags = p_description.Flags;
 
-        glfwGetFramebufferSize(handle, &width, &height);
+        create_pipeline(p_description, p_pipeline_cache);
+    }
+
+    void vk_pipeline::create_pipeline(const VkRenderPass& p_renderpass,
+                                      vk_shader& p_shader_src) {
         VkShaderModule vert_module = p_shader_src.get_vertex_module();
         VkShaderModule frag_module = p_shader_src.get_fragment_module();
 
@@ -29,211 +96,437 @@ namespace vk {
             console_log_trace("fragment shader module is valid!!!");
         }
 
-        VkPipelineShaderStageCreateInfo vertex_pipeine_stage_ci = {
+        const std::span<VkVertexInputBindingDescription>
+          bind_vertex_attributes = p_shader_src.get_vertex_bind_attributes();
+        const std::span<VkVertexInputAttributeDescription> vertex_attributes =
+          p_shader_src.get_vertex_attributes();
+
+        //! @note The default states these constructors have always used,
+        //! alpha blending with depth testing and no culling
+        pipeline_description description = {
+            .VertexModule = vert_module,
+            .FragmentModule = frag_module,
+            .VertexBindings = { bind_vertex_attributes.begin(),
+                                bind_vertex_attributes.end() },
+            .VertexAttributes = { vertex_attributes.begin(),
+                                  vertex_attributes.end() },
+            .Layout = m_pipeline_layout,
+            .RenderPass = p_renderpass,
+            .Flags = m_create_flags,
+        };
+
+        // a swapchain using dynamic rendering has no render pass, these
+        // constructors always target the swapchain
+        if (p_renderpass == nullptr) {
+            description.ColorFormats = {
+                vk_swapchain::data().SurfaceFormat.format
+            };
+            description.DepthFormat = vk_driver::depth_format();
+        }
+
+        create_pipeline(description, nullptr);
+    }
+
+    vk_pipeline::vk_pipeline(VkPipelineLayout p_pipeline_layout,
+                             VkPipeline p_pipeline) {
+        m_driver = vk_driver::driver_context();
+        m_pipeline_layout = p_pipeline_layout;
+        m_owns_layout = false;
+        m_pipeline = p_pipeline;
+    }
+
+    void vk_pipeline::create_pipeline(
+      const pipeline_description& p_description,
+      VkPipelineCache p_pipeline_cache) {
+        console_log_info("vk_pipeline begin initialization!!!");
+
+        pipeline_create_info create_info(p_description);
+        VkGraphicsPipelineCreateInfo graphics_pipeline_ci = create_info.get();
+
+        vk::vk_check(vkCreateGraphicsPipelines(m_driver,
+                                               p_pipeline_cache,
+                                               1,
+                                               &graphics_pipeline_ci,
+                                               nullptr,
+                                               &m_pipeline),
+                     "vkCreateGraphicsPipelines",
+                     __FUNCTION__);
+
+        console_log_info("vk_pipeline successfully initialized!!!!\n\n");
+    }
+
+    void vk_pipeline::destroy() {
+        if (m_owns_layout) {
+            vkDestroyPipelineLayout(m_driver, m_pipeline_layout, nullptr);
+        }
+        vkDestroyPipeline(m_driver, m_pipeline, nullptr);
+    }
+
+    void vk_pipeline::bind(const VkCommandBuffer& p_command_buffer) {
+        vkCmdBindPipeline(
+          p_command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
+    }
+
+    void vk_pipeline::push_constants(const VkCommandBuffer& p_command_buffer,
+                                     VkShaderStageFlags p_stages,
+                                     uint32_t p_offset,
+                                     uint32_t p_size,
+                                     const void* p_data) {
+        vkCmdPushConstants(p_command_buffer,
+                           m_pipeline_layout,
+                           p_stages,
+                           p_offset,
+                           p_size,
+                           p_data);
+    }
+
+    pipeline_create_info::pipeline_create_info(
+      const pipeline_description& p_description)
+      : m_specialization_constants(p_description.SpecializationConstants) {
+        m_shader_stages[0] = {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
             .stage = VK_SHADER_STAGE_VERTEX_BIT,
-            .module = vert_module,
+            .module = p_description.VertexModule,
             .pName = "main"
         };
 
-        VkPipelineShaderStageCreateInfo fragment_pipeine_stage_ci = {
+        m_shader_stages[1] = {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
             .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-            .module = frag_module,
+            .module = p_description.FragmentModule,
             .pName = "main"
         };
 
-        std::array<VkPipelineShaderStageCreateInfo, 2> shader_stages = {
-            vertex_pipeine_stage_ci, fragment_pipeine_stage_ci
-        };
-
-        const std::span<VkVertexInputBindingDescription> bind_vertex_attributes = p_shader_src.get_vertex_bind_attributes();
-        const std::span<VkVertexInputAttributeDescription> vertex_attributes = p_shader_src.get_vertex_attributes();
-
-        VkPipelineVertexInputStateCreateInfo vertex_input_info = {
+        m_vertex_input = {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-            .vertexBindingDescriptionCount = static_cast<uint32_t>(bind_vertex_attributes.size()),
-            .pVertexBindingDescriptions = bind_vertex_attributes.data(), // Optional: Enabled
-            .vertexAttributeDescriptionCount = static_cast<uint32_t>(vertex_attributes.size()),
-            .pVertexAttributeDescriptions = vertex_attributes.data(), // Optional: Enabled
+            .vertexBindingDescriptionCount =
+              static_cast<uint32_t>(p_description.VertexBindings.size()),
+            .pVertexBindingDescriptions = p_description.VertexBindings.data(),
+            .vertexAttributeDescriptionCount =
+              static_cast<uint32_t>(p_description.VertexAttributes.size()),
+            .pVertexAttributeDescriptions =
+              p_description.VertexAttributes.data(),
         };
 
-        VkPipelineInputAssemblyStateCreateInfo inputAssembly = {
+        m_input_assembly = {
             .sType =
               VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
-            .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
-            .primitiveRestartEnable = VK_FALSE,
+            .topology = p_description.Topology,
+            .primitiveRestartEnable = p_description.PrimitiveRestart,
         };
-        // VkExtent2D swapchain_extent = vk::vk_swapchain::get_extent();
-        console_log_trace("W = {}, H = {}", width, height);
-
-        VkViewport viewport = {
-            .x = 0.0f,
-            .y = 0.0f,
-            .width = (float)width,
-            .height = (float)height,
-            .minDepth = 0.0f,
-            .maxDepth = 1.0f,
-        };
-
-        VkRect2D scissor = { .offset = { 0, 0 },
-                             .extent = { (uint32_t)width, (uint32_t)height } };
 
-        VkPipelineViewportStateCreateInfo viewportState = {
+        //! @note Viewport and scissor are dynamic, only their counts are baked
+        m_viewport = {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
             .viewportCount = 1,
             .scissorCount = 1,
         };
 
         //! @note Rasterization
-        VkPipelineRasterizationStateCreateInfo rasterizer_ci = {
+        const pipeline_raster_state& raster = p_description.Raster;
+        m_rasterizer = {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
             .depthClampEnable = VK_FALSE,
-            .rasterizerDiscardEnable =
-              VK_FALSE, // set to true make fragmenta that are beyond near/far
-                        // planes clamped to them as opposed to discarding them
-            .polygonMode =
-              VK_POLYGON_MODE_FILL, // if set to true then geometry never passes
-                                    // through rasterizer stage. This basically
-                                    // disables output to frame_buffer
-            .lineWidth = 1.0f,      // represents thickness of lines
-            .cullMode =
-			VK_CULL_MODE_NONE, // determines what culling to use. Can also
-                                     // be disabled, culls front-face, back-face
-                                     // or both
-            .frontFace =
-			VK_FRONT_FACE_COUNTER_CLOCKWISE, // specifies vertex order of fdaces
-                                       // considered front-face or
-                                       // clockwise/counter-clockwise
-            .depthBiasEnable = VK_FALSE,
-            .depthBiasConstantFactor = 0.0f, // Optional
-            .depthBiasClamp = 0.0f,          // Optional
-            .depthBiasSlopeFactor = 0.0f,    // Optional
+            .rasterizerDiscardEnable = VK_FALSE,
+            .polygonMode = raster.PolygonMode,
+            .cullMode = raster.CullMode,
+            .frontFace = raster.FrontFace,
+            .depthBiasEnable = raster.DepthBiasEnable,
+            .depthBiasConstantFactor = raster.DepthBiasConstant,
+            .depthBiasClamp = 0.0f,
+            .depthBiasSlopeFactor = raster.DepthBiasSlope,
+            .lineWidth = raster.LineWidth,
         };
 
         //! @note Multi-sampling
-        VkPipelineMultisampleStateCreateInfo multisampling_ci = {
+        m_multisampling = {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+            .rasterizationSamples = p_description.Samples,
             .sampleShadingEnable = VK_FALSE,
-            .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
-            // .minSampleShading = 1.0f,          // Optional
-            // .pSampleMask = nullptr,            // Optional
-            // .alphaToCoverageEnable = VK_FALSE, // Optional
-            // .alphaToOneEnable = VK_FALSE,      // Optional
         };
 
-        // Color blending Attachment -- blending color when the fragment returns
-        // the color
-        VkPipelineColorBlendAttachmentState color_blend_attachment = {
-            .blendEnable = true,
-            .srcColorBlendFactor =
-              VK_BLEND_FACTOR_SRC_ALPHA, // Enabled: alpha blending
-            .dstColorBlendFactor =
-              VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, // Enabled: alpha blending
-            .colorBlendOp = VK_BLEND_OP_ADD,       // Enabled: alpha blending
-            .srcAlphaBlendFactor =
-              VK_BLEND_FACTOR_ONE, // Enabled: alpha blending
-            .dstAlphaBlendFactor =
-              VK_BLEND_FACTOR_ZERO,          // Enabled: alpha blending
-            .alphaBlendOp = VK_BLEND_OP_ADD, // Enabled: alpha blending
-            .colorWriteMask =
-              VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
-              VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+        // Enable depth-stencil state
+        const pipeline_depth_state& depth = p_description.Depth;
+        m_depth_stencil = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+            .depthTestEnable = depth.TestEnable,
+            .depthWriteEnable = depth.WriteEnable,
+            .depthCompareOp = depth.CompareOp,
+            .depthBoundsTestEnable = false,
+            .stencilTestEnable = false,
         };
 
-        VkPipelineColorBlendStateCreateInfo color_blending_ci = {
+        // Color blending Attachment -- blending color when the fragment returns
+        // the color, every color attachment shares the same blend state
+        const pipeline_blend_state& blend = p_description.Blend;
+        m_color_blend_attachments.fill({
+          .blendEnable = blend.Enable,
+          .srcColorBlendFactor = blend.SrcColor,
+          .dstColorBlendFactor = blend.DstColor,
+          .colorBlendOp = blend.ColorOp,
+          .srcAlphaBlendFactor = blend.SrcAlpha,
+          .dstAlphaBlendFactor = blend.DstAlpha,
+          .alphaBlendOp = blend.AlphaOp,
+          .colorWriteMask = blend.WriteMask,
+        });
+
+        m_color_blending = {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
             .logicOpEnable = VK_FALSE,
             .logicOp = VK_LOGIC_OP_COPY, // Optional
-            .attachmentCount = 1,
-            .pAttachments = &color_blend_attachment,
+            .attachmentCount = p_description.color_attachment_count(),
             // these are optional
             .blendConstants = { 0.f, 0.f, 0.f, 0.f } // optional
         };
 
-        // Enable depth-stencil state
-        VkPipelineDepthStencilStateCreateInfo pipeline_deth_stencil_state_ci = {
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
-            .depthTestEnable = true,
-            .depthWriteEnable = true,
-            .depthCompareOp = VK_COMPARE_OP_LESS,
-            .depthBoundsTestEnable = false,
-            .stencilTestEnable = false,
-        };
-
         //! @note Dynamic State
         //! @note -- pipeline states needs to be baked into the pipeline state
-        std::array<VkDynamicState, 2> dynamic_states = {
-            VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR
+        uint32_t dynamic_state_count = 0;
+        auto add_dynamic_state = [&](VkDynamicState p_state) {
+            m_dynamic_states[dynamic_state_count++] = p_state;
         };
 
-        VkPipelineDynamicStateCreateInfo dynamic_state_ci = {
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
-            .dynamicStateCount = static_cast<uint32_t>(dynamic_states.size()),
-            .pDynamicStates = dynamic_states.data()
-        };
+        add_dynamic_state(VK_DYNAMIC_STATE_VIEWPORT);
+        add_dynamic_state(VK_DYNAMIC_STATE_SCISSOR);
 
-        VkPipelineLayoutCreateInfo pipeline_layout_ci = {
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-        };
+        const device_features& features =
+          vk_driver::driver_context().enabled_features();
 
-		//! @note This is just to double-check that the descriptor set layout is valid.
-		//! @note If the descriptor set layout is invalid, then proceed but not use the descriptor set layout
-        VkDescriptorSetLayout layout = p_descriptor_sets;
+        if (p_description.DynamicState and features.ExtendedDynamicState) {
+            add_dynamic_state(VK_DYNAMIC_STATE_CULL_MODE);
+            add_dynamic_state(VK_DYNAMIC_STATE_FRONT_FACE);
+            add_dynamic_state(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY);
+            add_dynamic_state(VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE);
+            add_dynamic_state(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE);
+            add_dynamic_state(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE);
+            add_dynamic_state(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP);
+            add_dynamic_state(VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE);
+            add_dynamic_state(VK_DYNAMIC_STATE_DEPTH_BIAS);
+            add_dynamic_state(VK_DYNAMIC_STATE_LINE_WIDTH);
+        }
 
-        if (layout != nullptr) {
-            pipeline_layout_ci.setLayoutCount = 1;
-            pipeline_layout_ci.pSetLayouts = &layout;
+        if (p_description.DynamicState and features.ExtendedDynamicState3) {
+            add_dynamic_state(VK_DYNAMIC_STATE_POLYGON_MODE_EXT);
+            add_dynamic_state(VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT);
+            add_dynamic_state(VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT);
+            add_dynamic_state(VK_DYNAMIC_STATE_COLOR_WRITE_MASK_EXT);
         }
-        else {
-            pipeline_layout_ci.setLayoutCount = 0;
-            pipeline_layout_ci.pSetLayouts = nullptr;
+
+        if (p_description.DynamicState and features.VertexInputDynamicState) {
+            add_dynamic_state(VK_DYNAMIC_STATE_VERTEX_INPUT_EXT);
         }
 
-        vk::vk_check(
-          vkCreatePipelineLayout(
-            m_driver, &pipeline_layout_ci, nullptr, &m_pipeline_layout),
-          "vkCreatePipelineLayout",
-          __FUNCTION__);
+        m_dynamic_state = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+            .dynamicStateCount = dynamic_state_count,
+        };
 
-        VkGraphicsPipelineCreateInfo graphics_pipeline_ci = {
+        // dynamic rendering has no render pass to take the attachment
+        // formats from, so they are given to the pipeline directly
+        if (p_description.RenderPass == nullptr) {
+            uint32_t color_count = p_description.color_attachment_count();
+            std::copy_n(p_description.ColorFormats.begin(),
+                        color_count,
+                        m_color_formats.begin());
+
+            m_rendering = {
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+                .pNext = nullptr,
+                .viewMask = 0,
+                .colorAttachmentCount = color_count,
+                .depthAttachmentFormat = p_description.DepthFormat,
+                .stencilAttachmentFormat = VK_FORMAT_UNDEFINED
+            };
+        }
+
+        m_create_info = {
             .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
             .pNext = nullptr,
-            .flags = 0,
-            .stageCount = static_cast<uint32_t>(shader_stages.size()),
-            .pStages = shader_stages.data(),
-            .pVertexInputState = &vertex_input_info,
-            .pInputAssemblyState = &inputAssembly,
-            .pViewportState = &viewportState,
-            .pRasterizationState = &rasterizer_ci,
-            .pMultisampleState = &multisampling_ci,
-            // .pDepthStencilState = nullptr, // Optional
-            .pDepthStencilState = &pipeline_deth_stencil_state_ci,
-            .pColorBlendState = &color_blending_ci,
-            .pDynamicState = &dynamic_state_ci,
-            .layout = m_pipeline_layout,
-            .renderPass = p_renderpass,
-            .subpass = 0,
+            .flags = p_description.Flags,
+            .stageCount = static_cast<uint32_t>(m_shader_stages.size()),
+            .layout = p_description.Layout,
+            .renderPass = p_description.RenderPass,
+            .subpass = p_description.Subpass,
             .basePipelineHandle = nullptr,
             .basePipelineIndex = -1
         };
+    }
 
-        vk::vk_check(
-          vkCreateGraphicsPipelines(
-            m_driver, nullptr, 1, &graphics_pipeline_ci, nullptr, &m_pipeline),
-          "vkCreateGraphicsPipelines",
-          __FUNCTION__);
+    VkGraphicsPipelineCreateInfo pipeline_create_info::get() {
+        // pointers are only taken here, so the object may be moved around
+        // freely before this gets called
+        m_specialization = m_specialization_constants.get();
+        m_shader_stages[0].pSpecializationInfo = &m_specialization;
+        m_shader_stages[1].pSpecializationInfo = &m_specialization;
 
-        console_log_info("vk_pipeline successfully initialized!!!!\n\n");
+        m_color_blending.pAttachments = m_color_blend_attachments.data();
+        m_dynamic_state.pDynamicStates = m_dynamic_states.data();
+
+        if (m_rendering.sType ==
+            VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO) {
+            m_rendering.pColorAttachmentFormats = m_color_formats.data();
+            m_create_info.pNext = &m_rendering;
+        }
+
+        m_create_info.pStages = m_shader_stages.data();
+        m_create_info.pVertexInputState = &m_vertex_input;
+        m_create_info.pInputAssemblyState = &m_input_assembly;
+        m_create_info.pViewportState = &m_viewport;
+        m_create_info.pRasterizationState = &m_rasterizer;
+        m_create_info.pMultisampleState = &m_multisampling;
+        m_create_info.pDepthStencilState = &m_depth_stencil;
+        m_create_info.pColorBlendState = &m_color_blending;
+        m_create_info.pDynamicState = &m_dynamic_state;
+        return m_create_info;
     }
 
-    void vk_pipeline::destroy() {
-        vkDestroyPipelineLayout(m_driver, m_pipeline_layout, nullptr);
-        vkDestroyPipeline(m_driver, m_pipeline, nullptr);
+    //! @note With dynamic topology only the topology class has to match the
+    //! pipeline, so every topology maps to the list of its class
+    static VkPrimitiveTopology topology_class(VkPrimitiveTopology p_topology) {
+        switch (p_topology) {
+            case VK_PRIMITIVE_TOPOLOGY_POINT_LIST:
+                return VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+            case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+            case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+            case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+            case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+                return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+            case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST:
+                return VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
+            default:
+                return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        }
     }
 
-    void vk_pipeline::bind(const VkCommandBuffer& p_command_buffer) {
-        vkCmdBindPipeline(
-          p_command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
+    pipeline_description pipeline_description::canonical() const {
+        pipeline_description description = *this;
+        if (!DynamicState) {
+            return description;
+        }
+
+        const device_features& features =
+          vk_driver::driver_context().enabled_features();
+
+        if (features.ExtendedDynamicState) {
+            description.Topology = topology_class(Topology);
+            description.PrimitiveRestart = false;
+            description.Raster = { .PolygonMode = Raster.PolygonMode };
+            description.Depth = {};
+        }
+
+        if (features.ExtendedDynamicState3) {
+            description.Raster.PolygonMode = VK_POLYGON_MODE_FILL;
+            description.Blend = {};
+        }
+
+        if (features.VertexInputDynamicState) {
+            description.VertexBindings.clear();
+            description.VertexAttributes.clear();
+        }
+
+        return description;
+    }
+
+    bool pipeline_description::operator==(
+      const pipeline_description& p_other) const {
+        auto same_binding = [](const VkVertexInputBindingDescription& p_a,
+                               const VkVertexInputBindingDescription& p_b) {
+            return p_a.binding == p_b.binding and p_a.stride == p_b.stride and
+                   p_a.inputRate == p_b.inputRate;
+        };
+        auto same_attribute =
+          [](const VkVertexInputAttributeDescription& p_a,
+             const VkVertexInputAttributeDescription& p_b) {
+              return p_a.location == p_b.location and
+                     p_a.binding == p_b.binding and
+                     p_a.format == p_b.format and p_a.offset == p_b.offset;
+          };
+
+        return VertexModule == p_other.VertexModule and
+               FragmentModule == p_other.FragmentModule and
+               SpecializationConstants == p_other.SpecializationConstants and
+               std::equal(VertexBindings.begin(),
+                          VertexBindings.end(),
+                          p_other.VertexBindings.begin(),
+                          p_other.VertexBindings.end(),
+                          same_binding) and
+               std::equal(VertexAttributes.begin(),
+                          VertexAttributes.end(),
+                          p_other.VertexAttributes.begin(),
+                          p_other.VertexAttributes.end(),
+                          same_attribute) and
+               Topology == p_other.Topology and
+               PrimitiveRestart == p_other.PrimitiveRestart and
+               Raster == p_other.Raster and Depth == p_other.Depth and
+               Blend == p_other.Blend and Samples == p_other.Samples and
+               Layout == p_other.Layout and
+               RenderPass == p_other.RenderPass and
+               Subpass == p_other.Subpass and
+               ColorFormats == p_other.ColorFormats and
+               DepthFormat == p_other.DepthFormat and Flags == p_other.Flags and
+               DynamicState == p_other.DynamicState;
+    }
+
+    size_t pipeline_description_hash::operator()(
+      const pipeline_description& p_description) const {
+        size_t seed = 0;
+        hash_combine(seed,
+                     p_description.VertexModule,
+                     p_description.FragmentModule,
+                     p_description.SpecializationConstants,
+                     p_description.Layout,
+                     p_description.RenderPass,
+                     p_description.Subpass,
+                     p_description.Flags,
+                     p_description.DynamicState);
+
+        for (const VkVertexInputBindingDescription& binding :
+             p_description.VertexBindings) {
+            hash_combine(
+              seed, binding.binding, binding.stride, binding.inputRate);
+        }
+
+        for (const VkVertexInputAttributeDescription& attribute :
+             p_description.VertexAttributes) {
+            hash_combine(seed,
+                         attribute.location,
+                         attribute.binding,
+                         attribute.format,
+                         attribute.offset);
+        }
+
+        const pipeline_raster_state& raster = p_description.Raster;
+        hash_combine(seed,
+                     p_description.Topology,
+                     p_description.PrimitiveRestart,
+                     raster.PolygonMode,
+                     raster.CullMode,
+                     raster.FrontFace,
+                     raster.DepthBiasEnable,
+                     raster.DepthBiasConstant,
+                     raster.DepthBiasSlope,
+                     raster.LineWidth);
+
+        const pipeline_depth_state& depth = p_description.Depth;
+        hash_combine(
+          seed, depth.TestEnable, depth.WriteEnable, depth.CompareOp);
+
+        const pipeline_blend_state& blend = p_description.Blend;
+        hash_combine(seed,
+                     blend.Enable,
+                     blend.SrcColor,
+                     blend.DstColor,
+                     blend.ColorOp,
+                     blend.SrcAlpha,
+                     blend.DstAlpha,
+                     blend.AlphaOp,
+                     blend.WriteMask);
+
+        hash_combine(seed, p_description.Samples, p_description.DepthFormat);
+        for (VkFormat format : p_description.ColorFormats) {
+            hash_combine(seed, format);
+        }
+
+        return seed;
     }
 };
\ No newline at end of file
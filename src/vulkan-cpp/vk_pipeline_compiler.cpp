@@ -0,0 +1,165 @@
+#include <vulkan-cpp/vk_pipeline_compiler.hpp>
+#include <vulkan-cpp/logger.hpp>
+#include <algorithm>
+
+namespace vk {
+
+    vk_pipeline_compiler::vk_pipeline_compiler(
+      VkPipelineCache p_pipeline_cache,
+      uint32_t p_thread_count,
+      vk_pipeline_library* p_library) {
+        m_driver = vk_driver::driver_context();
+        m_pipeline_cache = p_pipeline_cache;
+        m_library = p_library;
+
+        // leave one core for the render thread
+        if (p_thread_count == 0) {
+            uint32_t cores = std::thread::hardware_concurrency();
+            p_thread_count = std::clamp(cores > 1 ? cores - 1 : 1u,
+                                        1u,
+                                        MaxThreads);
+        }
+
+        for (uint32_t i = 0; i < p_thread_count; i++) {
+            m_workers.emplace_back([this]() { worker_loop(); });
+        }
+
+        console_log_trace("vk_pipeline_compiler started {} threads",
+                          p_thread_count);
+    }
+
+    void vk_pipeline_compiler::submit(
+      const pipeline_description& p_description) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_requests.push_back(p_description);
+            m_pending++;
+        }
+        m_condition.notify_one();
+    }
+
+    std::vector<compiled_pipeline> vk_pipeline_compiler::collect() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<compiled_pipeline> compiled = std::move(m_compiled);
+        m_compiled.clear();
+        m_pending -= static_cast<uint32_t>(compiled.size());
+        return compiled;
+    }
+
+    uint32_t vk_pipeline_compiler::pending() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_pending;
+    }
+
+    void vk_pipeline_compiler::worker_loop() {
+        std::vector<pipeline_description> batch;
+        batch.reserve(MaxBatchSize);
+
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this]() {
+                    return m_stop or !m_requests.empty();
+                });
+
+                if (m_stop) {
+                    return;
+                }
+
+                // variants tend to be requested in bursts (ie a new material
+                // loading), so take as many as one call can create
+                while (!m_requests.empty() and batch.size() < MaxBatchSize) {
+                    batch.push_back(std::move(m_requests.front()));
+                    m_requests.pop_front();
+                }
+            }
+
+            if (m_library != nullptr) {
+                link_batch(batch);
+            }
+            else {
+                compile_batch(batch);
+            }
+            batch.clear();
+        }
+    }
+
+    void vk_pipeline_compiler::compile_batch(
+      std::vector<pipeline_description>& p_batch) {
+        // create infos are only linked up once the vector stops growing
+        std::vector<pipeline_create_info> create_infos;
+        create_infos.reserve(p_batch.size());
+        for (const pipeline_description& description : p_batch) {
+            create_infos.emplace_back(description);
+        }
+
+        std::vector<VkGraphicsPipelineCreateInfo> graphics_pipeline_cis;
+        graphics_pipeline_cis.reserve(create_infos.size());
+        for (pipeline_create_info& create_info : create_infos) {
+            graphics_pipeline_cis.push_back(create_info.get());
+        }
+
+        // on failure the pipelines that did compile still get handles, the
+        // rest are left null
+        std::vector<VkPipeline> pipelines(p_batch.size(), nullptr);
+        VkResult res = vkCreateGraphicsPipelines(
+          m_driver,
+          m_pipeline_cache,
+          static_cast<uint32_t>(graphics_pipeline_cis.size()),
+          graphics_pipeline_cis.data(),
+          nullptr,
+          pipelines.data());
+
+        if (res != VK_SUCCESS) {
+            console_log_error("vk_pipeline_compiler: vkCreateGraphicsPipelines "
+                              "failed for a batch of {} ({})",
+                              p_batch.size(),
+                              static_cast<int>(res));
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < p_batch.size(); i++) {
+            m_compiled.push_back({ .Description = std::move(p_batch[i]),
+                                   .Pipeline = pipelines[i] });
+        }
+    }
+
+    void vk_pipeline_compiler::link_batch(
+      std::vector<pipeline_description>& p_batch) {
+        // links cannot be batched into one call, but they do not need to be,
+        // all the shader compilation already happened in the library parts
+        std::vector<VkPipeline> pipelines;
+        pipelines.reserve(p_batch.size());
+        for (const pipeline_description& description : p_batch) {
+            pipelines.push_back(m_library->link(description, true));
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < p_batch.size(); i++) {
+            m_compiled.push_back({ .Description = std::move(p_batch[i]),
+                                   .Pipeline = pipelines[i] });
+        }
+    }
+
+    void vk_pipeline_compiler::destroy() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_condition.notify_all();
+
+        for (std::thread& worker : m_workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+        m_workers.clear();
+
+        for (const compiled_pipeline& compiled : m_compiled) {
+            vkDestroyPipeline(m_driver, compiled.Pipeline, nullptr);
+        }
+        m_compiled.clear();
+        m_requests.clear();
+        m_pending = 0;
+    }
+};
@@ -0,0 +1,251 @@
+#include <vulkan-cpp/vk_pipeline_library.hpp>
+#include <vulkan-cpp/helper_functions.hpp>
+#include <vulkan-cpp/logger.hpp>
+
+namespace vk {
+
+    static VkGraphicsPipelineLibraryFlagsEXT library_flags(
+      pipeline_library_part p_part) {
+        switch (p_part) {
+            case pipeline_library_part::VertexInput:
+                return VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+            case pipeline_library_part::PreRasterization:
+                return VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+            case pipeline_library_part::FragmentShader:
+                return VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+            case pipeline_library_part::FragmentOutput:
+                return VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+        }
+        return 0;
+    }
+
+    //! @note Copy of p_description holding only the state p_part reads,
+    //! everything else is left at its defaults so descriptions that agree on
+    //! that state share the part
+    static pipeline_description part_key(
+      const pipeline_description& p_description,
+      pipeline_library_part p_part) {
+        pipeline_description key = {
+            .RenderPass = p_description.RenderPass,
+            .Subpass = p_description.Subpass,
+            .Flags = p_description.Flags,
+            .DynamicState = p_description.DynamicState,
+        };
+
+        switch (p_part) {
+            case pipeline_library_part::VertexInput:
+                key.VertexBindings = p_description.VertexBindings;
+                key.VertexAttributes = p_description.VertexAttributes;
+                key.Topology = p_description.Topology;
+                key.PrimitiveRestart = p_description.PrimitiveRestart;
+                break;
+            case pipeline_library_part::PreRasterization:
+                key.VertexModule = p_description.VertexModule;
+                key.SpecializationConstants =
+                  p_description.SpecializationConstants;
+                key.Raster = p_description.Raster;
+                key.Layout = p_description.Layout;
+                break;
+            case pipeline_library_part::FragmentShader:
+                key.FragmentModule = p_description.FragmentModule;
+                key.SpecializationConstants =
+                  p_description.SpecializationConstants;
+                key.Depth = p_description.Depth;
+                key.Samples = p_description.Samples;
+                key.Layout = p_description.Layout;
+                key.DepthFormat = p_description.DepthFormat;
+                break;
+            case pipeline_library_part::FragmentOutput:
+                key.Blend = p_description.Blend;
+                key.Samples = p_description.Samples;
+                key.ColorFormats = p_description.ColorFormats;
+                key.DepthFormat = p_description.DepthFormat;
+                break;
+        }
+
+        return key;
+    }
+
+    vk_pipeline_library::vk_pipeline_library(
+      VkPipelineCache p_pipeline_cache) {
+        vk_driver& driver = vk_driver::driver_context();
+        if (!driver.enabled_features().GraphicsPipelineLibrary) {
+            console_log_error("vk_pipeline_library: graphics pipeline "
+                              "libraries are not supported by this device!!!");
+            return;
+        }
+
+        m_driver = driver;
+        m_pipeline_cache = p_pipeline_cache;
+    }
+
+    VkPipeline vk_pipeline_library::get_part(
+      const pipeline_description& p_description,
+      pipeline_library_part p_part) {
+        auto& parts = m_parts[static_cast<uint32_t>(p_part)];
+        pipeline_description key = part_key(p_description, p_part);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = parts.find(key);
+            if (it != parts.end()) {
+                return it->second;
+            }
+        }
+
+        // compiled without the lock, so threads compiling other parts do
+        // not wait on this one
+        VkPipeline part = compile_part(key, p_part);
+        if (part == nullptr) {
+            return nullptr;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto [it, inserted] = parts.emplace(std::move(key), part);
+
+        // another thread compiled the same part in the meantime
+        if (!inserted) {
+            vkDestroyPipeline(m_driver, part, nullptr);
+        }
+        return it->second;
+    }
+
+    VkPipeline vk_pipeline_library::compile_part(
+      const pipeline_description& p_key,
+      pipeline_library_part p_part) {
+        pipeline_create_info create_info(p_key);
+        VkGraphicsPipelineCreateInfo graphics_pipeline_ci = create_info.get();
+
+        // each part only takes the shader stage it compiles
+        switch (p_part) {
+            case pipeline_library_part::PreRasterization:
+                graphics_pipeline_ci.stageCount = 1;
+                break;
+            case pipeline_library_part::FragmentShader:
+                graphics_pipeline_ci.stageCount = 1;
+                graphics_pipeline_ci.pStages++;
+                break;
+            default:
+                graphics_pipeline_ci.stageCount = 0;
+                graphics_pipeline_ci.pStages = nullptr;
+                break;
+        }
+
+        VkGraphicsPipelineLibraryCreateInfoEXT library_ci = {
+            .sType =
+              VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+            .pNext = graphics_pipeline_ci.pNext,
+            .flags = library_flags(p_part)
+        };
+        graphics_pipeline_ci.pNext = &library_ci;
+
+        // retaining the link time optimization info is what allows the
+        // optimized link later on
+        graphics_pipeline_ci.flags |=
+          VK_PIPELINE_CREATE_LIBRARY_BIT_KHR |
+          VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+
+        VkPipeline part = nullptr;
+        VkResult res = vkCreateGraphicsPipelines(m_driver,
+                                                 m_pipeline_cache,
+                                                 1,
+                                                 &graphics_pipeline_ci,
+                                                 nullptr,
+                                                 &part);
+        if (res != VK_SUCCESS) {
+            console_log_error("vk_pipeline_library: compiling part {} failed "
+                              "({})",
+                              static_cast<uint32_t>(p_part),
+                              static_cast<int>(res));
+            return nullptr;
+        }
+
+        return part;
+    }
+
+    VkPipeline vk_pipeline_library::link(
+      const pipeline_description& p_description,
+      bool p_optimize) {
+        std::array<VkPipeline, PipelineLibraryPartCount> libraries{};
+        for (uint32_t i = 0; i < PipelineLibraryPartCount; i++) {
+            libraries[i] =
+              get_part(p_description, static_cast<pipeline_library_part>(i));
+            if (libraries[i] == nullptr) {
+                return nullptr;
+            }
+        }
+
+        VkPipelineLibraryCreateInfoKHR library_ci = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+            .pNext = nullptr,
+            .libraryCount = static_cast<uint32_t>(libraries.size()),
+            .pLibraries = libraries.data()
+        };
+
+        VkPipelineCreateFlags flags = p_description.Flags;
+        if (p_optimize) {
+            flags |= VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT;
+        }
+
+        // every piece of state comes from the libraries
+        VkGraphicsPipelineCreateInfo graphics_pipeline_ci = {
+            .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+            .pNext = &library_ci,
+            .flags = flags,
+            .layout = p_description.Layout,
+            .basePipelineHandle = nullptr,
+            .basePipelineIndex = -1
+        };
+
+        VkPipeline pipeline = nullptr;
+        VkResult res = vkCreateGraphicsPipelines(m_driver,
+                                                 m_pipeline_cache,
+                                                 1,
+                                                 &graphics_pipeline_ci,
+                                                 nullptr,
+                                                 &pipeline);
+        if (res != VK_SUCCESS) {
+            console_log_error("vk_pipeline_library: linking failed ({})",
+                              static_cast<int>(res));
+            return nullptr;
+        }
+
+        return pipeline;
+    }
+
+    std::vector<VkPipeline> vk_pipeline_library::evict(
+      std::span<const VkShaderModule> p_modules) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<VkPipeline> evicted;
+        for (auto& parts : m_parts) {
+            for (auto it = parts.begin(); it != parts.end();) {
+                if (!it->first.uses_any(p_modules)) {
+                    ++it;
+                    continue;
+                }
+                evicted.push_back(it->second);
+                it = parts.erase(it);
+            }
+        }
+        return evicted;
+    }
+
+    size_t vk_pipeline_library::parts() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t count = 0;
+        for (const auto& parts : m_parts) {
+            count += parts.size();
+        }
+        return count;
+    }
+
+    void vk_pipeline_library::destroy() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& parts : m_parts) {
+            for (auto& [key, part] : parts) {
+                vkDestroyPipeline(m_driver, part, nullptr);
+            }
+            parts.clear();
+        }
+    }
+};
@@ -0,0 +1,460 @@
+#include <vulkan-cpp/vk_pipeline_registry.hpp>
+#include <vulkan-cpp/vk_swapchain.hpp>
+#include <vulkan-cpp/helper_functions.hpp>
+#include <vulkan-cpp/logger.hpp>
+#include <algorithm>
+#include <optional>
+
+namespace vk {
+
+    static VkPipelineCache create_pipeline_cache(VkDevice p_driver) {
+        VkPipelineCache pipeline_cache = nullptr;
+        VkPipelineCacheCreateInfo pipeline_cache_ci = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0,
+            .initialDataSize = 0,
+            .pInitialData = nullptr
+        };
+
+        vk_check(vkCreatePipelineCache(
+                   p_driver, &pipeline_cache_ci, nullptr, &pipeline_cache),
+                 "vkCreatePipelineCache",
+                 __FUNCTION__);
+        return pipeline_cache;
+    }
+
+    static logger::scope<vk_pipeline_library> create_pipeline_library(
+      VkPipelineCache p_pipeline_cache) {
+        if (!vk_driver::driver_context()
+               .enabled_features()
+               .GraphicsPipelineLibrary) {
+            return nullptr;
+        }
+        return logger::create_scope<vk_pipeline_library>(p_pipeline_cache);
+    }
+
+    // the compiler's workers share the cache and the library, so both have
+    // to exist first
+    vk_pipeline_registry::vk_pipeline_registry(uint32_t p_compile_threads,
+                                               bool p_optimized_relink)
+      : m_driver(vk_driver::driver_context())
+      , m_pipeline_cache(create_pipeline_cache(m_driver))
+      , m_optimized_relink(p_optimized_relink)
+      , m_library(create_pipeline_library(m_pipeline_cache))
+      , m_compiler(m_pipeline_cache, p_compile_threads, m_library.get()) {}
+
+    vk_pipeline& vk_pipeline_registry::get(
+      const pipeline_description& p_description) {
+        // dynamic state is set per draw, so it is not part of the key
+        vk_pipeline& pipeline = p_description.DynamicState
+                                  ? get_canonical(p_description.canonical())
+                                  : get_canonical(p_description);
+        m_uses[&pipeline].References++;
+        return pipeline;
+    }
+
+    void vk_pipeline_registry::release(const vk_pipeline& p_pipeline) {
+        auto use = m_uses.find(&p_pipeline);
+        if (use == m_uses.end() or use->second.References == 0) {
+            console_log_warn("vk_pipeline_registry: released a pipeline that "
+                             "was not referenced");
+            return;
+        }
+        use->second.References--;
+    }
+
+    vk_pipeline& vk_pipeline_registry::get_canonical(
+      const pipeline_description& p_description) {
+        auto it = m_pipelines.find(p_description);
+        if (it != m_pipelines.end()) {
+            m_hits++;
+            return it->second;
+        }
+
+        m_misses++;
+        if (m_library != nullptr) {
+            vk_pipeline* linked = link_canonical(p_description);
+            if (linked != nullptr) {
+                return *linked;
+            }
+        }
+
+        console_log_trace("vk_pipeline_registry: compiling variant {}",
+                          m_pipelines.size());
+
+        auto [created, inserted] = m_pipelines.emplace(
+          p_description, vk_pipeline(p_description, m_pipeline_cache));
+        return created->second;
+    }
+
+    vk_pipeline* vk_pipeline_registry::request(
+      const pipeline_description& p_description) {
+        vk_pipeline* pipeline =
+          p_description.DynamicState
+            ? request_canonical(p_description.canonical())
+            : request_canonical(p_description);
+        if (pipeline != nullptr) {
+            m_uses[pipeline].LastRequested = m_frame;
+        }
+        return pipeline;
+    }
+
+    vk_pipeline* vk_pipeline_registry::request_canonical(
+      const pipeline_description& p_description) {
+        auto it = m_pipelines.find(p_description);
+        if (it != m_pipelines.end()) {
+            m_hits++;
+            return &it->second;
+        }
+
+        if (m_pending.contains(p_description) or
+            m_failed.contains(p_description)) {
+            return nullptr;
+        }
+
+        m_misses++;
+
+        // a link is cheap enough to do right here
+        if (m_library != nullptr) {
+            vk_pipeline* linked = link_canonical(p_description);
+            if (linked == nullptr) {
+                m_failed.insert(p_description);
+            }
+            return linked;
+        }
+
+        m_pending.insert(p_description);
+        m_compiler.submit(p_description);
+        return nullptr;
+    }
+
+    vk_pipeline* vk_pipeline_registry::link_canonical(
+      const pipeline_description& p_description) {
+        VkPipeline pipeline = m_library->link(p_description);
+        if (pipeline == nullptr) {
+            return nullptr;
+        }
+
+        console_log_trace("vk_pipeline_registry: linked variant {}",
+                          m_pipelines.size());
+
+        if (m_optimized_relink) {
+            m_pending.insert(p_description);
+            m_compiler.submit(p_description);
+        }
+
+        auto [created, inserted] = m_pipelines.emplace(
+          p_description, vk_pipeline(p_description.Layout, pipeline));
+        return &created->second;
+    }
+
+    vk_pipeline& vk_pipeline_registry::request(
+      const pipeline_description& p_description,
+      vk_pipeline& p_fallback) {
+        vk_pipeline* pipeline = request(p_description);
+        return pipeline != nullptr ? *pipeline : p_fallback;
+    }
+
+    //! @note Copy of p_description with its shader modules replaced as
+    //! p_remap says, or nothing if it uses none of them
+    static std::optional<pipeline_description> remap_description(
+      const pipeline_description& p_description,
+      const shader_module_remap& p_remap) {
+        auto vertex = p_remap.find(p_description.VertexModule);
+        auto fragment = p_remap.find(p_description.FragmentModule);
+        if (vertex == p_remap.end() and fragment == p_remap.end()) {
+            return std::nullopt;
+        }
+
+        pipeline_description remapped = p_description;
+        if (vertex != p_remap.end()) {
+            remapped.VertexModule = vertex->second;
+        }
+        if (fragment != p_remap.end()) {
+            remapped.FragmentModule = fragment->second;
+        }
+        return remapped;
+    }
+
+    void vk_pipeline_registry::rebuild(const shader_module_remap& p_remap) {
+        // rebuilds still compiling target the old modules' replacements,
+        // which may have been replaced again
+        std::vector<std::pair<pipeline_description, pipeline_description>>
+          rebuilds;
+        for (auto it = m_rebuilds.begin(); it != m_rebuilds.end();) {
+            std::optional<pipeline_description> remapped =
+              remap_description(it->first, p_remap);
+            if (!remapped) {
+                ++it;
+                continue;
+            }
+
+            m_superseded.insert(it->first);
+            rebuilds.emplace_back(std::move(*remapped), std::move(it->second));
+            it = m_rebuilds.erase(it);
+        }
+
+        // pipelines with a rebuild still pending were remapped above
+        std::unordered_set<pipeline_description, pipeline_description_hash>
+          targets;
+        for (const auto& [description, replaced] : m_rebuilds) {
+            targets.insert(replaced);
+        }
+        for (const auto& [description, replaced] : rebuilds) {
+            targets.insert(replaced);
+        }
+
+        for (auto& [description, pipeline] : m_pipelines) {
+            if (targets.contains(description)) {
+                continue;
+            }
+            std::optional<pipeline_description> remapped =
+              remap_description(description, p_remap);
+            if (remapped) {
+                rebuilds.emplace_back(std::move(*remapped), description);
+            }
+        }
+
+        for (auto& [description, replaced] : rebuilds) {
+            m_superseded.erase(description);
+            m_pending.insert(description);
+            m_compiler.submit(description);
+            m_rebuilds[std::move(description)] = std::move(replaced);
+        }
+
+        console_log_info("vk_pipeline_registry: rebuilding {} pipelines",
+                         rebuilds.size());
+    }
+
+    void vk_pipeline_registry::evict(
+      std::span<const VkShaderModule> p_modules) {
+        if (p_modules.empty()) {
+            return;
+        }
+
+        // vk_shader keeps the modules of used_modules(), referenced
+        // pipelines only end up here if it was not asked to
+        auto evicted = [this, p_modules](const pipeline_description& p_key,
+                                         const vk_pipeline& p_pipeline) {
+            if (!p_key.uses_any(p_modules)) {
+                return false;
+            }
+            auto use = m_uses.find(&p_pipeline);
+            if (use != m_uses.end() and use->second.References > 0) {
+                console_log_warn("vk_pipeline_registry: not evicting a "
+                                 "referenced pipeline, pass used_modules() "
+                                 "to vk_shader::evict_unused()");
+                return false;
+            }
+            return true;
+        };
+
+        // rebuilds of evicted pipelines, or onto evicted modules, have
+        // nothing left to replace
+        for (auto it = m_rebuilds.begin(); it != m_rebuilds.end();) {
+            auto replaced = m_pipelines.find(it->second);
+            if (!it->first.uses_any(p_modules) and
+                (replaced == m_pipelines.end() or
+                 !evicted(replaced->first, replaced->second))) {
+                ++it;
+                continue;
+            }
+            m_superseded.insert(it->first);
+            it = m_rebuilds.erase(it);
+        }
+
+        // requests and optimized relinks still compiling
+        for (const pipeline_description& description : m_pending) {
+            if (description.uses_any(p_modules)) {
+                m_superseded.insert(description);
+            }
+        }
+
+        // retired, command buffers in flight may still bind them
+        size_t evicted_count = 0;
+        for (auto it = m_pipelines.begin(); it != m_pipelines.end();) {
+            if (!evicted(it->first, it->second)) {
+                ++it;
+                continue;
+            }
+            m_retired.push_back({ .Pipeline = it->second, .Frame = m_frame });
+            m_uses.erase(&it->second);
+            it = m_pipelines.erase(it);
+            evicted_count++;
+        }
+
+        std::erase_if(m_failed,
+                      [p_modules](const pipeline_description& p_description) {
+                          return p_description.uses_any(p_modules);
+                      });
+
+        if (m_library != nullptr) {
+            std::vector<VkPipeline> parts = m_library->evict(p_modules);
+            m_evicted_parts.insert(
+              m_evicted_parts.end(), parts.begin(), parts.end());
+        }
+
+        console_log_trace("vk_pipeline_registry: evicted {} pipelines",
+                          evicted_count);
+    }
+
+    std::vector<VkShaderModule> vk_pipeline_registry::used_modules() const {
+        std::vector<VkShaderModule> modules;
+        for (const auto& [description, pipeline] : m_pipelines) {
+            auto use = m_uses.find(&pipeline);
+            if (use == m_uses.end()) {
+                continue;
+            }
+
+            // update() already ran for the frame the request was made in
+            if (use->second.References == 0 and
+                m_frame - use->second.LastRequested > 1) {
+                continue;
+            }
+            modules.push_back(description.VertexModule);
+            modules.push_back(description.FragmentModule);
+        }
+        return modules;
+    }
+
+    bool vk_pipeline_registry::update() {
+        bool replaced = false;
+        m_frame++;
+
+        auto expired = std::partition(
+          m_retired.begin(),
+          m_retired.end(),
+          [this](const retired_pipeline& p_retired) {
+              return m_frame - p_retired.Frame <
+                     swapchain_configs::MaxFramesInFlight;
+          });
+
+        for (auto it = expired; it != m_retired.end(); ++it) {
+            it->Pipeline.destroy();
+        }
+        m_retired.erase(expired, m_retired.end());
+
+        if (!m_evicted_parts.empty() and m_compiler.pending() == 0) {
+            for (VkPipeline part : m_evicted_parts) {
+                vkDestroyPipeline(m_driver, part, nullptr);
+            }
+            m_evicted_parts.clear();
+        }
+
+        for (compiled_pipeline& compiled : m_compiler.collect()) {
+            m_pending.erase(compiled.Description);
+
+            if (m_superseded.erase(compiled.Description) > 0) {
+                vkDestroyPipeline(m_driver, compiled.Pipeline, nullptr);
+                continue;
+            }
+
+            auto rebuild = m_rebuilds.find(compiled.Description);
+            if (rebuild != m_rebuilds.end()) {
+                auto node = m_pipelines.find(rebuild->second);
+                m_rebuilds.erase(rebuild);
+
+                if (node == m_pipelines.end()) {
+                    vkDestroyPipeline(m_driver, compiled.Pipeline, nullptr);
+                    continue;
+                }
+
+                // keeps the old pipeline, ie when the new shader does not
+                // match the pipeline layout anymore
+                if (compiled.Pipeline == nullptr) {
+                    console_log_error("vk_pipeline_registry: rebuilding a "
+                                      "pipeline failed, keeping the old one");
+                    continue;
+                }
+
+                // the vk_pipeline keeps its address, so references handed
+                // out earlier now bind the new pipeline
+                m_retired.push_back(
+                  { .Pipeline = node->second, .Frame = m_frame });
+                node->second = vk_pipeline(compiled.Description.Layout,
+                                           compiled.Pipeline);
+                replaced = true;
+
+                // re-keyed in place. If get() already compiled the new
+                // description, both nodes are handed out and stay, this one
+                // under its old key
+                if (!m_pipelines.contains(compiled.Description)) {
+                    auto handle = m_pipelines.extract(node);
+                    handle.key() = std::move(compiled.Description);
+                    m_pipelines.insert(std::move(handle));
+                }
+                continue;
+            }
+
+            auto it = m_pipelines.find(compiled.Description);
+
+            // a failed optimized relink keeps the fast-linked pipeline
+            if (compiled.Pipeline == nullptr) {
+                if (it == m_pipelines.end()) {
+                    m_failed.insert(std::move(compiled.Description));
+                }
+                continue;
+            }
+
+            // the optimized relink of a fast-linked variant, references
+            // handed out earlier keep working and now bind the new pipeline
+            if (it != m_pipelines.end() and m_library != nullptr) {
+                m_retired.push_back(
+                  { .Pipeline = it->second, .Frame = m_frame });
+                it->second = vk_pipeline(it->first.Layout, compiled.Pipeline);
+                m_optimized++;
+                replaced = true;
+                continue;
+            }
+
+            // get() may have compiled the same variant in the meantime
+            if (it != m_pipelines.end()) {
+                vkDestroyPipeline(m_driver, compiled.Pipeline, nullptr);
+                continue;
+            }
+
+            VkPipelineLayout layout = compiled.Description.Layout;
+            m_pipelines.emplace(std::move(compiled.Description),
+                                vk_pipeline(layout, compiled.Pipeline));
+        }
+
+        return replaced;
+    }
+
+    void vk_pipeline_registry::destroy() {
+        // also destroys background pipelines that were never collected
+        m_compiler.destroy();
+
+        // pipeline layouts belong to whoever built the descriptions
+        for (auto& [description, pipeline] : m_pipelines) {
+            pipeline.destroy();
+        }
+        m_pipelines.clear();
+        m_pending.clear();
+        m_failed.clear();
+        m_rebuilds.clear();
+        m_superseded.clear();
+        m_uses.clear();
+
+        for (retired_pipeline& retired : m_retired) {
+            retired.Pipeline.destroy();
+        }
+        m_retired.clear();
+
+        for (VkPipeline part : m_evicted_parts) {
+            vkDestroyPipeline(m_driver, part, nullptr);
+        }
+        m_evicted_parts.clear();
+
+        // linked pipelines do not need their library parts anymore
+        if (m_library != nullptr) {
+            m_library->destroy();
+        }
+
+        if (m_pipeline_cache != nullptr) {
+            vkDestroyPipelineCache(m_driver, m_pipeline_cache, nullptr);
+        }
+        m_pipeline_cache = nullptr;
+    }
+};
@@ -66,6 +66,29 @@ namespace vk {
         vk_check(res, "vkQueueSubmit", __FUNCTION__);
     }
 
+    void vk_queue::submit_to(const VkCommandBuffer& p_command_buffer,
+                             VkSemaphore p_wait_semaphore,
+                             VkSemaphore p_signal_semaphore,
+                             VkFence p_fence) {
+        VkPipelineStageFlags wait_flags =
+          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        VkSubmitInfo submit_info = {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .pNext = nullptr,
+            .waitSemaphoreCount = 1,
+            .pWaitSemaphores = &p_wait_semaphore,
+            .pWaitDstStageMask = &wait_flags,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &p_command_buffer,
+            .signalSemaphoreCount = 1,
+            .pSignalSemaphores = &p_signal_semaphore
+        };
+
+        vk_check(vkQueueSubmit(m_queue, 1, &submit_info, p_fence),
+                 "vkQueueSubmit",
+                 __FUNCTION__);
+    }
+
     void vk_queue::present(uint32_t p_frame_index) {
         VkPresentInfoKHR present_info = { .sType =
                                             VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
@@ -81,16 +104,36 @@ namespace vk {
                  __FUNCTION__);
     }
 
+    void vk_queue::present(uint32_t p_frame_index,
+                           VkSemaphore p_wait_semaphore) {
+        VkPresentInfoKHR present_info = {
+            .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+            .pNext = nullptr,
+            .waitSemaphoreCount = 1,
+            .pWaitSemaphores = &p_wait_semaphore,
+            .swapchainCount = 1,
+            .pSwapchains = &m_swapchain_handler,
+            .pImageIndices = &p_frame_index
+        };
+        vk_check(vkQueuePresentKHR(m_queue, &present_info),
+                 "vkQueuePresentKHR",
+                 __FUNCTION__);
+    }
+
     void vk_queue::wait_idle() {
         vkQueueWaitIdle(m_queue);
     }
 
     uint32_t vk_queue::read_acquire_image() {
+        return read_acquire_image(m_present_completed_semaphore);
+    }
+
+    uint32_t vk_queue::read_acquire_image(VkSemaphore p_acquired_semaphore) {
         uint32_t image_acquired;
         vk_check(vkAcquireNextImageKHR(m_driver,
                                        m_swapchain_handler,
                                        UINT64_MAX,
-                                       m_present_completed_semaphore,
+                                       p_acquired_semaphore,
                                        nullptr,
                                        &image_acquired),
                  "vkAcquireNextImageKHR",
@@ -1,7 +1,12 @@
 #include <vulkan-cpp/vk_shader.hpp>
+#include <vulkan-cpp/vk_shader_bundle.hpp>
+#include <vulkan-cpp/vk_swapchain.hpp>
 #include <vulkan-cpp/logger.hpp>
 #include <vulkan-cpp/helper_functions.hpp>
 #include <fstream>
+#include <array>
+#include <algorithm>
+#include <future>
 #include <fmt/ranges.h>
 
 namespace vk {
@@ -25,7 +30,7 @@ namespace vk {
     }
 
     static VkShaderModule load_shader_module(const VkDevice& p_driver,
-                                             const std::vector<char>& p_code) {
+                                             std::span<const char> p_code) {
         VkShaderModuleCreateInfo module_ci = {
             .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
             .codeSize = p_code.size(),
@@ -41,6 +46,26 @@ namespace vk {
         return shader_module;
     }
 
+    specialization_constants::specialization_constants(uint32_t p_bits) {
+        // constants a shader does not declare are ignored, so every feature
+        // bit is always passed
+        for (uint32_t i = 0; i < MaxShaderFeatures; i++) {
+            Entries[i] = {
+                .constantID = i,
+                .offset = static_cast<uint32_t>(i * sizeof(VkBool32)),
+                .size = sizeof(VkBool32)
+            };
+            Data[i] = (p_bits >> i) & 1u;
+        }
+    }
+
+    VkSpecializationInfo specialization_constants::get() const {
+        return { .mapEntryCount = static_cast<uint32_t>(Entries.size()),
+                 .pMapEntries = Entries.data(),
+                 .dataSize = sizeof(Data),
+                 .pData = Data.data() };
+    }
+
     vk_shader::vk_shader(const std::string& p_vert_filename,
                          const std::string& p_frag_filename) {
         console_log_info("vk_shader begin loaded shader modules!!!");
@@ -50,20 +75,461 @@ namespace vk {
             console_log_trace("m_driver is in fact valid!!!!");
         }
 
-        std::vector<char> vertex_shader = read_file(p_vert_filename);
-        std::vector<char> fragment_shader = read_file(p_frag_filename);
+        m_vertex_filename = p_vert_filename;
+        m_fragment_filename = p_frag_filename;
+        m_vertex_code = read_file(p_vert_filename);
+        m_fragment_code = read_file(p_frag_filename);
 
         // Then we setup the shader module
-        m_vertex_shader_module = load_shader_module(m_driver, vertex_shader);
+        m_vertex_spirv = m_vertex_code;
+        m_fragment_spirv = m_fragment_code;
+        m_vertex_shader_module = load_shader_module(m_driver, m_vertex_code);
         m_fragment_shader_module =
-          load_shader_module(m_driver, fragment_shader);
+          load_shader_module(m_driver, m_fragment_code);
 
         console_log_info("vk_shader successfully loaded shader modules!!!\n\n");
     }
 
+    vk_shader::vk_shader(const vk_shader_bundle& p_bundle,
+                         std::string_view p_vert_name,
+                         std::string_view p_frag_name) {
+        m_driver = vk_driver::driver_context();
+
+        const shader_bundle_entry* vertex_entry = p_bundle.find(p_vert_name);
+        const shader_bundle_entry* fragment_entry =
+          p_bundle.find(p_frag_name);
+        if (vertex_entry == nullptr or fragment_entry == nullptr) {
+            console_log_error("vk_shader: {} or {} is not in the shader "
+                              "bundle!!!",
+                              p_vert_name,
+                              p_frag_name);
+            return;
+        }
+
+        m_bundle = &p_bundle;
+        m_vertex_filename = p_vert_name;
+        m_fragment_filename = p_frag_name;
+        m_vertex_spirv = p_bundle.code(*vertex_entry);
+        m_fragment_spirv = p_bundle.code(*fragment_entry);
+
+        // vkCreateShaderModule needs no external synchronization, so the
+        // stages are created on separate threads
+        std::future<VkShaderModule> fragment_module =
+          std::async(std::launch::async, [this]() {
+              return load_shader_module(m_driver, m_fragment_spirv);
+          });
+        m_vertex_shader_module = load_shader_module(m_driver, m_vertex_spirv);
+        m_fragment_shader_module = fragment_module.get();
+
+        std::span<const VkVertexInputBindingDescription> bindings =
+          p_bundle.vertex_bindings(*vertex_entry);
+        std::span<const VkVertexInputAttributeDescription> attributes =
+          p_bundle.vertex_attributes(*vertex_entry);
+        m_binding_attribute_descriptions.assign(bindings.begin(),
+                                                bindings.end());
+        m_attribute_descriptions.assign(attributes.begin(), attributes.end());
+
+        console_log_trace("vk_shader: created {} and {} from the shader "
+                          "bundle",
+                          p_vert_name,
+                          p_frag_name);
+    }
+
+    //! @note A binary read while the compiler is still writing it is cut
+    //! short, which the size and magic number catch
+    static bool is_spirv(std::span<const char> p_code) {
+        static constexpr uint32_t SpirvMagic = 0x07230203;
+        if (p_code.size() < 5 * sizeof(uint32_t) or
+            p_code.size() % sizeof(uint32_t) != 0) {
+            return false;
+        }
+        return *reinterpret_cast<const uint32_t*>(p_code.data()) ==
+               SpirvMagic;
+    }
+
+    std::string permutation_filename(const std::string& p_filename,
+                                     uint32_t p_bits) {
+        size_t extension = p_filename.rfind(".spv");
+        if (extension == std::string::npos) {
+            return fmt::format("{}_{:x}", p_filename, p_bits);
+        }
+        return fmt::format(
+          "{}_{:x}.spv", p_filename.substr(0, extension), p_bits);
+    }
+
+    shader_variant vk_shader::variant(shader_variant_key p_key) {
+        uint32_t permutation_bits = p_key & ~m_specialized_features;
+        shader_variant result = {
+            .VertexModule = m_vertex_shader_module,
+            .FragmentModule = m_fragment_shader_module,
+            .SpecializationConstants = p_key & m_specialized_features
+        };
+
+        if (permutation_bits == 0) {
+            return result;
+        }
+
+        auto it = m_permutations.find(permutation_bits);
+        if (it == m_permutations.end()) {
+            std::string vert_filename =
+              permutation_filename(m_vertex_filename, permutation_bits);
+            std::string frag_filename =
+              permutation_filename(m_fragment_filename, permutation_bits);
+
+            permutation loaded;
+            if (m_bundle != nullptr) {
+                const shader_bundle_entry* vertex_entry =
+                  m_bundle->find(vert_filename);
+                const shader_bundle_entry* fragment_entry =
+                  m_bundle->find(frag_filename);
+                if (vertex_entry == nullptr or fragment_entry == nullptr) {
+                    console_log_warn("vk_shader: permutation {} or {} is not "
+                                     "in the shader bundle, using the base "
+                                     "shader",
+                                     vert_filename,
+                                     frag_filename);
+                    return result;
+                }
+                loaded.VertexSpirv = m_bundle->code(*vertex_entry);
+                loaded.FragmentSpirv = m_bundle->code(*fragment_entry);
+            }
+            else {
+                std::ifstream vert_file(vert_filename);
+                std::ifstream frag_file(frag_filename);
+                if (!vert_file.is_open() or !frag_file.is_open()) {
+                    console_log_warn("vk_shader: permutation {} or {} is "
+                                     "missing, using the base shader",
+                                     vert_filename,
+                                     frag_filename);
+                    return result;
+                }
+                loaded.VertexCode = read_file(vert_filename);
+                loaded.FragmentCode = read_file(frag_filename);
+                loaded.VertexSpirv = loaded.VertexCode;
+                loaded.FragmentSpirv = loaded.FragmentCode;
+            }
+
+            console_log_trace("vk_shader: loading permutation {:x}",
+                              permutation_bits);
+            loaded.VertexModule =
+              load_shader_module(m_driver, loaded.VertexSpirv);
+            loaded.FragmentModule =
+              load_shader_module(m_driver, loaded.FragmentSpirv);
+            it = m_permutations.emplace(permutation_bits, std::move(loaded))
+                   .first;
+        }
+
+        it->second.LastUsed = m_frame;
+        result.VertexModule = it->second.VertexModule;
+        result.FragmentModule = it->second.FragmentModule;
+        return result;
+    }
+
+    void vk_shader::begin_frame(bool p_compiles_pending) {
+        m_frame++;
+
+        if (!p_compiles_pending) {
+            for (VkShaderModule module : m_retired_modules) {
+                vkDestroyShaderModule(m_driver, module, nullptr);
+            }
+            m_retired_modules.clear();
+        }
+
+        auto expired = std::partition(
+          m_retired_objects.begin(),
+          m_retired_objects.end(),
+          [this](const retired_object& p_retired) {
+              return m_frame - p_retired.Frame <
+                     swapchain_configs::MaxFramesInFlight;
+          });
+
+        for (auto it = expired; it != m_retired_objects.end(); ++it) {
+            vk_driver::driver_context().shader_object().DestroyShader(
+              m_driver, it->Object, nullptr);
+        }
+        m_retired_objects.erase(expired, m_retired_objects.end());
+    }
+
+    std::vector<VkShaderModule> vk_shader::evict_unused(
+      std::span<const VkShaderModule> p_in_use,
+      uint32_t p_max_unused_frames) {
+        std::vector<VkShaderModule> evicted;
+        for (auto it = m_permutations.begin(); it != m_permutations.end();) {
+            // pipelines bound every frame without asking variant() again
+            if (std::ranges::find(p_in_use, it->second.VertexModule) !=
+                  p_in_use.end() or
+                std::ranges::find(p_in_use, it->second.FragmentModule) !=
+                  p_in_use.end()) {
+                it->second.LastUsed = m_frame;
+            }
+
+            if (m_frame - it->second.LastUsed <= p_max_unused_frames) {
+                ++it;
+                continue;
+            }
+
+            evicted.push_back(it->second.VertexModule);
+            evicted.push_back(it->second.FragmentModule);
+            m_retired_modules.push_back(it->second.VertexModule);
+            m_retired_modules.push_back(it->second.FragmentModule);
+
+            // shader objects of every variant built on this permutation
+            for (auto object = m_shader_objects.begin();
+                 object != m_shader_objects.end();) {
+                if ((object->first & ~m_specialized_features) != it->first) {
+                    ++object;
+                    continue;
+                }
+                m_retired_objects.push_back(
+                  { .Object = object->second.Vertex, .Frame = m_frame });
+                m_retired_objects.push_back(
+                  { .Object = object->second.Fragment, .Frame = m_frame });
+                object = m_shader_objects.erase(object);
+            }
+
+            it = m_permutations.erase(it);
+        }
+
+        if (!evicted.empty()) {
+            console_log_trace("vk_shader: evicted {} permutation modules",
+                              evicted.size());
+        }
+        return evicted;
+    }
+
+    shader_module_remap vk_shader::reload() {
+        shader_module_remap remap;
+
+        std::vector<char> vertex_code = read_file(m_vertex_filename);
+        std::vector<char> fragment_code = read_file(m_fragment_filename);
+        if (!is_spirv(vertex_code) or !is_spirv(fragment_code)) {
+            console_log_error("vk_shader: {} or {} is not valid SPIR-V, "
+                              "keeping the loaded shader!!!",
+                              m_vertex_filename,
+                              m_fragment_filename);
+            return remap;
+        }
+
+        auto replace = [&](VkShaderModule& p_module,
+                           const std::vector<char>& p_code) {
+            VkShaderModule module = load_shader_module(m_driver, p_code);
+            remap[p_module] = module;
+            m_retired_modules.push_back(p_module);
+            p_module = module;
+        };
+
+        replace(m_vertex_shader_module, vertex_code);
+        replace(m_fragment_shader_module, fragment_code);
+        m_vertex_code = std::move(vertex_code);
+        m_fragment_code = std::move(fragment_code);
+        m_vertex_spirv = m_vertex_code;
+        m_fragment_spirv = m_fragment_code;
+
+        for (auto& [bits, loaded] : m_permutations) {
+            std::vector<char> permutation_vertex =
+              read_file(permutation_filename(m_vertex_filename, bits));
+            std::vector<char> permutation_fragment =
+              read_file(permutation_filename(m_fragment_filename, bits));
+            if (!is_spirv(permutation_vertex) or
+                !is_spirv(permutation_fragment)) {
+                continue;
+            }
+
+            replace(loaded.VertexModule, permutation_vertex);
+            replace(loaded.FragmentModule, permutation_fragment);
+            loaded.VertexCode = std::move(permutation_vertex);
+            loaded.FragmentCode = std::move(permutation_fragment);
+            loaded.VertexSpirv = loaded.VertexCode;
+            loaded.FragmentSpirv = loaded.FragmentCode;
+        }
+
+        // every variant that had shader objects gets them recreated from
+        // the new code
+        for (auto& [key, objects] : m_shader_objects) {
+            m_retired_objects.push_back(
+              { .Object = objects.Vertex, .Frame = m_frame });
+            m_retired_objects.push_back(
+              { .Object = objects.Fragment, .Frame = m_frame });
+            objects = create_shader_object_pair(key);
+        }
+
+        console_log_info("vk_shader: reloaded {} and {}",
+                         m_vertex_filename,
+                         m_fragment_filename);
+        return remap;
+    }
+
+    bool vk_shader::create_shader_objects(
+      std::span<const VkDescriptorSetLayout> p_set_layouts,
+      std::span<const VkPushConstantRange> p_push_constants,
+      shader_variant_key p_key) {
+        vk_driver& driver = vk_driver::driver_context();
+        if (!driver.enabled_features().ShaderObject) {
+            console_log_warn("vk_shader: shader objects are not supported by "
+                             "this device, use a vk_pipeline instead");
+            return false;
+        }
+
+        m_object_set_layouts.assign(p_set_layouts.begin(), p_set_layouts.end());
+        m_object_push_constants.assign(p_push_constants.begin(),
+                                       p_push_constants.end());
+        m_shader_objects_enabled = true;
+
+        const shader_object_pair& objects = shader_objects(p_key);
+        return objects.Vertex != nullptr and objects.Fragment != nullptr;
+    }
+
+    const vk_shader::shader_object_pair& vk_shader::shader_objects(
+      shader_variant_key p_key) {
+        auto it = m_shader_objects.find(p_key);
+        if (it == m_shader_objects.end()) {
+            it = m_shader_objects
+                   .emplace(p_key, create_shader_object_pair(p_key))
+                   .first;
+        }
+        return it->second;
+    }
+
+    vk_shader::shader_object_pair vk_shader::create_shader_object_pair(
+      shader_variant_key p_key) {
+        // same code selection as variant(), which also loads the
+        // permutation if this is the first time it is asked for
+        std::span<const char> vertex_code = m_vertex_spirv;
+        std::span<const char> fragment_code = m_fragment_spirv;
+        uint32_t permutation_bits = p_key & ~m_specialized_features;
+        if (permutation_bits != 0) {
+            variant(p_key);
+            auto loaded = m_permutations.find(permutation_bits);
+            if (loaded != m_permutations.end()) {
+                vertex_code = loaded->second.VertexSpirv;
+                fragment_code = loaded->second.FragmentSpirv;
+            }
+        }
+
+        specialization_constants constants(p_key & m_specialized_features);
+        VkSpecializationInfo specialization = constants.get();
+
+        // linked stages let the driver optimize across the stage interface
+        // the same way it would inside a pipeline
+        std::array<VkShaderCreateInfoEXT, 2> shader_cis = {
+            VkShaderCreateInfoEXT{
+              .sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT,
+              .pNext = nullptr,
+              .flags = VK_SHADER_CREATE_LINK_STAGE_BIT_EXT,
+              .stage = VK_SHADER_STAGE_VERTEX_BIT,
+              .nextStage = VK_SHADER_STAGE_FRAGMENT_BIT,
+              .codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT,
+              .codeSize = vertex_code.size(),
+              .pCode = vertex_code.data(),
+              .pName = "main",
+              .setLayoutCount =
+                static_cast<uint32_t>(m_object_set_layouts.size()),
+              .pSetLayouts = m_object_set_layouts.data(),
+              .pushConstantRangeCount =
+                static_cast<uint32_t>(m_object_push_constants.size()),
+              .pPushConstantRanges = m_object_push_constants.data(),
+              .pSpecializationInfo = &specialization },
+            VkShaderCreateInfoEXT{
+              .sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT,
+              .pNext = nullptr,
+              .flags = VK_SHADER_CREATE_LINK_STAGE_BIT_EXT,
+              .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+              .nextStage = 0,
+              .codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT,
+              .codeSize = fragment_code.size(),
+              .pCode = fragment_code.data(),
+              .pName = "main",
+              .setLayoutCount =
+                static_cast<uint32_t>(m_object_set_layouts.size()),
+              .pSetLayouts = m_object_set_layouts.data(),
+              .pushConstantRangeCount =
+                static_cast<uint32_t>(m_object_push_constants.size()),
+              .pPushConstantRanges = m_object_push_constants.data(),
+              .pSpecializationInfo = &specialization }
+        };
+
+        vk_driver& driver = vk_driver::driver_context();
+        std::array<VkShaderEXT, 2> shaders = { nullptr, nullptr };
+        vk_check(driver.shader_object().CreateShaders(
+                   driver,
+                   static_cast<uint32_t>(shader_cis.size()),
+                   shader_cis.data(),
+                   nullptr,
+                   shaders.data()),
+                 "vkCreateShadersEXT",
+                 __FUNCTION__);
+
+        console_log_trace("vk_shader: created shader objects for variant {:x}",
+                          p_key);
+        return { .Vertex = shaders[0], .Fragment = shaders[1] };
+    }
+
+    VkShaderEXT vk_shader::get_vertex_object(shader_variant_key p_key) const {
+        auto it = m_shader_objects.find(p_key);
+        return it != m_shader_objects.end() ? it->second.Vertex : nullptr;
+    }
+
+    VkShaderEXT vk_shader::get_fragment_object(
+      shader_variant_key p_key) const {
+        auto it = m_shader_objects.find(p_key);
+        return it != m_shader_objects.end() ? it->second.Fragment : nullptr;
+    }
+
+    void vk_shader::bind_shader_objects(const VkCommandBuffer& p_command_buffer,
+                                        shader_variant_key p_key) {
+        const shader_object_pair& objects = shader_objects(p_key);
+
+        // stages that are not part of this shader are bound to null, so
+        // whatever another shader left bound there does not run
+        std::array<VkShaderStageFlagBits, 5> stages = {
+            VK_SHADER_STAGE_VERTEX_BIT,
+            VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT,
+            VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT,
+            VK_SHADER_STAGE_GEOMETRY_BIT,
+            VK_SHADER_STAGE_FRAGMENT_BIT
+        };
+        std::array<VkShaderEXT, 5> shaders = {
+            objects.Vertex, nullptr, nullptr, nullptr, objects.Fragment
+        };
+
+        vk_driver::driver_context().shader_object().CmdBindShaders(
+          p_command_buffer,
+          static_cast<uint32_t>(stages.size()),
+          stages.data(),
+          shaders.data());
+    }
+
     void vk_shader::destroy() {
         vkDestroyShaderModule(m_driver, m_vertex_shader_module, nullptr);
         vkDestroyShaderModule(m_driver, m_fragment_shader_module, nullptr);
+
+        for (auto& [bits, loaded] : m_permutations) {
+            vkDestroyShaderModule(m_driver, loaded.VertexModule, nullptr);
+            vkDestroyShaderModule(m_driver, loaded.FragmentModule, nullptr);
+        }
+        m_permutations.clear();
+
+        for (VkShaderModule module : m_retired_modules) {
+            vkDestroyShaderModule(m_driver, module, nullptr);
+        }
+        m_retired_modules.clear();
+
+        if (has_shader_objects()) {
+            const shader_object_dispatch& shader_object =
+              vk_driver::driver_context().shader_object();
+            for (auto& [key, objects] : m_shader_objects) {
+                shader_object.DestroyShader(m_driver, objects.Vertex, nullptr);
+                shader_object.DestroyShader(
+                  m_driver, objects.Fragment, nullptr);
+            }
+        }
+        m_shader_objects.clear();
+
+        for (const retired_object& retired : m_retired_objects) {
+            vk_driver::driver_context().shader_object().DestroyShader(
+              m_driver, retired.Object, nullptr);
+        }
+        m_retired_objects.clear();
     }
 
     void vk_shader::load_from_file(const std::string& p_filename) {}
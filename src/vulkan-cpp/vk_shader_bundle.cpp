@@ -0,0 +1,337 @@
+#include <vulkan-cpp/vk_shader_bundle.hpp>
+#include <vulkan-cpp/logger.hpp>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vk {
+
+    static uint32_t align_offset(size_t p_offset) {
+        return static_cast<uint32_t>((p_offset + 3) & ~size_t(3));
+    }
+
+    vk_shader_bundle::vk_shader_bundle(const std::string& p_filename) {
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(p_filename.c_str(),
+                                  GENERIC_READ,
+                                  FILE_SHARE_READ,
+                                  nullptr,
+                                  OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL,
+                                  nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            console_log_error("vk_shader_bundle: could not open {}!!!",
+                              p_filename);
+            return;
+        }
+
+        LARGE_INTEGER file_size{};
+        GetFileSizeEx(file, &file_size);
+        HANDLE mapping =
+          CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) {
+            console_log_error("vk_shader_bundle: could not map {}!!!",
+                              p_filename);
+            CloseHandle(file);
+            return;
+        }
+
+        m_file = file;
+        m_mapping = mapping;
+        m_size = static_cast<size_t>(file_size.QuadPart);
+        m_data = static_cast<const char*>(
+          MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+        int file = open(p_filename.c_str(), O_RDONLY);
+        if (file < 0) {
+            console_log_error("vk_shader_bundle: could not open {}!!!",
+                              p_filename);
+            return;
+        }
+
+        struct stat file_stat{};
+        fstat(file, &file_stat);
+        m_size = static_cast<size_t>(file_stat.st_size);
+
+        // the mapping stays valid after the descriptor is closed
+        void* data = m_size > 0
+                       ? mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0)
+                       : MAP_FAILED;
+        close(file);
+        if (data == MAP_FAILED) {
+            console_log_error("vk_shader_bundle: could not map {}!!!",
+                              p_filename);
+            m_size = 0;
+            return;
+        }
+
+        // every stage gets read at startup, so fault the pages in up front
+        madvise(data, m_size, MADV_WILLNEED);
+        m_data = static_cast<const char*>(data);
+#endif
+
+        if (!validate()) {
+            console_log_error("vk_shader_bundle: {} is not a valid shader "
+                              "bundle!!!",
+                              p_filename);
+            destroy();
+            return;
+        }
+
+        console_log_trace("vk_shader_bundle: mapped {} with {} shaders",
+                          p_filename,
+                          m_entries.size());
+    }
+
+    bool vk_shader_bundle::validate() {
+        if (m_data == nullptr or m_size < sizeof(shader_bundle_header)) {
+            return false;
+        }
+
+        shader_bundle_header header{};
+        std::memcpy(&header, m_data, sizeof(header));
+        if (header.Magic != shader_bundle_header::BundleMagic or
+            header.Version != shader_bundle_header::BundleVersion) {
+            return false;
+        }
+
+        size_t entries_end = sizeof(shader_bundle_header) +
+                             size_t(header.EntryCount) *
+                               sizeof(shader_bundle_entry);
+        if (entries_end > m_size) {
+            return false;
+        }
+
+        auto in_bounds = [this](size_t p_offset, size_t p_size) {
+            return p_offset % 4 == 0 and p_offset <= m_size and
+                   p_size <= m_size - p_offset;
+        };
+
+        const shader_bundle_entry* entries =
+          reinterpret_cast<const shader_bundle_entry*>(
+            m_data + sizeof(shader_bundle_header));
+        for (uint32_t i = 0; i < header.EntryCount; i++) {
+            const shader_bundle_entry& entry = entries[i];
+            if (!in_bounds(entry.CodeOffset, entry.CodeSize) or
+                !in_bounds(entry.BindingOffset,
+                           size_t(entry.BindingCount) *
+                             sizeof(VkVertexInputBindingDescription)) or
+                !in_bounds(entry.AttributeOffset,
+                           size_t(entry.AttributeCount) *
+                             sizeof(VkVertexInputAttributeDescription))) {
+                return false;
+            }
+            // vkCreateShaderModule reads the code as uint32_t words
+            if (entry.CodeSize % sizeof(uint32_t) != 0) {
+                return false;
+            }
+            if (i > 0 and entries[i - 1].NameHash >= entry.NameHash) {
+                return false;
+            }
+        }
+
+        m_entries = { entries, header.EntryCount };
+        return true;
+    }
+
+    const shader_bundle_entry* vk_shader_bundle::find(
+      std::string_view p_name) const {
+        uint64_t hash = shader_bundle_hash(p_name);
+        auto it = std::lower_bound(
+          m_entries.begin(),
+          m_entries.end(),
+          hash,
+          [](const shader_bundle_entry& p_entry, uint64_t p_hash) {
+              return p_entry.NameHash < p_hash;
+          });
+
+        if (it == m_entries.end() or it->NameHash != hash) {
+            return nullptr;
+        }
+        return &*it;
+    }
+
+    std::span<const char> vk_shader_bundle::code(
+      const shader_bundle_entry& p_entry) const {
+        return { m_data + p_entry.CodeOffset, p_entry.CodeSize };
+    }
+
+    std::span<const VkVertexInputBindingDescription>
+    vk_shader_bundle::vertex_bindings(
+      const shader_bundle_entry& p_entry) const {
+        return { reinterpret_cast<const VkVertexInputBindingDescription*>(
+                   m_data + p_entry.BindingOffset),
+                 p_entry.BindingCount };
+    }
+
+    std::span<const VkVertexInputAttributeDescription>
+    vk_shader_bundle::vertex_attributes(
+      const shader_bundle_entry& p_entry) const {
+        return { reinterpret_cast<const VkVertexInputAttributeDescription*>(
+                   m_data + p_entry.AttributeOffset),
+                 p_entry.AttributeCount };
+    }
+
+    bool vk_shader_bundle::write(
+      const std::string& p_filename,
+      std::span<const shader_bundle_source> p_sources) {
+        struct packed_source {
+            const shader_bundle_source* Source = nullptr;
+            std::vector<char> Code;
+            shader_bundle_entry Entry{};
+        };
+
+        std::vector<packed_source> packed;
+        packed.reserve(p_sources.size());
+        for (const shader_bundle_source& source : p_sources) {
+            std::ifstream ins(source.Filename,
+                              std::ios::ate | std::ios::binary);
+            if (!ins.is_open()) {
+                console_log_error("vk_shader_bundle: could not open {}!!!",
+                                  source.Filename);
+                return false;
+            }
+
+            packed_source& current = packed.emplace_back();
+            current.Source = &source;
+            current.Code.resize(static_cast<size_t>(ins.tellg()));
+            ins.seekg(0);
+            ins.read(current.Code.data(),
+                     static_cast<std::streamsize>(current.Code.size()));
+            current.Entry.NameHash = shader_bundle_hash(source.Name);
+            current.Entry.Stage = source.Stage;
+        }
+
+        std::sort(packed.begin(),
+                  packed.end(),
+                  [](const packed_source& p_lhs, const packed_source& p_rhs) {
+                      return p_lhs.Entry.NameHash < p_rhs.Entry.NameHash;
+                  });
+
+        for (size_t i = 1; i < packed.size(); i++) {
+            if (packed[i - 1].Entry.NameHash == packed[i].Entry.NameHash) {
+                console_log_error("vk_shader_bundle: {} and {} have the same "
+                                  "name hash, rename one of them!!!",
+                                  packed[i - 1].Source->Name,
+                                  packed[i].Source->Name);
+                return false;
+            }
+        }
+
+        // lay out every blob after the entry table
+        size_t offset = sizeof(shader_bundle_header) +
+                        packed.size() * sizeof(shader_bundle_entry);
+        for (packed_source& current : packed) {
+            const shader_bundle_source& source = *current.Source;
+            current.Entry.CodeOffset = align_offset(offset);
+            current.Entry.CodeSize = static_cast<uint32_t>(current.Code.size());
+            offset = current.Entry.CodeOffset + current.Entry.CodeSize;
+
+            current.Entry.BindingOffset = align_offset(offset);
+            current.Entry.BindingCount =
+              static_cast<uint32_t>(source.VertexBindings.size());
+            offset = current.Entry.BindingOffset +
+                     source.VertexBindings.size() *
+                       sizeof(VkVertexInputBindingDescription);
+
+            current.Entry.AttributeOffset = align_offset(offset);
+            current.Entry.AttributeCount =
+              static_cast<uint32_t>(source.VertexAttributes.size());
+            offset = current.Entry.AttributeOffset +
+                     source.VertexAttributes.size() *
+                       sizeof(VkVertexInputAttributeDescription);
+        }
+
+        std::vector<char> bundle(offset, 0);
+        shader_bundle_header header = {
+            .EntryCount = static_cast<uint32_t>(packed.size())
+        };
+        std::memcpy(bundle.data(), &header, sizeof(header));
+
+        char* entries = bundle.data() + sizeof(shader_bundle_header);
+        for (size_t i = 0; i < packed.size(); i++) {
+            const packed_source& current = packed[i];
+            const shader_bundle_source& source = *current.Source;
+            std::memcpy(entries + i * sizeof(shader_bundle_entry),
+                        &current.Entry,
+                        sizeof(shader_bundle_entry));
+            std::memcpy(bundle.data() + current.Entry.CodeOffset,
+                        current.Code.data(),
+                        current.Code.size());
+            std::memcpy(bundle.data() + current.Entry.BindingOffset,
+                        source.VertexBindings.data(),
+                        source.VertexBindings.size() *
+                          sizeof(VkVertexInputBindingDescription));
+            std::memcpy(bundle.data() + current.Entry.AttributeOffset,
+                        source.VertexAttributes.data(),
+                        source.VertexAttributes.size() *
+                          sizeof(VkVertexInputAttributeDescription));
+        }
+
+        std::ofstream outs(p_filename, std::ios::binary | std::ios::trunc);
+        if (!outs.is_open()) {
+            console_log_error("vk_shader_bundle: could not write {}!!!",
+                              p_filename);
+            return false;
+        }
+        outs.write(bundle.data(), static_cast<std::streamsize>(bundle.size()));
+
+        console_log_info("vk_shader_bundle: packed {} shaders into {} ({} "
+                         "bytes)",
+                         packed.size(),
+                         p_filename,
+                         bundle.size());
+        return outs.good();
+    }
+
+    bool vk_shader_bundle::is_up_to_date(
+      const std::string& p_filename,
+      std::span<const shader_bundle_source> p_sources) {
+        std::error_code error;
+        auto bundle_time = std::filesystem::last_write_time(p_filename, error);
+        if (error) {
+            return false;
+        }
+
+        for (const shader_bundle_source& source : p_sources) {
+            auto source_time =
+              std::filesystem::last_write_time(source.Filename, error);
+            if (error or source_time > bundle_time) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void vk_shader_bundle::destroy() {
+#if defined(_WIN32)
+        if (m_data != nullptr) {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping != nullptr) {
+            CloseHandle(m_mapping);
+        }
+        if (m_file != nullptr) {
+            CloseHandle(m_file);
+        }
+        m_mapping = nullptr;
+        m_file = nullptr;
+#else
+        if (m_data != nullptr) {
+            munmap(const_cast<char*>(m_data), m_size);
+        }
+#endif
+        m_data = nullptr;
+        m_size = 0;
+        m_entries = {};
+    }
+};
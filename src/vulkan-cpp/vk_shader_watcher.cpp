@@ -0,0 +1,252 @@
+#include <vulkan-cpp/vk_shader_watcher.hpp>
+#include <vulkan-cpp/logger.hpp>
+#include <cstdlib>
+#include <filesystem>
+#include <optional>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace vk {
+
+    //! @note Watched paths and paths built from inotify events have to
+    //! compare equal, so both go through here
+    static std::string normalize_path(const std::string& p_path) {
+        return std::filesystem::path(p_path).lexically_normal().string();
+    }
+
+    struct permutation_binary {
+        std::string Base;
+        uint32_t Features = 0;
+    };
+
+    //! @note shaders/frag_2.spv -> shaders/frag.spv with features 0x2, the
+    //! reverse of permutation_filename()
+    static std::optional<permutation_binary> parse_permutation(
+      const std::string& p_file) {
+        std::filesystem::path path(p_file);
+        if (path.extension() != ".spv") {
+            return std::nullopt;
+        }
+
+        std::string stem = path.stem().string();
+        size_t separator = stem.rfind('_');
+        if (separator == std::string::npos or separator + 1 == stem.size() or
+            stem.size() - separator - 1 > 8) {
+            return std::nullopt;
+        }
+
+        std::string bits = stem.substr(separator + 1);
+        if (bits.find_first_not_of("0123456789abcdef") != std::string::npos) {
+            return std::nullopt;
+        }
+
+        path.replace_filename(stem.substr(0, separator) + ".spv");
+        return permutation_binary{ .Base = normalize_path(path.string()),
+                                   .Features = static_cast<uint32_t>(
+                                     std::stoul(bits, nullptr, 16)) };
+    }
+
+    vk_shader_watcher::vk_shader_watcher(const std::string& p_compiler)
+      : m_compiler(p_compiler) {
+#if defined(__linux__)
+        m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_inotify < 0) {
+            console_log_error("vk_shader_watcher: inotify_init1 failed!!!");
+            return;
+        }
+
+        m_thread = std::thread([this]() { watcher_loop(); });
+#else
+        console_log_warn("vk_shader_watcher: shader hot reload is only "
+                         "supported on Linux");
+#endif
+    }
+
+    void vk_shader_watcher::watch_source(const std::string& p_source,
+                                         const std::string& p_binary) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_sources[normalize_path(p_source)] = normalize_path(p_binary);
+        m_binaries.insert(normalize_path(p_binary));
+        watch_directory(p_source);
+        watch_directory(p_binary);
+    }
+
+    void vk_shader_watcher::watch(const vk_shader& p_shader) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const std::string& binary :
+             { p_shader.vertex_filename(), p_shader.fragment_filename() }) {
+            m_binaries.insert(normalize_path(binary));
+            watch_directory(binary);
+        }
+    }
+
+    void vk_shader_watcher::watch_directory(const std::string& p_file) {
+#if defined(__linux__)
+        if (m_inotify < 0) {
+            return;
+        }
+
+        std::string directory =
+          std::filesystem::path(normalize_path(p_file)).parent_path().string();
+        if (directory.empty()) {
+            directory = ".";
+        }
+
+        // editors usually save by writing a temporary and renaming it over
+        // the file, so the directory is watched rather than the file itself
+        int watch = inotify_add_watch(
+          m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (watch < 0) {
+            console_log_error("vk_shader_watcher: cannot watch {}!!!",
+                              directory);
+            return;
+        }
+        m_directories[watch] = directory;
+#endif
+    }
+
+    void vk_shader_watcher::watcher_loop() {
+#if defined(__linux__)
+        alignas(inotify_event) char buffer[4096];
+        pollfd poll_fd = { .fd = m_inotify, .events = POLLIN, .revents = 0 };
+
+        while (!m_stop) {
+            // wakes up regularly so destroy() never waits long
+            if (poll(&poll_fd, 1, 100) <= 0) {
+                continue;
+            }
+
+            ssize_t length = read(m_inotify, buffer, sizeof(buffer));
+            for (ssize_t offset = 0; offset < length;) {
+                const inotify_event* event =
+                  reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += sizeof(inotify_event) + event->len;
+
+                if (event->len == 0) {
+                    continue;
+                }
+
+                std::string file;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    auto it = m_directories.find(event->wd);
+                    if (it == m_directories.end()) {
+                        continue;
+                    }
+                    file = normalize_path(it->second + "/" + event->name);
+                }
+                on_file_written(file);
+            }
+        }
+#endif
+    }
+
+    void vk_shader_watcher::on_file_written(const std::string& p_file) {
+        std::string binary;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::optional<permutation_binary> permutation =
+              parse_permutation(p_file);
+            if (m_binaries.contains(p_file) or
+                (permutation and m_binaries.contains(permutation->Base))) {
+                m_changed.insert(p_file);
+                return;
+            }
+
+            auto it = m_sources.find(p_file);
+            if (it == m_sources.end()) {
+                return;
+            }
+            binary = it->second;
+        }
+
+        // writing the binaries raises their own events, which is what
+        // reports them
+        compile(p_file, binary);
+
+        // every permutation built next to the binary so far, the files
+        // say which defines they were compiled with
+        std::filesystem::path directory =
+          std::filesystem::path(binary).parent_path();
+        if (directory.empty()) {
+            directory = ".";
+        }
+
+        std::error_code error;
+        for (const auto& entry :
+             std::filesystem::directory_iterator(directory, error)) {
+            std::string file = normalize_path(entry.path().string());
+            std::optional<permutation_binary> permutation =
+              parse_permutation(file);
+            if (permutation and permutation->Base == binary) {
+                compile(p_file, file, permutation->Features);
+            }
+        }
+    }
+
+    void vk_shader_watcher::compile(const std::string& p_source,
+                                    const std::string& p_binary,
+                                    uint32_t p_features) {
+        std::string defines;
+        for (uint32_t i = 0; i < ShaderFeatureNames.size(); i++) {
+            if (p_features & (1u << i)) {
+                defines += fmt::format(" -D{}=true", ShaderFeatureNames[i]);
+            }
+        }
+
+        console_log_info("vk_shader_watcher: recompiling {} into {}",
+                         p_source,
+                         p_binary);
+        std::string command = fmt::format("{}{} \"{}\" -o \"{}\"",
+                                          m_compiler,
+                                          defines,
+                                          p_source,
+                                          p_binary);
+        if (std::system(command.c_str()) != 0) {
+            console_log_error("vk_shader_watcher: compiling {} failed, "
+                              "keeping the previous {}",
+                              p_source,
+                              p_binary);
+        }
+    }
+
+    std::vector<std::string> vk_shader_watcher::changed() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<std::string> changed(m_changed.begin(), m_changed.end());
+        m_changed.clear();
+        return changed;
+    }
+
+    bool vk_shader_watcher::is_changed(
+      const std::vector<std::string>& p_changed,
+      const vk_shader& p_shader) {
+        std::string vertex = normalize_path(p_shader.vertex_filename());
+        std::string fragment = normalize_path(p_shader.fragment_filename());
+        for (const std::string& file : p_changed) {
+            std::optional<permutation_binary> permutation =
+              parse_permutation(file);
+            const std::string& base = permutation ? permutation->Base : file;
+            if (base == vertex or base == fragment) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void vk_shader_watcher::destroy() {
+        m_stop = true;
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+
+#if defined(__linux__)
+        if (m_inotify >= 0) {
+            close(m_inotify);
+        }
+#endif
+        m_inotify = -1;
+    }
+};
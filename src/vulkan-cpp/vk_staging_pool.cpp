@@ -0,0 +1,174 @@
+#include <vulkan-cpp/vk_staging_pool.hpp>
+#include <vulkan-cpp/helper_functions.hpp>
+#include <vulkan-cpp/logger.hpp>
+#include <cassert>
+
+namespace vk {
+    //! @note Staging sizes get rounded up so differently sized textures can
+    //! still reuse each others staging buffers
+    static constexpr uint32_t staging_granularity = 64 * 1024;
+
+    static uint32_t align_staging_size(uint32_t p_size) {
+        return (p_size + staging_granularity - 1) & ~(staging_granularity - 1);
+    }
+
+    vk_staging_pool* vk_staging_pool::s_instance = nullptr;
+
+    vk_staging_pool::vk_staging_pool(uint32_t p_max_retained_bytes)
+      : m_max_retained_bytes(p_max_retained_bytes) {
+        m_driver = vk_driver::driver_context();
+        s_instance = this;
+    }
+
+    vk_staging_pool& vk_staging_pool::pool_context() {
+        if (s_instance == nullptr) {
+            console_log_error("vk_staging_pool: no staging pool exists, "
+                              "create one before uploading!!!");
+        }
+        assert(s_instance != nullptr);
+        return *s_instance;
+    }
+
+    buffer_properties vk_staging_pool::acquire(uint32_t p_size_in_bytes) {
+        reclaim();
+
+        // best-fit search through the staging buffers that are not in-flight
+        auto best = m_free_buffers.end();
+        for (auto it = m_free_buffers.begin(); it != m_free_buffers.end();
+             it++) {
+            if (it->AllocateDeviceSize < p_size_in_bytes) {
+                continue;
+            }
+
+            if (best == m_free_buffers.end() or
+                it->AllocateDeviceSize < best->AllocateDeviceSize) {
+                best = it;
+            }
+        }
+
+        if (best != m_free_buffers.end()) {
+            buffer_properties staging = *best;
+            m_free_buffers.erase(best);
+            m_retained_bytes -= staging.AllocateDeviceSize;
+            return staging;
+        }
+
+        VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        VkMemoryPropertyFlags property = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                         VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+        return create_buffer(
+          align_staging_size(p_size_in_bytes), usage, property);
+    }
+
+    VkFence vk_staging_pool::acquire_fence() {
+        if (!m_free_fences.empty()) {
+            VkFence fence = m_free_fences.back();
+            m_free_fences.pop_back();
+            return fence;
+        }
+
+        VkFenceCreateInfo fence_ci = {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0
+        };
+
+        VkFence fence = nullptr;
+        vk_check(vkCreateFence(m_driver, &fence_ci, nullptr, &fence),
+                 "vkCreateFence",
+                 __FUNCTION__);
+        return fence;
+    }
+
+    void vk_staging_pool::release(const buffer_properties& p_buffer,
+                                  VkFence p_fence) {
+        release(std::span<const buffer_properties>(&p_buffer, 1), p_fence);
+    }
+
+    void vk_staging_pool::release(std::span<const buffer_properties> p_buffers,
+                                  VkFence p_fence) {
+        pending_submission submission = {
+            .Fence = p_fence,
+            .Buffers = std::vector<buffer_properties>(p_buffers.begin(),
+                                                      p_buffers.end())
+        };
+        m_pending.push_back(submission);
+    }
+
+    void vk_staging_pool::release(
+      std::span<const buffer_properties> p_buffers) {
+        for (const buffer_properties& staging : p_buffers) {
+            recycle(staging);
+        }
+    }
+
+    void vk_staging_pool::reclaim() {
+        for (size_t i = 0; i < m_pending.size();) {
+            pending_submission& submission = m_pending[i];
+
+            if (vkGetFenceStatus(m_driver, submission.Fence) != VK_SUCCESS) {
+                i++;
+                continue;
+            }
+
+            for (const buffer_properties& staging : submission.Buffers) {
+                recycle(staging);
+            }
+
+            vk_check(vkResetFences(m_driver, 1, &submission.Fence),
+                     "vkResetFences",
+                     __FUNCTION__);
+            m_free_fences.push_back(submission.Fence);
+
+            m_pending[i] = m_pending.back();
+            m_pending.pop_back();
+        }
+    }
+
+    void vk_staging_pool::recycle(const buffer_properties& p_buffer) {
+        if (m_retained_bytes + p_buffer.AllocateDeviceSize >
+            m_max_retained_bytes) {
+            free_buffer(p_buffer);
+            return;
+        }
+
+        m_retained_bytes += p_buffer.AllocateDeviceSize;
+        m_free_buffers.push_back(p_buffer);
+    }
+
+    void vk_staging_pool::trim() {
+        reclaim();
+
+        for (const buffer_properties& staging : m_free_buffers) {
+            free_buffer(staging);
+        }
+
+        m_free_buffers.clear();
+        m_retained_bytes = 0;
+    }
+
+    void vk_staging_pool::free_buffer(const buffer_properties& p_buffer) {
+        vkDestroyBuffer(m_driver, p_buffer.BufferHandler, nullptr);
+        vkFreeMemory(m_driver, p_buffer.DeviceMemory, nullptr);
+    }
+
+    void vk_staging_pool::destroy() {
+        // staging buffers still in-flight need to finish before we free them
+        for (pending_submission& submission : m_pending) {
+            vkWaitForFences(
+              m_driver, 1, &submission.Fence, true, UINT64_MAX);
+        }
+
+        trim();
+
+        for (VkFence fence : m_free_fences) {
+            vkDestroyFence(m_driver, fence, nullptr);
+        }
+        m_free_fences.clear();
+
+        if (s_instance == this) {
+            s_instance = nullptr;
+        }
+    }
+};
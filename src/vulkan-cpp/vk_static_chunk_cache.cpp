@@ -0,0 +1,208 @@
+#include <vulkan-cpp/vk_static_chunk_cache.hpp>
+#include <vulkan-cpp/vk_driver.hpp>
+#include <vulkan-cpp/vk_swapchain.hpp>
+#include <vulkan-cpp/helper_functions.hpp>
+#include <vulkan-cpp/logger.hpp>
+#include <algorithm>
+
+namespace vk {
+
+    static bool same_inheritance(const secondary_inheritance& p_a,
+                                 const secondary_inheritance& p_b) {
+        return p_a.RenderPass == p_b.RenderPass and
+               p_a.Framebuffer == p_b.Framebuffer and
+               p_a.ColorFormat == p_b.ColorFormat and
+               p_a.DepthFormat == p_b.DepthFormat and
+               p_a.Extent.width == p_b.Extent.width and
+               p_a.Extent.height == p_b.Extent.height and
+               p_a.ShaderObjects == p_b.ShaderObjects;
+    }
+
+    vk_static_chunk_cache::vk_static_chunk_cache(uint32_t p_queue_family,
+                                                 uint32_t p_slot_count) {
+        m_driver = vk_driver::driver_context();
+        m_slot_count = p_slot_count;
+
+        // replaced recordings are reused one at a time, vkBeginCommandBuffer
+        // resets them
+        VkCommandPoolCreateInfo pool_ci = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+            .queueFamilyIndex = p_queue_family
+        };
+
+        vk_check(
+          vkCreateCommandPool(m_driver, &pool_ci, nullptr, &m_command_pool),
+          "vkCreateCommandPool",
+          __FUNCTION__);
+    }
+
+    uint32_t vk_static_chunk_cache::add(
+      const static_chunk_record_function& p_record,
+      size_t p_state) {
+        uint32_t index = static_cast<uint32_t>(m_chunks.size());
+        if (!m_free_chunks.empty()) {
+            index = m_free_chunks.back();
+            m_free_chunks.pop_back();
+        }
+        else {
+            m_chunks.emplace_back();
+        }
+
+        chunk& added = m_chunks[index];
+        added.Record = p_record;
+        added.State = p_state;
+        added.Active = true;
+        added.CommandBuffers.assign(m_slot_count, nullptr);
+        m_size++;
+        return index;
+    }
+
+    void vk_static_chunk_cache::remove(uint32_t p_chunk) {
+        if (p_chunk >= m_chunks.size() or !m_chunks[p_chunk].Active) {
+            return;
+        }
+
+        chunk& removed = m_chunks[p_chunk];
+        retire(removed);
+        removed.Record = nullptr;
+        removed.Active = false;
+        m_free_chunks.push_back(p_chunk);
+        m_size--;
+    }
+
+    void vk_static_chunk_cache::mark_dirty(uint32_t p_chunk) {
+        if (p_chunk < m_chunks.size()) {
+            retire(m_chunks[p_chunk]);
+        }
+    }
+
+    void vk_static_chunk_cache::mark_all_dirty() {
+        for (chunk& dirty : m_chunks) {
+            retire(dirty);
+        }
+    }
+
+    void vk_static_chunk_cache::set_state(uint32_t p_chunk, size_t p_state) {
+        if (p_chunk >= m_chunks.size() or
+            m_chunks[p_chunk].State == p_state) {
+            return;
+        }
+
+        m_chunks[p_chunk].State = p_state;
+        retire(m_chunks[p_chunk]);
+    }
+
+    void vk_static_chunk_cache::execute(
+      const VkCommandBuffer& p_command_buffer,
+      const secondary_inheritance& p_inheritance,
+      uint32_t p_slot) {
+        if (p_slot >= m_slot_count) {
+            console_log_error("vk_static_chunk_cache: slot {} is out of "
+                              "range, only {} slots were created!!!",
+                              p_slot,
+                              m_slot_count);
+            return;
+        }
+
+        m_frame++;
+        m_recorded = 0;
+
+        // the frames that could still execute these have finished by now
+        auto expired = std::partition(
+          m_retired_command_buffers.begin(),
+          m_retired_command_buffers.end(),
+          [this](const retired_command_buffer& p_retired) {
+              return m_frame - p_retired.Frame <
+                     swapchain_configs::MaxFramesInFlight;
+          });
+        for (auto it = expired; it != m_retired_command_buffers.end(); ++it) {
+            m_free_command_buffers.push_back(it->CommandBuffer);
+        }
+        m_retired_command_buffers.erase(expired,
+                                        m_retired_command_buffers.end());
+
+        // without a framebuffer one recording works for every image
+        secondary_inheritance inheritance = p_inheritance;
+        inheritance.Framebuffer = nullptr;
+        if (!same_inheritance(inheritance, m_inheritance)) {
+            mark_all_dirty();
+            m_inheritance = inheritance;
+        }
+
+        m_executed.clear();
+        for (chunk& current : m_chunks) {
+            if (!current.Active) {
+                continue;
+            }
+
+            VkCommandBuffer& command_buffer = current.CommandBuffers[p_slot];
+            if (command_buffer == nullptr) {
+                // frames in flight may execute the same recording at once
+                command_buffer = acquire_command_buffer();
+                begin_secondary(command_buffer,
+                                m_inheritance,
+                                VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT);
+                current.Record(command_buffer, p_slot);
+                vkEndCommandBuffer(command_buffer);
+                m_recorded++;
+            }
+            m_executed.push_back(command_buffer);
+        }
+
+        if (!m_executed.empty()) {
+            vkCmdExecuteCommands(p_command_buffer,
+                                 static_cast<uint32_t>(m_executed.size()),
+                                 m_executed.data());
+        }
+    }
+
+    void vk_static_chunk_cache::retire(chunk& p_chunk) {
+        for (VkCommandBuffer& command_buffer : p_chunk.CommandBuffers) {
+            if (command_buffer != nullptr) {
+                m_retired_command_buffers.push_back(
+                  { .CommandBuffer = command_buffer, .Frame = m_frame });
+                command_buffer = nullptr;
+            }
+        }
+    }
+
+    VkCommandBuffer vk_static_chunk_cache::acquire_command_buffer() {
+        if (!m_free_command_buffers.empty()) {
+            VkCommandBuffer command_buffer = m_free_command_buffers.back();
+            m_free_command_buffers.pop_back();
+            return command_buffer;
+        }
+
+        VkCommandBufferAllocateInfo command_buffer_alloc_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .pNext = nullptr,
+            .commandPool = m_command_pool,
+            .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+            .commandBufferCount = 1
+        };
+
+        VkCommandBuffer command_buffer = nullptr;
+        vk_check(vkAllocateCommandBuffers(
+                   m_driver, &command_buffer_alloc_info, &command_buffer),
+                 "vkAllocateCommandBuffers",
+                 __FUNCTION__);
+        return command_buffer;
+    }
+
+    void vk_static_chunk_cache::destroy() {
+        // destroying the pool frees every recording, cached or retired
+        if (m_command_pool != nullptr) {
+            vkDestroyCommandPool(m_driver, m_command_pool, nullptr);
+        }
+
+        m_command_pool = nullptr;
+        m_chunks.clear();
+        m_free_chunks.clear();
+        m_free_command_buffers.clear();
+        m_retired_command_buffers.clear();
+        m_executed.clear();
+        m_size = 0;
+    }
+};
@@ -1,6 +1,7 @@
 #include <vulkan-cpp/vk_swapchain.hpp>
 #include <vulkan-cpp/helper_functions.hpp>
 #include <vulkan-cpp/logger.hpp>
+#include <vulkan-cpp/vk_texture.hpp>
 #include <array>
 
 namespace vk {
@@ -241,12 +242,103 @@ namespace vk {
 
     vk_swapchain::vk_swapchain(vk_physical_driver& p_physical,
                                const vk_driver& p_driver,
-                               const VkSurfaceKHR& p_surface)
+                               const VkSurfaceKHR& p_surface,
+                               bool p_dynamic_rendering)
       : m_driver(p_driver)
       , m_physical(p_physical)
       , m_current_surface(p_surface) {
         m_surface_data = p_physical.get_surface_properties(p_surface);
+
+        m_dynamic_rendering =
+          p_dynamic_rendering and
+          m_driver.enabled_features().DynamicRendering and
+          m_driver.enabled_features().Synchronization2;
+        if (p_dynamic_rendering and !m_dynamic_rendering) {
+            console_log_warn("vk_swapchain: dynamic rendering is not "
+                             "supported, falling back to a render pass");
+        }
         on_create();
+        create_frames();
+    }
+
+    void vk_swapchain::create_frames() {
+        // command buffers only live for one frame, and are reset together
+        // with their pool instead of one at a time
+        VkCommandPoolCreateInfo pool_ci = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = m_queue_family
+        };
+
+        // signaled, so the first begin_frame() of each slot does not wait
+        VkFenceCreateInfo fence_ci = {
+            .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = VK_FENCE_CREATE_SIGNALED_BIT
+        };
+
+        VkSemaphoreCreateInfo semaphore_ci = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+            .pNext = nullptr,
+            .flags = 0
+        };
+
+        for (frame_context& frame : m_frames) {
+            vk_check(vkCreateCommandPool(
+                       m_driver, &pool_ci, nullptr, &frame.CommandPool),
+                     "vkCreateCommandPool",
+                     __FUNCTION__);
+
+            VkCommandBufferAllocateInfo command_buffer_alloc_info = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .pNext = nullptr,
+                .commandPool = frame.CommandPool,
+                .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                .commandBufferCount = 1
+            };
+            vk_check(vkAllocateCommandBuffers(m_driver,
+                                              &command_buffer_alloc_info,
+                                              &frame.CommandBuffer),
+                     "vkAllocateCommandBuffers",
+                     __FUNCTION__);
+
+            vk_check(vkCreateFence(m_driver, &fence_ci, nullptr, &frame.Fence),
+                     "vkCreateFence",
+                     __FUNCTION__);
+            vk_check(vkCreateSemaphore(
+                       m_driver, &semaphore_ci, nullptr, &frame.ImageAcquired),
+                     "vkCreateSemaphore",
+                     __FUNCTION__);
+        }
+
+        m_render_completed_semaphores.resize(m_swapchain_images.size());
+        for (VkSemaphore& semaphore : m_render_completed_semaphores) {
+            vk_check(
+              vkCreateSemaphore(m_driver, &semaphore_ci, nullptr, &semaphore),
+              "vkCreateSemaphore",
+              __FUNCTION__);
+        }
+    }
+
+    void vk_swapchain::destroy_frames() {
+        for (frame_context& frame : m_frames) {
+            if (frame.Fence == nullptr) {
+                continue;
+            }
+
+            // the pool cannot go away while its command buffer is pending
+            vkWaitForFences(m_driver, 1, &frame.Fence, true, UINT64_MAX);
+            vkDestroyCommandPool(m_driver, frame.CommandPool, nullptr);
+            vkDestroyFence(m_driver, frame.Fence, nullptr);
+            vkDestroySemaphore(m_driver, frame.ImageAcquired, nullptr);
+            frame = {};
+        }
+
+        for (VkSemaphore semaphore : m_render_completed_semaphores) {
+            vkDestroySemaphore(m_driver, semaphore, nullptr);
+        }
+        m_render_completed_semaphores.clear();
     }
 
     void vk_swapchain::on_create() {
@@ -261,6 +353,7 @@ namespace vk {
         uint32_t present_index =
           m_physical.get_presentation_index(m_current_surface);
         console_log_trace("Presentation Index = {}", present_index);
+        m_queue_family = present_index;
         m_present_queue = m_driver.get_presentation_queue(present_index);
 
         VkSwapchainCreateInfoKHR swapchain_ci = {
@@ -338,25 +431,29 @@ namespace vk {
                                 VK_IMAGE_ASPECT_DEPTH_BIT);
         }
 
-        // command buffers
-        console_log_info("vk_swapchain begin initializing command buffers!!!!");
+        // command buffers, only record() and present() use these. With
+        // dynamic rendering every frame goes through the m_frames slots
+        if (!m_dynamic_rendering) {
+            console_log_info(
+              "vk_swapchain begin initializing command buffers!!!!");
 
-        m_swapchain_command_buffers.resize(image_count);
-        console_log_trace("command buffers.size() = {}",
-                          m_swapchain_command_buffers.size());
+            m_swapchain_command_buffers.resize(image_count);
+            console_log_trace("command buffers.size() = {}",
+                              m_swapchain_command_buffers.size());
 
-        for (size_t i = 0; i < m_swapchain_command_buffers.size(); i++) {
-            command_buffer_properties properties = {
-                present_index,
-                command_buffer_levels::Primary,
-                (VkCommandPoolCreateFlagBits)0
-            };
+            for (size_t i = 0; i < m_swapchain_command_buffers.size(); i++) {
+                command_buffer_properties properties = {
+                    present_index,
+                    command_buffer_levels::Primary,
+                    (VkCommandPoolCreateFlagBits)0
+                };
 
-            m_swapchain_command_buffers[i] = vk_command_buffer(properties);
-        }
+                m_swapchain_command_buffers[i] = vk_command_buffer(properties);
+            }
 
-        console_log_info(
-          "vk_swapchain successfully initialized command buffers!!!!\n");
+            console_log_info(
+              "vk_swapchain successfully initialized command buffers!!!!\n");
+        }
 
         // We dont need to specify queue information. This should be provided to
         // by the swapchain The queue is provided within the swapchain during
@@ -364,6 +461,14 @@ namespace vk {
         m_swapchain_queue =
           vk_queue(m_driver, m_swapchain_handler, m_present_queue);
 
+        // with dynamic rendering the attachments are given to
+        // vkCmdBeginRendering directly, there is nothing else to create
+        if (m_dynamic_rendering) {
+            console_log_info("vk_swapchain() successfully initialized with "
+                             "dynamic rendering!!!\n\n");
+            return;
+        }
+
         m_swapchain_renderpass =
           create_simple_renderpass(m_driver, m_surface_data.SurfaceFormat);
 
@@ -402,6 +507,268 @@ namespace vk {
         console_log_info("vk_swapchain() successfully initialized!!!\n\n");
     }
 
+    void vk_swapchain::record_parallel(
+      vk_parallel_recorder& p_recorder,
+      uint32_t p_chunk_count,
+      const secondary_record_function& p_callable) {
+        if (m_swapchain_command_buffers.empty()) {
+            console_log_error("vk_swapchain::record_parallel has no per image "
+                              "command buffers with dynamic rendering, use "
+                              "execute_parallel() instead!!!");
+            return;
+        }
+
+        console_log_info("vk_swapchain::record_parallel Begin recording {} "
+                         "chunks!!!",
+                         p_chunk_count);
+
+        for (uint32_t i = 0; i < m_swapchain_command_buffers.size(); i++) {
+            // the primary is simultaneous use, so its secondaries have to be
+            std::span<const VkCommandBuffer> secondaries =
+              p_recorder.record(i,
+                                inheritance(i),
+                                p_chunk_count,
+                                p_callable,
+                                VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT);
+
+            m_swapchain_command_buffers[i].begin(
+              VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT);
+            begin_pass(m_swapchain_command_buffers[i], i, true);
+
+            if (!secondaries.empty()) {
+                vkCmdExecuteCommands(
+                  m_swapchain_command_buffers[i],
+                  static_cast<uint32_t>(secondaries.size()),
+                  secondaries.data());
+            }
+
+            end_pass(m_swapchain_command_buffers[i], i);
+            m_swapchain_command_buffers[i].end();
+        }
+
+        console_log_info(
+          "vk_swapchain::record_parallel finished recording successfully!!!");
+    }
+
+    VkCommandBuffer vk_swapchain::begin_frame(bool p_secondaries) {
+        frame_context& frame = m_frames[m_frame_index];
+
+        // once the fence signals nothing allocated from the pool is pending
+        vkWaitForFences(m_driver, 1, &frame.Fence, true, UINT64_MAX);
+        vkResetCommandPool(m_driver, frame.CommandPool, 0);
+
+        m_current_image_index =
+          m_swapchain_queue.read_acquire_image(frame.ImageAcquired);
+
+        VkCommandBufferBeginInfo command_buffer_begin_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .pNext = nullptr,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+            .pInheritanceInfo = nullptr
+        };
+        vk_check(
+          vkBeginCommandBuffer(frame.CommandBuffer, &command_buffer_begin_info),
+          "vkBeginCommandBuffer",
+          __FUNCTION__);
+
+        VkViewport viewport = {
+            .x = 0.0f,
+            .y = 0.0f,
+            .width = static_cast<float>(m_swapchain_size.width),
+            .height = static_cast<float>(m_swapchain_size.height),
+            .minDepth = 0.0f,
+            .maxDepth = 1.0f,
+        };
+        vkCmdSetViewport(frame.CommandBuffer, 0, 1, &viewport);
+
+        VkRect2D scissor = { .offset = { 0, 0 }, .extent = m_swapchain_size };
+        vkCmdSetScissor(frame.CommandBuffer, 0, 1, &scissor);
+
+        begin_pass(frame.CommandBuffer, m_current_image_index, p_secondaries);
+        return frame.CommandBuffer;
+    }
+
+    void vk_swapchain::execute_parallel(
+      vk_parallel_recorder& p_recorder,
+      uint32_t p_chunk_count,
+      const secondary_record_function& p_callable) {
+        std::span<const VkCommandBuffer> secondaries =
+          p_recorder.record(m_frame_index,
+                            inheritance(m_current_image_index),
+                            p_chunk_count,
+                            p_callable,
+                            VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+        if (!secondaries.empty()) {
+            vkCmdExecuteCommands(m_frames[m_frame_index].CommandBuffer,
+                                 static_cast<uint32_t>(secondaries.size()),
+                                 secondaries.data());
+        }
+    }
+
+    void vk_swapchain::end_frame() {
+        frame_context& frame = m_frames[m_frame_index];
+
+        end_pass(frame.CommandBuffer, m_current_image_index);
+        vkEndCommandBuffer(frame.CommandBuffer);
+
+        // only reset right before submitting, so an early return can never
+        // leave begin_frame() waiting on a fence nothing will signal
+        vkResetFences(m_driver, 1, &frame.Fence);
+
+        VkSemaphore render_completed =
+          m_render_completed_semaphores[m_current_image_index];
+        m_swapchain_queue.submit_to(frame.CommandBuffer,
+                                    frame.ImageAcquired,
+                                    render_completed,
+                                    frame.Fence);
+        m_swapchain_queue.present(m_current_image_index, render_completed);
+
+        m_frame_index =
+          (m_frame_index + 1) % swapchain_configs::MaxFramesInFlight;
+    }
+
+    secondary_inheritance vk_swapchain::inheritance(uint32_t p_index) const {
+        return { .RenderPass = m_swapchain_renderpass,
+                 .Framebuffer = m_dynamic_rendering
+                                  ? nullptr
+                                  : m_swapchain_framebuffers[p_index],
+                 .ColorFormat = color_format(),
+                 .DepthFormat = depth_format(),
+                 .Extent = m_swapchain_size,
+                 .ShaderObjects = m_dynamic_rendering and m_shader_objects };
+    }
+
+    void vk_swapchain::begin_pass(const VkCommandBuffer& p_command_buffer,
+                                  uint32_t p_index,
+                                  bool p_secondaries) {
+        if (m_dynamic_rendering) {
+            VkRenderingFlags flags = 0;
+            if (p_secondaries) {
+                flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
+            }
+            begin_rendering(p_command_buffer, p_index, flags);
+            return;
+        }
+
+        std::array<VkClearValue, 2> clear_values = {};
+        clear_values[0].color = m_color;
+        clear_values[1].depthStencil = { 1.0f, 0 };
+
+        VkRenderPassBeginInfo renderpass_begin_info = {
+            .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+            .pNext = nullptr,
+            .renderPass = m_swapchain_renderpass,
+            .framebuffer = m_swapchain_framebuffers[p_index],
+            .renderArea = { .offset = { .x = 0, .y = 0 },
+                            .extent = m_swapchain_size },
+            .clearValueCount = static_cast<uint32_t>(clear_values.size()),
+            .pClearValues = clear_values.data()
+        };
+
+        vkCmdBeginRenderPass(p_command_buffer,
+                             &renderpass_begin_info,
+                             p_secondaries
+                               ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+                               : VK_SUBPASS_CONTENTS_INLINE);
+    }
+
+    void vk_swapchain::end_pass(const VkCommandBuffer& p_command_buffer,
+                                uint32_t p_index) {
+        if (m_dynamic_rendering) {
+            end_rendering(p_command_buffer, p_index);
+        }
+        else {
+            vkCmdEndRenderPass(p_command_buffer);
+        }
+    }
+
+    void vk_swapchain::begin_rendering(const VkCommandBuffer& p_command_buffer,
+                                       uint32_t p_index,
+                                       VkRenderingFlags p_flags) {
+        VkFormat depth_format = vk_driver::depth_format();
+
+        // contents from the last time this image was presented are cleared
+        // anyway, so both transitions start from UNDEFINED
+        std::array<VkImageMemoryBarrier2, 2> barriers = {
+            image_memory_barrier2(m_swapchain_images[p_index].Image,
+                                  m_surface_data.SurfaceFormat.format,
+                                  VK_IMAGE_LAYOUT_UNDEFINED,
+                                  VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+            image_memory_barrier2(
+              m_swapchain_depth_images[p_index].Image,
+              depth_format,
+              VK_IMAGE_LAYOUT_UNDEFINED,
+              VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
+        };
+
+        VkDependencyInfo dependency_info = {
+            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .pNext = nullptr,
+            .dependencyFlags = 0,
+            .imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size()),
+            .pImageMemoryBarriers = barriers.data()
+        };
+        vkCmdPipelineBarrier2(p_command_buffer, &dependency_info);
+
+        VkRenderingAttachmentInfo color_attachment = {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+            .pNext = nullptr,
+            .imageView = m_swapchain_images[p_index].ImageView,
+            .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            .resolveMode = VK_RESOLVE_MODE_NONE,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+            .clearValue = { .color = m_color }
+        };
+
+        VkRenderingAttachmentInfo depth_attachment = {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+            .pNext = nullptr,
+            .imageView = m_swapchain_depth_images[p_index].ImageView,
+            .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+            .resolveMode = VK_RESOLVE_MODE_NONE,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .clearValue = { .depthStencil = { 1.0f, 0 } }
+        };
+
+        VkRenderingInfo rendering_info = {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+            .pNext = nullptr,
+            .flags = p_flags,
+            .renderArea = { .offset = { 0, 0 }, .extent = m_swapchain_size },
+            .layerCount = 1,
+            .viewMask = 0,
+            .colorAttachmentCount = 1,
+            .pColorAttachments = &color_attachment,
+            .pDepthAttachment = &depth_attachment,
+            .pStencilAttachment = nullptr
+        };
+
+        vkCmdBeginRendering(p_command_buffer, &rendering_info);
+    }
+
+    void vk_swapchain::end_rendering(const VkCommandBuffer& p_command_buffer,
+                                     uint32_t p_index) {
+        vkCmdEndRendering(p_command_buffer);
+
+        VkImageMemoryBarrier2 present_barrier =
+          image_memory_barrier2(m_swapchain_images[p_index].Image,
+                                m_surface_data.SurfaceFormat.format,
+                                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                                VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+        VkDependencyInfo dependency_info = {
+            .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+            .pNext = nullptr,
+            .dependencyFlags = 0,
+            .imageMemoryBarrierCount = 1,
+            .pImageMemoryBarriers = &present_barrier
+        };
+        vkCmdPipelineBarrier2(p_command_buffer, &dependency_info);
+    }
+
     void vk_swapchain::recreate() {
         vkDeviceWaitIdle(m_driver);
         on_create();
@@ -419,12 +786,15 @@ namespace vk {
 
         vkDestroyRenderPass(m_driver, m_swapchain_renderpass, nullptr);
 
+        destroy_frames();
         m_swapchain_queue.destroy();
 
         // vkDestroyCommandPool(m_driver, m_command_pool, nullptr);
+        // empty with dynamic rendering
         for (size_t i = 0; i < m_swapchain_command_buffers.size(); i++) {
             m_swapchain_command_buffers[i].destroy();
         }
+        m_swapchain_command_buffers.clear();
 
         for (uint32_t i = 0; i < m_swapchain_depth_images.size(); i++) {
             vkDestroyImageView(
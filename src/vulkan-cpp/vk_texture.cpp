@@ -9,6 +9,8 @@
 #include <vulkan/vulkan.h>
 
 #include <vulkan-cpp/vk_swapchain.hpp>
+#include <algorithm>
+#include <cmath>
 
 namespace vk {
 
@@ -39,7 +41,8 @@ namespace vk {
 
     VkSampler create_sampler(VkFilter MinFilter,
                              VkFilter MaxFilter,
-                             VkSamplerAddressMode AddressMode) {
+                             VkSamplerAddressMode AddressMode,
+                             float p_max_lod) {
         VkDevice driver = vk_driver::driver_context();
 
         VkSamplerCreateInfo SamplerInfo = {
@@ -58,7 +61,7 @@ namespace vk {
             .compareEnable = false,
             .compareOp = VK_COMPARE_OP_ALWAYS,
             .minLod = 0.0f,
-            .maxLod = 0.0f,
+            .maxLod = p_max_lod,
             .borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
             .unnormalizedCoordinates = false
         };
@@ -73,7 +76,10 @@ namespace vk {
 
     VkImageView create_image_view(VkImage Image,
                                   VkFormat Format,
-                                  VkImageAspectFlags AspectFlags) {
+                                  VkImageAspectFlags AspectFlags,
+                                  uint32_t p_mip_levels,
+                                  uint32_t p_array_layers,
+                                  VkImageViewType p_view_type) {
         VkDevice driver = vk_driver::driver_context();
 
         VkImageViewCreateInfo ViewInfo = {
@@ -81,7 +87,7 @@ namespace vk {
             .pNext = NULL,
             .flags = 0,
             .image = Image,
-            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .viewType = p_view_type,
             .format = Format,
             .components = { .r = VK_COMPONENT_SWIZZLE_IDENTITY,
                             .g = VK_COMPONENT_SWIZZLE_IDENTITY,
@@ -89,9 +95,9 @@ namespace vk {
                             .a = VK_COMPONENT_SWIZZLE_IDENTITY },
             .subresourceRange = { .aspectMask = AspectFlags,
                                   .baseMipLevel = 0,
-                                  .levelCount = 1,
+                                  .levelCount = p_mip_levels,
                                   .baseArrayLayer = 0,
-                                  .layerCount = 1 }
+                                  .layerCount = p_array_layers }
         };
 
         VkImageView ImageView;
@@ -104,7 +110,9 @@ namespace vk {
                               uint32_t p_height,
                               VkFormat p_format,
                               VkImageUsageFlags p_usage,
-                              VkMemoryPropertyFlagBits p_property) {
+                              VkMemoryPropertyFlagBits p_property,
+                              uint32_t p_mip_levels,
+                              uint32_t p_array_layers) {
         vk_driver driver = vk_driver::driver_context();
 
         VkImageCreateInfo image_ci = {
@@ -114,8 +122,8 @@ namespace vk {
             .imageType = VK_IMAGE_TYPE_2D,
             .format = p_format,
             .extent = { .width = p_width, .height = p_height, .depth = 1 },
-            .mipLevels = 1,
-            .arrayLayers = 1,
+            .mipLevels = p_mip_levels,
+            .arrayLayers = p_array_layers,
             .samples = VK_SAMPLE_COUNT_1_BIT,
             .tiling = VK_IMAGE_TILING_OPTIMAL,
             .usage = p_usage,
@@ -129,6 +137,9 @@ namespace vk {
         image_data image;
         image.Width = p_width;
         image.Height = p_height;
+        image.MipLevels = p_mip_levels;
+        image.ArrayLayers = p_array_layers;
+        image.Usage = p_usage;
 
         vk_check(vkCreateImage(driver, &image_ci, nullptr, &image.Image),
                  "vkCreateImage",
@@ -163,6 +174,120 @@ namespace vk {
         return image;
     }
 
+    VkImageUsageFlags texture_usage_flags(VkFormat p_format) {
+        VkImageUsageFlags usage =
+          VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+        if (vk_driver::driver_context().supports_host_image_copy(p_format,
+                                                                 usage)) {
+            usage |= VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT;
+        }
+
+        return usage;
+    }
+
+    bool copy_memory_to_image(const image_data& p_image,
+                              VkFormat p_format,
+                              const void* p_pixels,
+                              uint32_t p_mip_level,
+                              uint32_t p_array_layer) {
+        if (!(p_image.Usage & VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT)) {
+            return false;
+        }
+
+        const vk_driver& driver = vk_driver::driver_context();
+        const host_image_copy_dispatch& host_copy = driver.host_image_copy();
+
+        VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+        uint32_t width = std::max(p_image.Width >> p_mip_level, 1u);
+        uint32_t height = std::max(p_image.Height >> p_mip_level, 1u);
+
+        // the subresource never held anything, so its contents can be
+        // discarded while moving it straight into the layout it's sampled in
+        VkHostImageLayoutTransitionInfoEXT transition = {
+            .sType = VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT,
+            .pNext = nullptr,
+            .image = p_image.Image,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            .subresourceRange = { .aspectMask = aspect,
+                                  .baseMipLevel = p_mip_level,
+                                  .levelCount = 1,
+                                  .baseArrayLayer = p_array_layer,
+                                  .layerCount = 1 }
+        };
+
+        vk_check(host_copy.TransitionImageLayout(driver, 1, &transition),
+                 "vkTransitionImageLayoutEXT",
+                 __FUNCTION__);
+
+        VkMemoryToImageCopyEXT region = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT,
+            .pNext = nullptr,
+            .pHostPointer = p_pixels,
+            .memoryRowLength = 0,
+            .memoryImageHeight = 0,
+            .imageSubresource = { .aspectMask = aspect,
+                                  .mipLevel = p_mip_level,
+                                  .baseArrayLayer = p_array_layer,
+                                  .layerCount = 1 },
+            .imageOffset = { .x = 0, .y = 0, .z = 0 },
+            .imageExtent = { .width = width, .height = height, .depth = 1 }
+        };
+
+        VkCopyMemoryToImageInfoEXT copy_info = {
+            .sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT,
+            .pNext = nullptr,
+            .flags = 0,
+            .dstImage = p_image.Image,
+            .dstImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            .regionCount = 1,
+            .pRegions = &region
+        };
+
+        vk_check(host_copy.CopyMemoryToImage(driver, &copy_info),
+                 "vkCopyMemoryToImageEXT",
+                 __FUNCTION__);
+
+        return true;
+    }
+
+    uint32_t mip_level_count(uint32_t p_width, uint32_t p_height) {
+        uint32_t largest = std::max(p_width, p_height);
+        return static_cast<uint32_t>(std::floor(std::log2(largest))) + 1;
+    }
+
+    std::vector<uint8_t> downsample_rgba8(const uint8_t* p_pixels,
+                                          uint32_t p_width,
+                                          uint32_t p_height) {
+        static constexpr uint32_t channels = 4;
+        uint32_t width = std::max(p_width / 2, 1u);
+        uint32_t height = std::max(p_height / 2, 1u);
+        std::vector<uint8_t> dst(width * height * channels);
+
+        for (uint32_t y = 0; y < height; y++) {
+            uint32_t y0 = std::min(y * 2, p_height - 1);
+            uint32_t y1 = std::min(y * 2 + 1, p_height - 1);
+
+            for (uint32_t x = 0; x < width; x++) {
+                uint32_t x0 = std::min(x * 2, p_width - 1);
+                uint32_t x1 = std::min(x * 2 + 1, p_width - 1);
+
+                for (uint32_t c = 0; c < channels; c++) {
+                    uint32_t sum =
+                      p_pixels[(y0 * p_width + x0) * channels + c] +
+                      p_pixels[(y0 * p_width + x1) * channels + c] +
+                      p_pixels[(y1 * p_width + x0) * channels + c] +
+                      p_pixels[(y1 * p_width + x1) * channels + c];
+                    dst[(y * width + x) * channels + c] =
+                      static_cast<uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
+
+        return dst;
+    }
+
     bool has_stencil_attachment(VkFormat p_format) {
         return ((p_format == VK_FORMAT_D32_SFLOAT_S8_UINT) ||
                 (p_format == VK_FORMAT_D24_UNORM_S8_UINT));
@@ -179,30 +304,34 @@ namespace vk {
         */
 
         m_driver = vk_driver::driver_context();
-        m_graphics_queue = m_driver.get_graphics_queue();
 
-        command_buffer_properties properties = {
-            0,
-            command_buffer_levels::Primary,
-            VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
-        };
+        vk_upload_batch upload_batch = vk_upload_batch();
+        load_from_file(p_filename, upload_batch);
+        upload_batch.submit();
+        upload_batch.destroy();
 
-        m_copy_command_buffer = vk_command_buffer(properties);
+        console_log_info("vk_texture begin successful initialization!!!");
+    }
 
-        if (m_copy_command_buffer == nullptr) {
-            console_log_error("m_copy_command_buffer IS NULL!!!");
-        }
-        else {
-            console_log_info("m_copy_command_buffer NOT NULL!!!");
-        }
+    vk_texture::vk_texture(const image_data& p_image) {
+        m_driver = vk_driver::driver_context();
+        m_texture_image = p_image;
+    }
+
+    vk_texture::vk_texture(const std::string& p_filename,
+                           vk_upload_batch& p_batch) {
+        m_driver = vk_driver::driver_context();
+        load_from_file(p_filename, p_batch);
+    }
 
+    void vk_texture::load_from_file(const std::string& p_filename,
+                                    vk_upload_batch& p_batch) {
         int w, h;
         int channels;
 
         // 1. load from file
         stbi_uc* image_data =
           stbi_load(p_filename.c_str(), &w, &h, &channels, STBI_rgb_alpha);
-        VkDeviceSize image_size = w * h * 4;
 
         if (!image_data) {
             console_log_warn("Could not load filename with = {}", p_filename);
@@ -216,8 +345,13 @@ namespace vk {
         VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
 
         // 1. creating image data
-        // 2. updating texture data
-        create_texture_from_data(w, h, image_data, format);
+        VkImageUsageFlags usage = texture_usage_flags(format);
+        VkMemoryPropertyFlagBits property = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+        m_texture_image = create_image2d(w, h, format, usage, property);
+
+        // 2. recording texture data upload (pixels are copied into staging
+        // memory here, so the stbi pixels can be freed right after)
+        update_texture(p_batch, m_texture_image, format, image_data);
 
         stbi_image_free(image_data);
 
@@ -232,8 +366,6 @@ namespace vk {
 
         m_texture_image.Sampler =
           create_sampler(min_filter, max_filter, addr_mode);
-
-        console_log_info("vk_texture begin successful initialization!!!");
     }
 
     void vk_texture::create_texture_from_data(uint32_t p_width,
@@ -241,9 +373,7 @@ namespace vk {
                                               const void* p_pixels,
                                               VkFormat p_format) {
         console_log_info("create_texture_from_data begin initialization!!!");
-        VkImageUsageFlagBits usage =
-          (VkImageUsageFlagBits)(VK_IMAGE_USAGE_TRANSFER_DST_BIT |
-                                 VK_IMAGE_USAGE_SAMPLED_BIT);
+        VkImageUsageFlags usage = texture_usage_flags(p_format);
         VkMemoryPropertyFlagBits property = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
         // 1. create image  object
@@ -265,85 +395,33 @@ namespace vk {
                                     uint32_t p_height,
                                     VkFormat p_format,
                                     const void* p_pixels) {
+        p_image_data.Width = p_width;
+        p_image_data.Height = p_height;
 
-        // 1. bytes per pixels
-        int bytes_per_pixels = bytes_per_texture_format(p_format);
-
-        // 2. layer_size
-        VkDeviceSize layer_size = p_width * p_height * bytes_per_pixels;
-        int layer_count = 1;
-        VkDeviceSize image_size = layer_count * layer_size;
-
-        VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-        VkMemoryPropertyFlags property = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                                         VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
-
-        // 3. creating data for staging buffers
-        m_staging_buffer = create_buffer(image_size, usage, property);
-
-        // 4. maps the buffer data to that parameters
-        write(m_staging_buffer, p_pixels, image_size);
-
-        // 5. transition image layout
-        transition_image_layout(p_image_data.Image,
-                                p_format,
-                                VK_IMAGE_LAYOUT_UNDEFINED,
-                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-
-        // // 6. Copy buffer to image
-        copy_buffer_to_image(p_image_data.Image,
-                             m_staging_buffer.BufferHandler,
-                             p_width,
-                             p_height);
-
-        // // 7. transition image layout again
-        transition_image_layout(p_image_data.Image,
-                                p_format,
-                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-        console_log_error(
-          "create_texture_from_data end initialization successfully!!!");
+        vk_upload_batch upload_batch = vk_upload_batch();
+        update_texture(upload_batch, p_image_data, p_format, p_pixels);
+        upload_batch.submit();
+        upload_batch.destroy();
     }
 
-    // This should automatically submit to the swaphain to the swapchain
-    // queue-specifically
-    void vk_texture::transition_image_layout(VkImage& p_image,
-                                             VkFormat p_format,
-                                             VkImageLayout p_old,
-                                             VkImageLayout p_new) {
-        m_copy_command_buffer.begin(
-          VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-
-        // 1. image memory barrier
-        VkCommandBuffer handle = m_copy_command_buffer.handle();
-        image_memory_barrier(handle, p_image, p_format, p_old, p_new);
-
-        // submit one copy
-        m_copy_command_buffer.end();
-
-        VkCommandBuffer buffer = m_copy_command_buffer.handle();
-
-        VkSubmitInfo submitInfo = {
-            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-            .commandBufferCount = 1,
-            .pCommandBuffers = &buffer,
-        };
-
-        vkQueueSubmit(m_graphics_queue, 1, &submitInfo, VK_NULL_HANDLE);
-        vkQueueWaitIdle(m_graphics_queue);
+    void vk_texture::update_texture(vk_upload_batch& p_batch,
+                                    image_data& p_image_data,
+                                    VkFormat p_format,
+                                    const void* p_pixels) {
+        p_batch.add(p_image_data, p_format, p_pixels);
     }
 
-    void vk_texture::image_memory_barrier(VkCommandBuffer& p_command_buffer,
-                                          VkImage& p_image,
-                                          VkFormat p_format,
-                                          VkImageLayout p_old,
-                                          VkImageLayout p_new) {
-        VkImageMemoryBarrier image_memory_barrier = {
-            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+    VkImageMemoryBarrier2 image_memory_barrier2(VkImage p_image,
+                                                VkFormat p_format,
+                                                VkImageLayout p_old,
+                                                VkImageLayout p_new) {
+        VkImageMemoryBarrier2 image_memory_barrier = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
             .pNext = nullptr,
-            .srcAccessMask = 0,
-            .dstAccessMask = 0,
+            .srcStageMask = VK_PIPELINE_STAGE_2_NONE,
+            .srcAccessMask = VK_ACCESS_2_NONE,
+            .dstStageMask = VK_PIPELINE_STAGE_2_NONE,
+            .dstAccessMask = VK_ACCESS_2_NONE,
             .oldLayout = p_old,
             .newLayout = p_new,
             .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
@@ -351,14 +429,11 @@ namespace vk {
             .image = p_image,
             .subresourceRange = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
                                   .baseMipLevel = 0,
-                                  .levelCount = 1,
+                                  .levelCount = VK_REMAINING_MIP_LEVELS,
                                   .baseArrayLayer = 0,
-                                  .layerCount = 1 }
+                                  .layerCount = VK_REMAINING_ARRAY_LAYERS }
         };
 
-        VkPipelineStageFlags source_stage;
-        VkPipelineStageFlags dst_stages;
-
         if (p_new == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL ||
             (p_format == VK_FORMAT_D16_UNORM) ||
             (p_format == VK_FORMAT_X8_D24_UNORM_PACK32) ||
@@ -374,163 +449,149 @@ namespace vk {
                   VK_IMAGE_ASPECT_STENCIL_BIT;
             }
         }
-        else {
-            image_memory_barrier.subresourceRange.aspectMask =
-              VK_IMAGE_ASPECT_COLOR_BIT;
-        }
 
-        if (p_old == VK_IMAGE_LAYOUT_UNDEFINED &&
-            p_new == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-            image_memory_barrier.srcAccessMask = 0;
-            image_memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-            source_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            dst_stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-        }
-        else if (p_old == VK_IMAGE_LAYOUT_UNDEFINED &&
-                 p_new == VK_IMAGE_LAYOUT_GENERAL) {
-            image_memory_barrier.srcAccessMask = 0;
-            image_memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-            source_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-            dst_stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-        }
+        // Depth attachments are accessed in both early and late fragment tests
+        VkPipelineStageFlags2 depth_stages =
+          VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT |
+          VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
 
         if (p_old == VK_IMAGE_LAYOUT_UNDEFINED &&
             p_new == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-            image_memory_barrier.srcAccessMask = 0;
-            image_memory_barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-            source_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            dst_stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+            // nothing to wait on, contents are discarded
+            image_memory_barrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+            image_memory_barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        } /* Convert from updateable texture to shader read-only */
+        else if (p_old == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL &&
+                 p_new == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+            image_memory_barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+            image_memory_barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+            image_memory_barrier.dstStageMask =
+              VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+            image_memory_barrier.dstAccessMask =
+              VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
         } /* Convert back from read-only to updateable */
         else if (p_old == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL &&
                  p_new == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-            image_memory_barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-            image_memory_barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-            source_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-            dst_stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        } /* Convert from updateable texture to shader read-only */
-        else if (p_old == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL &&
+            // write-after-read only needs an execution dependency
+            image_memory_barrier.srcStageMask =
+              VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+            image_memory_barrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+            image_memory_barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        } /* Convert from read-only to the source of an image copy */
+        else if (p_old == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL &&
+                 p_new == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
+            // read-after-read only needs an execution dependency
+            image_memory_barrier.srcStageMask =
+              VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+            image_memory_barrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+            image_memory_barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+        } /* Convert a copy source back to read-only */
+        else if (p_old == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL &&
                  p_new == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-            image_memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            image_memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-            source_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-            dst_stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            // read-after-read only needs an execution dependency
+            image_memory_barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+            image_memory_barrier.dstStageMask =
+              VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+            image_memory_barrier.dstAccessMask =
+              VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+        }
+        else if (p_old == VK_IMAGE_LAYOUT_UNDEFINED &&
+                 p_new == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+            image_memory_barrier.dstStageMask =
+              VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+            image_memory_barrier.dstAccessMask =
+              VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+        }
+        else if (p_old == VK_IMAGE_LAYOUT_UNDEFINED &&
+                 p_new == VK_IMAGE_LAYOUT_GENERAL) {
+            image_memory_barrier.dstStageMask =
+              VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+            image_memory_barrier.dstAccessMask =
+              VK_ACCESS_2_SHADER_STORAGE_READ_BIT |
+              VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
         } /* Convert depth texture from undefined state to depth-stencil buffer
            */
         else if (p_old == VK_IMAGE_LAYOUT_UNDEFINED &&
                  p_new == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-            image_memory_barrier.srcAccessMask = 0;
+            // the previous frame's depth writes must land before the clear
+            image_memory_barrier.srcStageMask = depth_stages;
+            image_memory_barrier.srcAccessMask =
+              VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            image_memory_barrier.dstStageMask = depth_stages;
             image_memory_barrier.dstAccessMask =
-              VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
-              VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-            source_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            dst_stages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-        } /* Wait for render pass to complete */
-        else if (p_old == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL &&
-                 p_new == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+              VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+              VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        } /* Swapchain image about to be rendered into, waits on the same
+             stage the image acquire semaphore is waited on */
+        else if (p_old == VK_IMAGE_LAYOUT_UNDEFINED &&
+                 p_new == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) {
+            image_memory_barrier.srcStageMask =
+              VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+            image_memory_barrier.dstStageMask =
+              VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+            image_memory_barrier.dstAccessMask =
+              VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+        } /* Rendered swapchain image handed to the presentation engine */
+        else if (p_old == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL &&
+                 p_new == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR) {
+            image_memory_barrier.srcStageMask =
+              VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
             image_memory_barrier.srcAccessMask =
-              0; // VK_ACCESS_SHADER_READ_BIT;
-            image_memory_barrier.dstAccessMask = 0;
-            /*
-                    source_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-            ///		dst_stages = VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT;
-                    dst_stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            */
-            source_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            dst_stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+              VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
         } /* Convert back from read-only to color attachment */
         else if (p_old == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL &&
                  p_new == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) {
-            image_memory_barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            image_memory_barrier.srcStageMask =
+              VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+            image_memory_barrier.dstStageMask =
+              VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
             image_memory_barrier.dstAccessMask =
-              VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-            source_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-            dst_stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        } /* Convert from updateable texture to shader read-only */
+              VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT |
+              VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+        } /* Convert from color attachment to shader read-only */
         else if (p_old == VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL &&
                  p_new == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+            image_memory_barrier.srcStageMask =
+              VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
             image_memory_barrier.srcAccessMask =
-              VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-            image_memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-            source_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            dst_stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+              VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+            image_memory_barrier.dstStageMask =
+              VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+            image_memory_barrier.dstAccessMask =
+              VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
         } /* Convert back from read-only to depth attachment */
         else if (p_old == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL &&
                  p_new == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-            image_memory_barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+            image_memory_barrier.srcStageMask =
+              VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+            image_memory_barrier.dstStageMask = depth_stages;
             image_memory_barrier.dstAccessMask =
-              VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-            source_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-            dst_stages = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+              VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+              VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
         } /* Convert from updateable depth texture to shader read-only */
         else if (p_old == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL &&
                  p_new == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
+            image_memory_barrier.srcStageMask = depth_stages;
             image_memory_barrier.srcAccessMask =
-              VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-            image_memory_barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-            source_stage = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-            dst_stages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+              VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            image_memory_barrier.dstStageMask =
+              VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+            image_memory_barrier.dstAccessMask =
+              VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+        }
+        else {
+            console_log_warn("image_memory_barrier2 unhandled layout "
+                             "transition, using a full barrier");
+            image_memory_barrier.srcStageMask =
+              VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            image_memory_barrier.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT;
+            image_memory_barrier.dstStageMask =
+              VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            image_memory_barrier.dstAccessMask =
+              VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
         }
 
-        vkCmdPipelineBarrier(p_command_buffer,
-                             source_stage,
-                             dst_stages,
-                             0,
-                             0,
-                             nullptr,
-                             0,
-                             nullptr,
-                             1,
-                             &image_memory_barrier);
-    }
-
-    void vk_texture::copy_buffer_to_image(VkImage& p_image,
-                                          VkBuffer& p_buffer,
-                                          uint32_t p_width,
-                                          uint32_t p_height) {
-        m_copy_command_buffer.begin(
-          VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-
-        VkBufferImageCopy buffer_image_copy = {
-            .bufferOffset = 0,
-            .bufferRowLength = 0,
-            .bufferImageHeight = 0,
-            .imageSubresource = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                                  .mipLevel = 0,
-                                  .baseArrayLayer = 0,
-                                  .layerCount = 1 },
-            .imageOffset = { .x = 0, .y = 0, .z = 0 },
-            .imageExtent = { .width = p_width, .height = p_height, .depth = 1 }
-        };
-
-        vkCmdCopyBufferToImage(m_copy_command_buffer,
-                               p_buffer,
-                               p_image,
-                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                               1,
-                               &buffer_image_copy);
-
-        m_copy_command_buffer.end();
-
-        VkCommandBuffer buffer = m_copy_command_buffer.handle();
-
-        VkSubmitInfo submitInfo = {
-            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-            .commandBufferCount = 1,
-            .pCommandBuffers = &buffer,
-        };
-
-        vkQueueSubmit(m_graphics_queue, 1, &submitInfo, VK_NULL_HANDLE);
-        vkQueueWaitIdle(m_graphics_queue);
+        return image_memory_barrier;
     }
 
     void vk_texture::destroy() {
@@ -539,11 +600,6 @@ namespace vk {
         vkDestroySampler(m_driver, m_texture_image.Sampler, nullptr);
 
         vkFreeMemory(m_driver, m_texture_image.DeviceMemory, nullptr);
-
-        vkDestroyBuffer(m_driver, m_staging_buffer.BufferHandler, nullptr);
-        vkFreeMemory(m_driver, m_staging_buffer.DeviceMemory, nullptr);
-
-        m_copy_command_buffer.destroy();
     }
 
 };
\ No newline at end of file
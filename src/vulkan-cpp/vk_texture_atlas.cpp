@@ -0,0 +1,280 @@
+#include <vulkan-cpp/vk_texture_atlas.hpp>
+#include <vulkan-cpp/logger.hpp>
+#include <stb_image.h>
+#include <algorithm>
+#include <numeric>
+
+namespace vk {
+    static constexpr uint32_t bytes_per_texel = 4;
+    static constexpr VkFormat atlas_format = VK_FORMAT_R8G8B8A8_UNORM;
+
+    static uint32_t align_up(uint32_t p_value, uint32_t p_alignment) {
+        return (p_value + p_alignment - 1) & ~(p_alignment - 1);
+    }
+
+    void remap_uvs(std::span<vertex> p_vertices, const atlas_region& p_region) {
+        for (vertex& v : p_vertices) {
+            v.Uv = p_region.UvOffset + v.Uv * p_region.UvScale;
+        }
+    }
+
+    texture_atlas_packer::texture_atlas_packer(
+      const atlas_packer_properties& p_properties)
+      : m_properties(p_properties) {
+        m_properties.MipLevels =
+          std::clamp(m_properties.MipLevels,
+                     1u,
+                     mip_level_count(m_properties.PageSize,
+                                     m_properties.PageSize));
+    }
+
+    bool texture_atlas_packer::add(const std::string& p_name,
+                                   const std::string& p_filename) {
+        int w, h;
+        int channels;
+        stbi_uc* pixels =
+          stbi_load(p_filename.c_str(), &w, &h, &channels, STBI_rgb_alpha);
+
+        if (!pixels) {
+            console_log_warn("texture_atlas_packer could not load {}",
+                             p_filename);
+            return false;
+        }
+
+        add(p_name, pixels, w, h);
+        stbi_image_free(pixels);
+        return true;
+    }
+
+    void texture_atlas_packer::add(const std::string& p_name,
+                                   const uint8_t* p_pixels,
+                                   uint32_t p_width,
+                                   uint32_t p_height) {
+        size_t image_size =
+          static_cast<size_t>(p_width) * p_height * bytes_per_texel;
+
+        source_texture texture = {
+            .Name = p_name,
+            .Width = p_width,
+            .Height = p_height,
+            .Pixels = std::vector<uint8_t>(p_pixels, p_pixels + image_size)
+        };
+        m_textures.push_back(texture);
+    }
+
+    uint32_t texture_atlas_packer::shelf_pack(
+      std::vector<placement>& p_placements) {
+        uint32_t page_size = m_properties.PageSize;
+        uint32_t padding = alignment();
+
+        // tallest first keeps the wasted space on each shelf small
+        std::vector<size_t> order(m_textures.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [this](size_t p_a,
+                                                            size_t p_b) {
+            return m_textures[p_a].Height > m_textures[p_b].Height;
+        });
+
+        p_placements.resize(m_textures.size());
+        uint32_t layer = 0;
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t shelf_height = 0;
+        bool page_used = false;
+
+        for (size_t i : order) {
+            const source_texture& texture = m_textures[i];
+            uint32_t slot_width =
+              align_up(texture.Width, padding) + 2 * padding;
+            uint32_t slot_height =
+              align_up(texture.Height, padding) + 2 * padding;
+
+            if (slot_width > page_size or slot_height > page_size) {
+                console_log_error("texture_atlas_packer {} ({}x{}) does not "
+                                  "fit inside of a {}x{} page",
+                                  texture.Name,
+                                  texture.Width,
+                                  texture.Height,
+                                  page_size,
+                                  page_size);
+                p_placements[i].Layer = UINT32_MAX;
+                continue;
+            }
+
+            if (x + slot_width > page_size) {
+                y += shelf_height;
+                x = 0;
+                shelf_height = 0;
+            }
+
+            if (y + slot_height > page_size) {
+                layer++;
+                x = 0;
+                y = 0;
+                shelf_height = 0;
+            }
+
+            p_placements[i] = { .Layer = layer, .X = x, .Y = y };
+            x += slot_width;
+            shelf_height = std::max(shelf_height, slot_height);
+            page_used = true;
+        }
+
+        return page_used ? layer + 1 : 0;
+    }
+
+    void texture_atlas_packer::blit_padded(std::vector<uint8_t>& p_page,
+                                           uint32_t p_page_size,
+                                           const source_texture& p_texture,
+                                           const placement& p_placement,
+                                           uint32_t p_slot_width,
+                                           uint32_t p_slot_height,
+                                           uint32_t p_padding) {
+        // texels outside of the texture repeat its closest edge texel
+        for (uint32_t y = 0; y < p_slot_height; y++) {
+            uint32_t src_y = std::clamp<int64_t>(
+              static_cast<int64_t>(y) - p_padding, 0, p_texture.Height - 1);
+
+            for (uint32_t x = 0; x < p_slot_width; x++) {
+                uint32_t src_x = std::clamp<int64_t>(
+                  static_cast<int64_t>(x) - p_padding, 0, p_texture.Width - 1);
+
+                const uint8_t* src =
+                  &p_texture.Pixels[(src_y * p_texture.Width + src_x) *
+                                    bytes_per_texel];
+                uint8_t* dst =
+                  &p_page[((p_placement.Y + y) * p_page_size + p_placement.X +
+                           x) *
+                          bytes_per_texel];
+                std::copy(src, src + bytes_per_texel, dst);
+            }
+        }
+    }
+
+    texture_atlas texture_atlas_packer::pack(vk_upload_batch& p_batch) {
+        texture_atlas atlas;
+        if (m_textures.empty()) {
+            return atlas;
+        }
+
+        std::vector<placement> placements;
+        uint32_t page_size = 0;
+        uint32_t layer_count = 0;
+        uint32_t padding = 0;
+        uint32_t mip_levels = 0;
+
+        if (m_properties.Layout == atlas_layout::ATLAS) {
+            page_size = m_properties.PageSize;
+            padding = alignment();
+            mip_levels = m_properties.MipLevels;
+            layer_count = shelf_pack(placements);
+        }
+        else {
+            // each layer only holds one texture, so there is nothing that
+            // could bleed in and the full mip chain can be generated
+            for (const source_texture& texture : m_textures) {
+                page_size =
+                  std::max({ page_size, texture.Width, texture.Height });
+            }
+            mip_levels = mip_level_count(page_size, page_size);
+            layer_count = static_cast<uint32_t>(m_textures.size());
+
+            placements.resize(m_textures.size());
+            for (uint32_t i = 0; i < layer_count; i++) {
+                placements[i] = { .Layer = i, .X = 0, .Y = 0 };
+            }
+        }
+
+        if (layer_count == 0) {
+            return atlas;
+        }
+
+        console_log_trace("texture_atlas_packer packed {} textures into {} "
+                          "layers of {}x{}",
+                          m_textures.size(),
+                          layer_count,
+                          page_size,
+                          page_size);
+
+        size_t page_bytes =
+          static_cast<size_t>(page_size) * page_size * bytes_per_texel;
+        std::vector<std::vector<uint8_t>> pages(
+          layer_count, std::vector<uint8_t>(page_bytes, 0));
+
+        for (size_t i = 0; i < m_textures.size(); i++) {
+            const source_texture& texture = m_textures[i];
+            const placement& place = placements[i];
+            if (place.Layer == UINT32_MAX) {
+                continue;
+            }
+
+            uint32_t slot_width = page_size;
+            uint32_t slot_height = page_size;
+            if (m_properties.Layout == atlas_layout::ATLAS) {
+                slot_width = align_up(texture.Width, padding) + 2 * padding;
+                slot_height = align_up(texture.Height, padding) + 2 * padding;
+            }
+
+            blit_padded(pages[place.Layer],
+                        page_size,
+                        texture,
+                        place,
+                        slot_width,
+                        slot_height,
+                        padding);
+
+            glm::vec2 page_extent = glm::vec2(static_cast<float>(page_size));
+            glm::vec2 origin = glm::vec2(place.X + padding, place.Y + padding);
+            glm::vec2 extent = glm::vec2(texture.Width, texture.Height);
+            atlas.m_regions[texture.Name] = { .Layer = place.Layer,
+                                              .UvOffset = origin / page_extent,
+                                              .UvScale = extent / page_extent };
+        }
+
+        VkImageUsageFlags usage = texture_usage_flags(atlas_format);
+        VkMemoryPropertyFlagBits property = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+        image_data image = create_image2d(page_size,
+                                          page_size,
+                                          atlas_format,
+                                          usage,
+                                          property,
+                                          mip_levels,
+                                          layer_count);
+
+        // p_batch copies into staging right away, so each mip can be dropped
+        // as soon as the next one has been generated from it
+        for (uint32_t layer = 0; layer < layer_count; layer++) {
+            std::vector<uint8_t> mip_pixels = std::move(pages[layer]);
+            uint32_t mip_size = page_size;
+
+            for (uint32_t mip = 0; mip < mip_levels; mip++) {
+                p_batch.add(image, atlas_format, mip_pixels.data(), mip, layer);
+
+                if (mip + 1 < mip_levels) {
+                    mip_pixels =
+                      downsample_rgba8(mip_pixels.data(), mip_size, mip_size);
+                    mip_size = std::max(mip_size / 2, 1u);
+                }
+            }
+        }
+
+        image.ImageView = create_image_view(image.Image,
+                                            atlas_format,
+                                            VK_IMAGE_ASPECT_COLOR_BIT,
+                                            mip_levels,
+                                            layer_count,
+                                            VK_IMAGE_VIEW_TYPE_2D_ARRAY);
+
+        // an atlas page must not wrap into the neighbouring textures, and a
+        // texture filling its layer must not blend in its opposite edge
+        image.Sampler = create_sampler(VK_FILTER_LINEAR,
+                                       VK_FILTER_LINEAR,
+                                       VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+                                       VK_LOD_CLAMP_NONE);
+
+        atlas.m_texture = vk_texture(image);
+        atlas.m_layer_count = layer_count;
+        return atlas;
+    }
+};
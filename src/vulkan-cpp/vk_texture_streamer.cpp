@@ -0,0 +1,579 @@
+#include <vulkan-cpp/vk_texture_streamer.hpp>
+#include <vulkan-cpp/vk_texture.hpp>
+#include <vulkan-cpp/vk_swapchain.hpp>
+#include <vulkan-cpp/logger.hpp>
+#include <stb_image.h>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+namespace vk {
+    static constexpr uint32_t bytes_per_texel = 4;
+
+    static uint32_t mip_extent(uint32_t p_extent, uint32_t p_mip) {
+        return std::max(p_extent >> p_mip, 1u);
+    }
+
+    //! @note Bytes taken up by the mips [p_base_mip, p_mip_count)
+    static uint64_t mip_chain_bytes(uint32_t p_width,
+                                    uint32_t p_height,
+                                    uint32_t p_mip_count,
+                                    uint32_t p_base_mip) {
+        uint64_t bytes = 0;
+        for (uint32_t mip = p_base_mip; mip < p_mip_count; mip++) {
+            bytes += static_cast<uint64_t>(mip_extent(p_width, mip)) *
+                     mip_extent(p_height, mip) * bytes_per_texel;
+        }
+        return bytes;
+    }
+
+    uint32_t mip_from_uv_derivative(float p_uv_per_pixel,
+                                    uint32_t p_texture_size) {
+        float texels_per_pixel = p_uv_per_pixel * p_texture_size;
+        if (texels_per_pixel <= 1.0f) {
+            return 0;
+        }
+
+        return static_cast<uint32_t>(std::floor(std::log2(texels_per_pixel)));
+    }
+
+    uint32_t mip_from_distance(float p_distance,
+                               float p_object_radius,
+                               float p_fov_y,
+                               uint32_t p_viewport_height,
+                               uint32_t p_texture_size) {
+        if (p_distance <= p_object_radius) {
+            return 0;
+        }
+
+        // screen height in pixels covered by the object's diameter
+        float projected_pixels = (p_object_radius /
+                                  (p_distance * std::tan(p_fov_y * 0.5f))) *
+                                 p_viewport_height;
+
+        if (projected_pixels <= 1.0f) {
+            return mip_level_count(p_texture_size, p_texture_size) - 1;
+        }
+
+        return mip_from_uv_derivative(1.0f / projected_pixels, p_texture_size);
+    }
+
+    vk_texture_streamer::vk_texture_streamer(uint64_t p_budget_bytes)
+      : m_budget_bytes(p_budget_bytes) {
+        m_driver = vk_driver::driver_context();
+        m_worker = std::thread([this]() { worker_loop(); });
+    }
+
+    streamed_texture_id vk_texture_streamer::add(
+      const std::string& p_filename) {
+        int w = 0;
+        int h = 0;
+        int channels = 0;
+        streamed_texture texture = { .Filename = p_filename };
+
+        if (!stbi_info(p_filename.c_str(), &w, &h, &channels)) {
+            console_log_warn("vk_texture_streamer could not read {}",
+                             p_filename);
+        }
+        else {
+            texture.Width = w;
+            texture.Height = h;
+            texture.MipCount = mip_level_count(w, h);
+            texture.ResidentMip = texture.MipCount;
+
+            // start off with a small mip so there is something to sample
+            uint32_t initial_mip = 0;
+            while (std::max(mip_extent(texture.Width, initial_mip),
+                            mip_extent(texture.Height, initial_mip)) >
+                   InitialResidentSize) {
+                initial_mip++;
+            }
+            texture.RequestedMip = initial_mip;
+            texture.LastRequestedFrame = m_frame;
+        }
+
+        m_textures.push_back(texture);
+        return static_cast<streamed_texture_id>(m_textures.size() - 1);
+    }
+
+    void vk_texture_streamer::request_mip(streamed_texture_id p_id,
+                                          uint32_t p_mip) {
+        streamed_texture& texture = m_textures[p_id];
+        if (texture.MipCount == 0) {
+            return;
+        }
+
+        uint32_t mip = std::min(p_mip, texture.MipCount - 1);
+
+        if (texture.LastRequestedFrame != m_frame) {
+            texture.RequestedMip = mip;
+            texture.LastRequestedFrame = m_frame;
+        }
+        else {
+            texture.RequestedMip = std::min(texture.RequestedMip, mip);
+        }
+    }
+
+    void vk_texture_streamer::request_by_distance(streamed_texture_id p_id,
+                                                  float p_distance,
+                                                  float p_object_radius,
+                                                  float p_fov_y,
+                                                  uint32_t p_viewport_height) {
+        const streamed_texture& texture = m_textures[p_id];
+        request_mip(p_id,
+                    mip_from_distance(p_distance,
+                                      p_object_radius,
+                                      p_fov_y,
+                                      p_viewport_height,
+                                      std::max(texture.Width, texture.Height)));
+    }
+
+    void vk_texture_streamer::request_by_uv_derivative(
+      streamed_texture_id p_id,
+      float p_uv_per_pixel) {
+        const streamed_texture& texture = m_textures[p_id];
+        request_mip(
+          p_id,
+          mip_from_uv_derivative(p_uv_per_pixel,
+                                 std::max(texture.Width, texture.Height)));
+    }
+
+    void vk_texture_streamer::update() {
+        // 1. destroy images that no in-flight frame can reference anymore
+        for (size_t i = 0; i < m_retired_images.size();) {
+            if (m_retired_images[i].DestroyFrame > m_frame) {
+                i++;
+                continue;
+            }
+
+            destroy_image(m_retired_images[i].Image);
+            m_retired_images[i] = m_retired_images.back();
+            m_retired_images.pop_back();
+        }
+
+        // 2. swap in the images of uploads the GPU finished since the last
+        // update, until then their textures sample the previous image
+        std::vector<streamed_texture_id> changed = complete_uploads();
+
+        // 3. collect every mip chain the worker finished since last update,
+        // they are uploaded in the same submission as the evictions below.
+        // Their textures are still LoadPending, so step 4 leaves them alone
+        std::vector<loaded_mip_chain> loaded;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            loaded.swap(m_loaded);
+        }
+
+        // 4. textures above what fits inside the budget drop their most
+        // detailed mips right away, the remaining mips are copied on the GPU
+        // so nothing has to be loaded again. Textures below it get loads
+        // scheduled on the worker
+        std::vector<uint32_t> target_mips = fit_to_budget();
+        std::vector<streamed_texture_id> evictions;
+        std::vector<load_request> requests;
+
+        for (streamed_texture_id id = 0; id < m_textures.size(); id++) {
+            streamed_texture& texture = m_textures[id];
+            if (texture.MipCount == 0 or texture.LoadPending or
+                texture.UploadPending or
+                texture.ResidentMip == target_mips[id]) {
+                continue;
+            }
+
+            if (target_mips[id] > texture.ResidentMip and
+                texture.ResidentMip < texture.MipCount) {
+                evictions.push_back(id);
+                continue;
+            }
+
+            requests.push_back({ .Id = id,
+                                 .BaseMip = target_mips[id],
+                                 .Filename = texture.Filename });
+        }
+
+        // 5. one submission for everything staged this update, polled by
+        // the next ones instead of waited on
+        if (!loaded.empty() or !evictions.empty()) {
+            bool reuse = !m_free_batches.empty();
+            pending_upload upload = {
+                .Batch = reuse ? std::move(m_free_batches.back())
+                               : vk_upload_batch()
+            };
+            if (reuse) {
+                m_free_batches.pop_back();
+            }
+
+            for (loaded_mip_chain& chain : loaded) {
+                integrate(chain, upload);
+            }
+
+            for (streamed_texture_id id : evictions) {
+                evict(id, target_mips[id], upload);
+            }
+
+            if (upload.Images.empty()) {
+                m_free_batches.push_back(std::move(upload.Batch));
+            }
+            else {
+                upload.Batch.submit_async();
+                m_pending_uploads.push_back(std::move(upload));
+            }
+        }
+
+        if (m_residency_changed) {
+            for (streamed_texture_id id : changed) {
+                m_residency_changed(id, m_textures[id].Image);
+            }
+        }
+
+        if (requests.size() > MaxUploadsPerUpdate) {
+            requests.resize(MaxUploadsPerUpdate);
+        }
+
+        if (!requests.empty()) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (load_request& request : requests) {
+                m_textures[request.Id].LoadPending = true;
+                m_load_requests.push_back(std::move(request));
+            }
+        }
+        m_condition.notify_one();
+
+        m_frame++;
+    }
+
+    std::vector<uint32_t> vk_texture_streamer::fit_to_budget() {
+        std::vector<uint32_t> target_mips(m_textures.size());
+        uint64_t total_bytes = 0;
+
+        for (size_t i = 0; i < m_textures.size(); i++) {
+            const streamed_texture& texture = m_textures[i];
+            target_mips[i] = texture.RequestedMip;
+            total_bytes += mip_chain_bytes(texture.Width,
+                                           texture.Height,
+                                           texture.MipCount,
+                                           target_mips[i]);
+        }
+
+        if (total_bytes <= m_budget_bytes) {
+            return target_mips;
+        }
+
+        // least recently requested textures give up their detail first
+        std::vector<size_t> order(m_textures.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(),
+                         order.end(),
+                         [this](size_t p_a, size_t p_b) {
+                             return m_textures[p_a].LastRequestedFrame <
+                                    m_textures[p_b].LastRequestedFrame;
+                         });
+
+        for (size_t i : order) {
+            const streamed_texture& texture = m_textures[i];
+
+            while (total_bytes > m_budget_bytes and
+                   target_mips[i] + 1 < texture.MipCount) {
+                total_bytes -=
+                  static_cast<uint64_t>(
+                    mip_extent(texture.Width, target_mips[i])) *
+                  mip_extent(texture.Height, target_mips[i]) * bytes_per_texel;
+                target_mips[i]++;
+            }
+
+            if (total_bytes <= m_budget_bytes) {
+                break;
+            }
+        }
+
+        if (total_bytes > m_budget_bytes) {
+            console_log_warn("vk_texture_streamer smallest mips of all "
+                             "textures need {} bytes, budget is {} bytes",
+                             total_bytes,
+                             m_budget_bytes);
+        }
+
+        return target_mips;
+    }
+
+    //! @note Streamed images are also the source when mips get dropped
+    static image_data create_streamed_image(uint32_t p_width,
+                                            uint32_t p_height,
+                                            uint32_t p_mip_levels) {
+        VkImageUsageFlags usage =
+          texture_usage_flags(vk_texture_streamer::Format) |
+          VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        VkMemoryPropertyFlagBits property = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+        return create_image2d(p_width,
+                              p_height,
+                              vk_texture_streamer::Format,
+                              usage,
+                              property,
+                              p_mip_levels);
+    }
+
+    static void create_streamed_view(image_data& p_image) {
+        p_image.ImageView = create_image_view(p_image.Image,
+                                              vk_texture_streamer::Format,
+                                              VK_IMAGE_ASPECT_COLOR_BIT,
+                                              p_image.MipLevels);
+        p_image.Sampler = create_sampler(VK_FILTER_LINEAR,
+                                         VK_FILTER_LINEAR,
+                                         VK_SAMPLER_ADDRESS_MODE_REPEAT,
+                                         VK_LOD_CLAMP_NONE);
+    }
+
+    bool vk_texture_streamer::integrate(loaded_mip_chain& p_chain,
+                                        pending_upload& p_upload) {
+        streamed_texture& texture = m_textures[p_chain.Id];
+        texture.LoadPending = false;
+
+        if (p_chain.Mips.empty()) {
+            console_log_warn("vk_texture_streamer failed loading {}",
+                             texture.Filename);
+            return false;
+        }
+
+        uint32_t mip_levels = static_cast<uint32_t>(p_chain.Mips.size());
+        image_data image =
+          create_streamed_image(p_chain.Width, p_chain.Height, mip_levels);
+
+        // staging copies are taken here, so the CPU mips can go right after
+        for (uint32_t mip = 0; mip < mip_levels; mip++) {
+            p_upload.Batch.add(image, Format, p_chain.Mips[mip].data(), mip);
+        }
+
+        create_streamed_view(image);
+
+        texture.UploadPending = true;
+        p_upload.Images.push_back(
+          { .Id = p_chain.Id, .BaseMip = p_chain.BaseMip, .Image = image });
+        p_chain.Mips.clear();
+        return true;
+    }
+
+    void vk_texture_streamer::evict(streamed_texture_id p_id,
+                                    uint32_t p_base_mip,
+                                    pending_upload& p_upload) {
+        streamed_texture& texture = m_textures[p_id];
+        uint32_t mip_levels = texture.MipCount - p_base_mip;
+        image_data image =
+          create_streamed_image(mip_extent(texture.Width, p_base_mip),
+                                mip_extent(texture.Height, p_base_mip),
+                                mip_levels);
+
+        // mip p_base_mip of the texture is mip (p_base_mip - ResidentMip) of
+        // the resident image
+        uint32_t first_source_mip = p_base_mip - texture.ResidentMip;
+        for (uint32_t mip = 0; mip < mip_levels; mip++) {
+            p_upload.Batch.copy(
+              texture.Image, first_source_mip + mip, image, mip);
+        }
+
+        create_streamed_view(image);
+
+        texture.UploadPending = true;
+        p_upload.Images.push_back(
+          { .Id = p_id, .BaseMip = p_base_mip, .Image = image });
+    }
+
+    std::vector<streamed_texture_id> vk_texture_streamer::complete_uploads() {
+        std::vector<streamed_texture_id> changed;
+
+        for (auto it = m_pending_uploads.begin();
+             it != m_pending_uploads.end();) {
+            if (!it->Batch.is_complete()) {
+                ++it;
+                continue;
+            }
+
+            for (const staged_image& staged : it->Images) {
+                streamed_texture& texture = m_textures[staged.Id];
+
+                // nothing resident counts as ResidentMip == MipCount
+                if (staged.BaseMip < texture.ResidentMip) {
+                    m_mips_loaded += texture.ResidentMip - staged.BaseMip;
+                }
+                else {
+                    m_mips_evicted += staged.BaseMip - texture.ResidentMip;
+                }
+
+                if (texture.ResidentMip < texture.MipCount) {
+                    retire(texture.Image);
+                }
+
+                texture.Image = staged.Image;
+                texture.ResidentMip = staged.BaseMip;
+                texture.UploadPending = false;
+                changed.push_back(staged.Id);
+            }
+
+            m_free_batches.push_back(std::move(it->Batch));
+            it = m_pending_uploads.erase(it);
+        }
+
+        return changed;
+    }
+
+    void vk_texture_streamer::retire(const image_data& p_image) {
+        retired_image retired = {
+            .Image = p_image,
+            .DestroyFrame = m_frame + swapchain_configs::MaxFramesInFlight
+        };
+        m_retired_images.push_back(retired);
+    }
+
+    void vk_texture_streamer::worker_loop() {
+        while (true) {
+            load_request request;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_condition.wait(lock, [this]() {
+                    return m_stop or !m_load_requests.empty();
+                });
+
+                if (m_stop) {
+                    return;
+                }
+
+                request = std::move(m_load_requests.front());
+                m_load_requests.pop_front();
+            }
+
+            loaded_mip_chain chain = load_mip_chain(request);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_loaded.push_back(std::move(chain));
+        }
+    }
+
+    vk_texture_streamer::loaded_mip_chain vk_texture_streamer::load_mip_chain(
+      const load_request& p_request) {
+        loaded_mip_chain chain = { .Id = p_request.Id,
+                                   .BaseMip = p_request.BaseMip };
+        int w, h, channels;
+
+        stbi_uc* pixels = stbi_load(
+          p_request.Filename.c_str(), &w, &h, &channels, STBI_rgb_alpha);
+
+        if (!pixels) {
+            return chain;
+        }
+
+        uint32_t width = w;
+        uint32_t height = h;
+        uint32_t mips = mip_level_count(width, height);
+        size_t image_size =
+          static_cast<size_t>(width) * height * bytes_per_texel;
+        std::vector<uint8_t> current(pixels, pixels + image_size);
+        stbi_image_free(pixels);
+
+        chain.Width = mip_extent(width, p_request.BaseMip);
+        chain.Height = mip_extent(height, p_request.BaseMip);
+
+        for (uint32_t mip = 0; mip < mips; mip++) {
+            std::vector<uint8_t> next;
+            if (mip + 1 < mips) {
+                next = downsample_rgba8(current.data(),
+                                        mip_extent(width, mip),
+                                        mip_extent(height, mip));
+            }
+
+            if (mip >= p_request.BaseMip) {
+                chain.Mips.push_back(std::move(current));
+            }
+            current = std::move(next);
+        }
+
+        return chain;
+    }
+
+    streaming_stats vk_texture_streamer::stats() const {
+        streaming_stats stats = {
+            .BudgetBytes = m_budget_bytes,
+            .TextureCount = static_cast<uint32_t>(m_textures.size()),
+            .PendingDestroys = static_cast<uint32_t>(m_retired_images.size()),
+            .MipsLoaded = m_mips_loaded,
+            .MipsEvicted = m_mips_evicted
+        };
+
+        for (const streamed_texture& texture : m_textures) {
+            stats.ResidentBytes += mip_chain_bytes(texture.Width,
+                                                   texture.Height,
+                                                   texture.MipCount,
+                                                   texture.ResidentMip);
+            stats.RequestedBytes += mip_chain_bytes(texture.Width,
+                                                    texture.Height,
+                                                    texture.MipCount,
+                                                    texture.RequestedMip);
+
+            if (texture.MipCount != 0 and texture.ResidentMip == 0) {
+                stats.FullyResidentCount++;
+            }
+
+            if (texture.LoadPending) {
+                stats.PendingLoads++;
+            }
+
+            if (texture.UploadPending) {
+                stats.PendingUploads++;
+            }
+        }
+
+        return stats;
+    }
+
+    void vk_texture_streamer::destroy_image(const image_data& p_image) {
+        vkDestroyImageView(m_driver, p_image.ImageView, nullptr);
+        vkDestroyImage(m_driver, p_image.Image, nullptr);
+        vkDestroySampler(m_driver, p_image.Sampler, nullptr);
+
+        vkFreeMemory(m_driver, p_image.DeviceMemory, nullptr);
+    }
+
+    void vk_texture_streamer::destroy() {
+        // default constructed, nothing was ever created
+        if (m_driver == nullptr) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_condition.notify_all();
+
+        if (m_worker.joinable()) {
+            m_worker.join();
+        }
+
+        vkDeviceWaitIdle(m_driver);
+
+        // staged images never made it into their texture
+        for (pending_upload& upload : m_pending_uploads) {
+            upload.Batch.destroy();
+            for (const staged_image& staged : upload.Images) {
+                destroy_image(staged.Image);
+            }
+        }
+        m_pending_uploads.clear();
+
+        for (vk_upload_batch& batch : m_free_batches) {
+            batch.destroy();
+        }
+        m_free_batches.clear();
+
+        for (const retired_image& retired : m_retired_images) {
+            destroy_image(retired.Image);
+        }
+        m_retired_images.clear();
+
+        for (streamed_texture& texture : m_textures) {
+            if (texture.Image.Image != nullptr) {
+                destroy_image(texture.Image);
+            }
+        }
+        m_textures.clear();
+    }
+};
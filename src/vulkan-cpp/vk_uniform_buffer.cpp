@@ -9,6 +9,11 @@ namespace vk {
     buffer_properties create_uniform_buffer(uint32_t p_size) {
 
         VkBufferUsageFlags flags = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+
+        // descriptor buffers reference uniforms by their device address
+        if (vk_driver::driver_context().enabled_features().DescriptorBuffer) {
+            flags |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+        }
         VkMemoryPropertyFlags memory_property_flag =
           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
           VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
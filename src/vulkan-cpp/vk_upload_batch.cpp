@@ -0,0 +1,405 @@
+#include <vulkan-cpp/vk_upload_batch.hpp>
+#include <vulkan-cpp/vk_texture.hpp>
+#include <vulkan-cpp/vk_staging_pool.hpp>
+#include <vulkan-cpp/helper_functions.hpp>
+#include <vulkan-cpp/logger.hpp>
+#include <algorithm>
+#include <span>
+
+namespace vk {
+
+    //! @note Stages only synchronization2 has are folded into the stage
+    //! that contains them, an empty source scope waits on nothing
+    static VkPipelineStageFlags legacy_stages(VkPipelineStageFlags2 p_stages) {
+        if (p_stages & VK_PIPELINE_STAGE_2_COPY_BIT) {
+            p_stages &= ~VK_PIPELINE_STAGE_2_COPY_BIT;
+            p_stages |= VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+        }
+        if (p_stages == VK_PIPELINE_STAGE_2_NONE) {
+            return VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        }
+        return static_cast<VkPipelineStageFlags>(p_stages);
+    }
+
+    static VkAccessFlags legacy_access(VkAccessFlags2 p_access) {
+        if (p_access & VK_ACCESS_2_SHADER_SAMPLED_READ_BIT) {
+            p_access &= ~VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+            p_access |= VK_ACCESS_2_SHADER_READ_BIT;
+        }
+        return static_cast<VkAccessFlags>(p_access);
+    }
+
+    //! @note Records p_barriers with vkCmdPipelineBarrier2, or as one
+    //! vkCmdPipelineBarrier per batch on devices without synchronization2,
+    //! which waits on the stages of every barrier in the batch
+    static void record_barriers(
+      const VkCommandBuffer& p_command_buffer,
+      std::span<const VkImageMemoryBarrier2> p_barriers,
+      bool p_synchronization2) {
+        if (p_synchronization2) {
+            VkDependencyInfo dependency_info = {
+                .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+                .pNext = nullptr,
+                .dependencyFlags = 0,
+                .imageMemoryBarrierCount =
+                  static_cast<uint32_t>(p_barriers.size()),
+                .pImageMemoryBarriers = p_barriers.data()
+            };
+            vkCmdPipelineBarrier2(p_command_buffer, &dependency_info);
+            return;
+        }
+
+        VkPipelineStageFlags2 src_stages = VK_PIPELINE_STAGE_2_NONE;
+        VkPipelineStageFlags2 dst_stages = VK_PIPELINE_STAGE_2_NONE;
+        std::vector<VkImageMemoryBarrier> barriers;
+        barriers.reserve(p_barriers.size());
+        for (const VkImageMemoryBarrier2& barrier : p_barriers) {
+            src_stages |= barrier.srcStageMask;
+            dst_stages |= barrier.dstStageMask;
+            barriers.push_back(VkImageMemoryBarrier{
+              .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+              .pNext = nullptr,
+              .srcAccessMask = legacy_access(barrier.srcAccessMask),
+              .dstAccessMask = legacy_access(barrier.dstAccessMask),
+              .oldLayout = barrier.oldLayout,
+              .newLayout = barrier.newLayout,
+              .srcQueueFamilyIndex = barrier.srcQueueFamilyIndex,
+              .dstQueueFamilyIndex = barrier.dstQueueFamilyIndex,
+              .image = barrier.image,
+              .subresourceRange = barrier.subresourceRange });
+        }
+
+        vkCmdPipelineBarrier(p_command_buffer,
+                             legacy_stages(src_stages),
+                             legacy_stages(dst_stages),
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             static_cast<uint32_t>(barriers.size()),
+                             barriers.data());
+    }
+
+    vk_upload_batch::vk_upload_batch() {
+        m_driver = vk_driver::driver_context();
+        m_graphics_queue = m_driver.get_graphics_queue();
+        m_synchronization2 = m_driver.enabled_features().Synchronization2;
+
+        command_buffer_properties properties = {
+            vk_physical_driver::physical_driver().get_queue_indices().Graphics,
+            command_buffer_levels::Primary,
+            VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        };
+
+        m_command_buffer = vk_command_buffer(properties);
+    }
+
+    void vk_upload_batch::add(const image_data& p_image,
+                              VkFormat p_format,
+                              const void* p_pixels,
+                              uint32_t p_mip_level,
+                              uint32_t p_array_layer) {
+        // the staging buffers of the submission in flight are still read
+        wait();
+
+        // host image copies need no staging memory or recorded commands
+        if (copy_memory_to_image(
+              p_image, p_format, p_pixels, p_mip_level, p_array_layer)) {
+            return;
+        }
+
+        if (!vk_staging_pool::has_pool_context()) {
+            console_log_error("vk_upload_batch: no vk_staging_pool exists, "
+                              "the image is left empty!!!");
+            return;
+        }
+
+        uint32_t width = std::max(p_image.Width >> p_mip_level, 1u);
+        uint32_t height = std::max(p_image.Height >> p_mip_level, 1u);
+        uint32_t image_size =
+          width * height * bytes_per_texture_format(p_format);
+
+        buffer_properties staging =
+          vk_staging_pool::pool_context().acquire(image_size);
+        write(staging, p_pixels, image_size);
+
+        image_upload upload = { .Image = p_image.Image,
+                                .Format = p_format,
+                                .Width = width,
+                                .Height = height,
+                                .MipLevel = p_mip_level,
+                                .ArrayLayer = p_array_layer,
+                                .Staging = staging.BufferHandler };
+
+        m_uploads.push_back(upload);
+        m_staging_buffers.push_back(staging);
+    }
+
+    void vk_upload_batch::copy(const image_data& p_source,
+                               uint32_t p_source_mip,
+                               const image_data& p_destination,
+                               uint32_t p_destination_mip) {
+        wait();
+
+        image_copy copy = {
+            .Source = p_source.Image,
+            .SourceMip = p_source_mip,
+            .Destination = p_destination.Image,
+            .DestinationMip = p_destination_mip,
+            .Width = std::max(p_destination.Width >> p_destination_mip, 1u),
+            .Height = std::max(p_destination.Height >> p_destination_mip, 1u)
+        };
+        m_copies.push_back(copy);
+    }
+
+    //! @note Barrier for one mip of a color image
+    static VkImageMemoryBarrier2 mip_barrier(VkImage p_image,
+                                             uint32_t p_mip,
+                                             VkImageLayout p_old,
+                                             VkImageLayout p_new) {
+        VkImageMemoryBarrier2 barrier = image_memory_barrier2(
+          p_image, VK_FORMAT_UNDEFINED, p_old, p_new);
+        barrier.subresourceRange.baseMipLevel = p_mip;
+        barrier.subresourceRange.levelCount = 1;
+        return barrier;
+    }
+
+    void vk_upload_batch::record() {
+        console_log_trace("vk_upload_batch::submit uploading {} images, "
+                          "copying {} mips",
+                          m_uploads.size(),
+                          m_copies.size());
+
+        m_command_buffer.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+        // 1. transition all images to be copy destinations in one batch
+        std::vector<VkImageMemoryBarrier2> barriers;
+        barriers.reserve(m_uploads.size());
+        for (const image_upload& upload : m_uploads) {
+            barriers.push_back(
+              image_memory_barrier2(upload.Image,
+                                    upload.Format,
+                                    VK_IMAGE_LAYOUT_UNDEFINED,
+                                    VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
+            barriers.back().subresourceRange.baseMipLevel = upload.MipLevel;
+            barriers.back().subresourceRange.levelCount = 1;
+            barriers.back().subresourceRange.baseArrayLayer = upload.ArrayLayer;
+            barriers.back().subresourceRange.layerCount = 1;
+        }
+        for (const image_copy& copy : m_copies) {
+            barriers.push_back(
+              mip_barrier(copy.Source,
+                          copy.SourceMip,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL));
+            barriers.push_back(
+              mip_barrier(copy.Destination,
+                          copy.DestinationMip,
+                          VK_IMAGE_LAYOUT_UNDEFINED,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL));
+        }
+
+        record_barriers(m_command_buffer, barriers, m_synchronization2);
+
+        // 2. copy staging buffers and source images to their images
+        for (const image_upload& upload : m_uploads) {
+            VkBufferImageCopy buffer_image_copy = {
+                .bufferOffset = 0,
+                .bufferRowLength = 0,
+                .bufferImageHeight = 0,
+                .imageSubresource = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                      .mipLevel = upload.MipLevel,
+                                      .baseArrayLayer = upload.ArrayLayer,
+                                      .layerCount = 1 },
+                .imageOffset = { .x = 0, .y = 0, .z = 0 },
+                .imageExtent = { .width = upload.Width,
+                                 .height = upload.Height,
+                                 .depth = 1 }
+            };
+
+            vkCmdCopyBufferToImage(m_command_buffer,
+                                   upload.Staging,
+                                   upload.Image,
+                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   1,
+                                   &buffer_image_copy);
+        }
+
+        for (const image_copy& copy : m_copies) {
+            VkImageCopy image_copy = {
+                .srcSubresource = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                    .mipLevel = copy.SourceMip,
+                                    .baseArrayLayer = 0,
+                                    .layerCount = 1 },
+                .srcOffset = { .x = 0, .y = 0, .z = 0 },
+                .dstSubresource = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                                    .mipLevel = copy.DestinationMip,
+                                    .baseArrayLayer = 0,
+                                    .layerCount = 1 },
+                .dstOffset = { .x = 0, .y = 0, .z = 0 },
+                .extent = { .width = copy.Width,
+                            .height = copy.Height,
+                            .depth = 1 }
+            };
+
+            vkCmdCopyImage(m_command_buffer,
+                           copy.Source,
+                           VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           copy.Destination,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           1,
+                           &image_copy);
+        }
+
+        // 3. transition all images to be sampled by shaders in one batch
+        barriers.clear();
+        for (const image_upload& upload : m_uploads) {
+            barriers.push_back(image_memory_barrier2(
+              upload.Image,
+              upload.Format,
+              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+              VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+            barriers.back().subresourceRange.baseMipLevel = upload.MipLevel;
+            barriers.back().subresourceRange.levelCount = 1;
+            barriers.back().subresourceRange.baseArrayLayer = upload.ArrayLayer;
+            barriers.back().subresourceRange.layerCount = 1;
+        }
+        for (const image_copy& copy : m_copies) {
+            barriers.push_back(
+              mip_barrier(copy.Source,
+                          copy.SourceMip,
+                          VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+            barriers.push_back(
+              mip_barrier(copy.Destination,
+                          copy.DestinationMip,
+                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL));
+        }
+        record_barriers(m_command_buffer, barriers, m_synchronization2);
+
+        m_command_buffer.end();
+    }
+
+    // 4. single submission for the whole group of images
+    void vk_upload_batch::submit_commands(VkFence p_fence) {
+        if (m_synchronization2) {
+            VkCommandBufferSubmitInfo command_buffer_info = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+                .pNext = nullptr,
+                .commandBuffer = m_command_buffer,
+                .deviceMask = 0
+            };
+
+            VkSubmitInfo2 submit_info = {
+                .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+                .pNext = nullptr,
+                .flags = 0,
+                .waitSemaphoreInfoCount = 0,
+                .pWaitSemaphoreInfos = nullptr,
+                .commandBufferInfoCount = 1,
+                .pCommandBufferInfos = &command_buffer_info,
+                .signalSemaphoreInfoCount = 0,
+                .pSignalSemaphoreInfos = nullptr
+            };
+
+            vk_check(
+              vkQueueSubmit2(m_graphics_queue, 1, &submit_info, p_fence),
+              "vkQueueSubmit2",
+              __FUNCTION__);
+        }
+        else {
+            VkCommandBuffer command_buffer = m_command_buffer;
+            VkSubmitInfo submit_info = {
+                .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+                .pNext = nullptr,
+                .waitSemaphoreCount = 0,
+                .pWaitSemaphores = nullptr,
+                .pWaitDstStageMask = nullptr,
+                .commandBufferCount = 1,
+                .pCommandBuffers = &command_buffer,
+                .signalSemaphoreCount = 0,
+                .pSignalSemaphores = nullptr
+            };
+
+            vk_check(
+              vkQueueSubmit(m_graphics_queue, 1, &submit_info, p_fence),
+              "vkQueueSubmit",
+              __FUNCTION__);
+        }
+    }
+
+    void vk_upload_batch::submit() {
+        submit_async();
+        wait();
+    }
+
+    void vk_upload_batch::submit_async() {
+        if (empty()) {
+            return;
+        }
+
+        wait();
+        record();
+
+        if (m_fence == nullptr) {
+            VkFenceCreateInfo fence_ci = {
+                .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+                .pNext = nullptr,
+                .flags = 0
+            };
+            vk_check(vkCreateFence(m_driver, &fence_ci, nullptr, &m_fence),
+                     "vkCreateFence",
+                     __FUNCTION__);
+        }
+
+        submit_commands(m_fence);
+        m_in_flight = true;
+
+        // the staging buffers stay with the batch until the fence signals
+        m_uploads.clear();
+        m_copies.clear();
+    }
+
+    bool vk_upload_batch::is_complete() {
+        if (!m_in_flight) {
+            return true;
+        }
+
+        if (vkGetFenceStatus(m_driver, m_fence) != VK_SUCCESS) {
+            return false;
+        }
+
+        vk_check(vkResetFences(m_driver, 1, &m_fence),
+                 "vkResetFences",
+                 __FUNCTION__);
+        if (!m_staging_buffers.empty()) {
+            vk_staging_pool::pool_context().release(m_staging_buffers);
+            m_staging_buffers.clear();
+        }
+        m_in_flight = false;
+        return true;
+    }
+
+    void vk_upload_batch::wait() {
+        if (!m_in_flight) {
+            return;
+        }
+
+        vk_check(vkWaitForFences(m_driver, 1, &m_fence, true, UINT64_MAX),
+                 "vkWaitForFences",
+                 __FUNCTION__);
+        is_complete();
+    }
+
+    void vk_upload_batch::destroy() {
+        wait();
+
+        if (m_fence != nullptr) {
+            vkDestroyFence(m_driver, m_fence, nullptr);
+            m_fence = nullptr;
+        }
+        m_command_buffer.destroy();
+    }
+};
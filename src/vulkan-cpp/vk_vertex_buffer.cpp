@@ -23,6 +23,12 @@ namespace vk {
         //! buffer by descriptor set
         VkBufferUsageFlags usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT |
                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+
+        // descriptor buffers reference the storage binding by its device
+        // address
+        if (vk_driver::driver_context().enabled_features().DescriptorBuffer) {
+            usage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+        }
         // VkBufferUsageFlags usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
         VkMemoryPropertyFlags memory_property_flags =
           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
@@ -36,7 +42,7 @@ namespace vk {
 
 
         // m_vertex_data = create_buffer(m_vertices_byte_size_count, usage, memory_property_flags);
-        m_vertex_data = create_buffer(m_vertices_byte_size_count, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        m_vertex_data = create_buffer(m_vertices_byte_size_count, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
         // copy data from staging buffer into vertex buffer
         copy(staging_buffer, m_vertex_data, (uint32_t)p_vertices.size_bytes());
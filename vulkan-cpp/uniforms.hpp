@@ -8,6 +8,17 @@ struct camera_data_uniform {
     glm::mat4 View{ 1.f };
 };
 
+//! @note Per-frame data shared by every object (descriptor set 0)
+struct global_frame_uniform {
+    glm::mat4 ViewProjection{ 1.f };
+};
+
+//! @note Per-object data that goes through push constants instead of a
+//! uniform buffer, see shaders/shader.vert
+struct object_push_constants {
+    glm::mat4 Model{ 1.f };
+};
+
 struct camera_data_uniform2 {
     glm::mat4 Model{ 1.f };
     glm::mat4 Projection{ 1.f };
@@ -0,0 +1,127 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+#include <vulkan-cpp/vk_driver.hpp>
+#include <vulkan-cpp/vk_texture.hpp>
+#include <vulkan-cpp/vk_descriptor_cache.hpp>
+#include <vulkan-cpp/uniforms.hpp>
+
+namespace vk {
+
+    //! @note Push constant block read by shaders/bindless.frag. Sits right
+    //! after the vertex stage's object_push_constants
+    struct bindless_draw_constants {
+        static constexpr uint32_t Offset = sizeof(object_push_constants);
+
+        uint32_t TextureIndex = 0;
+    };
+
+    /*
+
+        vk_bindless_texture_table
+            - One descriptor set holding a large UPDATE_AFTER_BIND +
+       PARTIALLY_BOUND array of combined image samplers, bound once and shared
+       by every draw
+            - Textures are registered once and get a stable index into that
+       array, shaders pick the texture with the index from a push constant (or
+       a material buffer), so switching textures never rebinds descriptors
+            - Removed indices are only handed out again after
+       MaxFramesInFlight calls to begin_frame(), so frames still in flight
+       never see their slot rewritten under them
+
+        Usage
+
+        vk_bindless_texture_table textures(layout_cache);
+        uint32_t bricks = textures.add(bricks_texture);
+        ...
+        textures.bind(command_buffer, pipeline_layout, 1);
+        bindless_draw_constants constants = { .TextureIndex = bricks };
+        pipeline.push_constants(command_buffer,
+                                VK_SHADER_STAGE_FRAGMENT_BIT,
+                                constants,
+                                bindless_draw_constants::Offset);
+    */
+    class vk_bindless_texture_table {
+        struct retired_index {
+            uint32_t Index = 0;
+            uint64_t Frame = 0;
+        };
+
+    public:
+        static constexpr uint32_t DefaultCapacity = 4096;
+        static constexpr uint32_t InvalidIndex = UINT32_MAX;
+        static constexpr uint32_t TextureBinding = 0;
+
+        vk_bindless_texture_table() = default;
+        //! @note p_capacity is clamped to the device update-after-bind limits
+        vk_bindless_texture_table(vk_descriptor_layout_cache& p_layout_cache,
+                                  uint32_t p_capacity = DefaultCapacity);
+
+        //! @note Returns InvalidIndex when the table is full
+        uint32_t add(const vk_texture& p_texture);
+
+        uint32_t add(VkImageView p_image_view, VkSampler p_sampler);
+
+        //! @note Points p_index at a different image while keeping the index,
+        //! ie when a streamed texture changes its resident mip chain. Only
+        //! valid while no pending command buffer samples p_index
+        void replace(uint32_t p_index,
+                     VkImageView p_image_view,
+                     VkSampler p_sampler);
+
+        //! @note Ignores (and logs) indices that are not in use, so removing
+        //! twice never frees a slot another texture got in the meantime
+        void remove(uint32_t p_index);
+
+        //! @note Whether p_index was handed out by add() and not removed since
+        bool is_live(uint32_t p_index) const {
+            return p_index < m_live.size() and m_live[p_index];
+        }
+
+        //! @note Recycles indices that were removed MaxFramesInFlight frames
+        //! ago. Call once per frame after waiting on the frame's fence
+        void begin_frame();
+
+        void bind(const VkCommandBuffer& p_command_buffer,
+                  VkPipelineLayout p_pipeline_layout,
+                  uint32_t p_set = 0);
+
+        //! @note Range to pass when creating pipelines that use
+        //! bindless_draw_constants
+        static VkPushConstantRange push_constant_range() {
+            return { .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+                     .offset = bindless_draw_constants::Offset,
+                     .size = sizeof(bindless_draw_constants) };
+        }
+
+        VkDescriptorSetLayout get_layout() const { return m_layout; }
+
+        uint32_t capacity() const { return m_capacity; }
+
+        uint32_t size() const { return m_size; }
+
+        bool is_valid() const { return m_descriptor_set != nullptr; }
+
+        void destroy();
+
+    private:
+        void write(uint32_t p_index,
+                   VkImageView p_image_view,
+                   VkSampler p_sampler);
+
+    private:
+        VkDevice m_driver = nullptr;
+        VkDescriptorPool m_descriptor_pool = nullptr;
+        VkDescriptorSetLayout m_layout = nullptr;
+        VkDescriptorSet m_descriptor_set = nullptr;
+        uint32_t m_capacity = 0;
+        uint32_t m_size = 0;
+        uint32_t m_next_index = 0;
+        uint64_t m_frame = 0;
+        std::vector<uint32_t> m_free_indices;
+        std::vector<retired_index> m_retired_indices;
+        //! @note One bit per slot, set from add() until remove()
+        std::vector<bool> m_live;
+    };
+};
@@ -16,6 +16,9 @@ namespace vk {
         VkDeviceMemory DeviceMemory = nullptr;
         uint32_t Width = 0;
         uint32_t Height = 0;
+        uint32_t MipLevels = 1;
+        uint32_t ArrayLayers = 1;
+        VkImageUsageFlags Usage = 0;
     };
 
     struct texture_properties {
@@ -23,6 +23,32 @@ namespace vk {
         VkCommandPoolCreateFlagBits PoolFlags;
     };
 
+    /*
+
+        Push descriptors (VK_KHR_push_descriptor)
+            - Write a single binding of set p_set inline while recording, so
+       small per-draw resources never allocate a descriptor set or go through
+       vkUpdateDescriptorSets
+            - Set p_set of p_pipeline_layout must have been created with
+       VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR
+            - Requires device_features::PushDescriptor, without it an error
+       is logged and nothing is written, allocate a vk_descriptor_set instead
+    */
+    void push_uniform_buffer(const VkCommandBuffer& p_command_buffer,
+                             VkPipelineLayout p_pipeline_layout,
+                             uint32_t p_set,
+                             uint32_t p_binding,
+                             VkBuffer p_buffer,
+                             VkDeviceSize p_offset,
+                             VkDeviceSize p_range);
+
+    void push_image_sampler(const VkCommandBuffer& p_command_buffer,
+                            VkPipelineLayout p_pipeline_layout,
+                            uint32_t p_set,
+                            uint32_t p_binding,
+                            VkImageView p_image_view,
+                            VkSampler p_sampler);
+
     /*
 
         Wrapper around vulkan's command buffer use
@@ -0,0 +1,73 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+#include <span>
+#include <vulkan-cpp/vk_driver.hpp>
+
+namespace vk {
+
+    //! @note Descriptors of p_type reserved per descriptor set in every pool
+    struct descriptor_pool_ratio {
+        VkDescriptorType Type;
+        float Ratio = 1.f;
+    };
+
+    /*
+
+        vk_descriptor_allocator
+            - Hands out descriptor sets from a list of pools, rather than one
+       fixed pool sized for exactly the sets that were known up front
+            - When the current pool returns VK_ERROR_OUT_OF_POOL_MEMORY (or
+       VK_ERROR_FRAGMENTED_POOL) it is marked full and allocation retries on a
+       new pool, each new pool being larger than the last
+            - Sets are never freed one by one. reset() calls
+       vkResetDescriptorPool on every pool, which releases all sets at once and
+       keeps the pools around for reuse
+
+        Usage
+
+        vk_descriptor_allocator allocator = vk_descriptor_allocator();
+        VkDescriptorSet material_set = allocator.allocate(material_layout);
+        ...
+        allocator.reset(); // every set allocated from it is now invalid
+    */
+    class vk_descriptor_allocator {
+    public:
+        static constexpr uint32_t DefaultSetsPerPool = 64;
+        static constexpr uint32_t MaxSetsPerPool = 4096;
+
+        vk_descriptor_allocator() = default;
+        vk_descriptor_allocator(
+          uint32_t p_sets_per_pool,
+          std::span<const descriptor_pool_ratio> p_ratios = {});
+
+        VkDescriptorSet allocate(VkDescriptorSetLayout p_layout);
+
+        //! @note Allocates p_sets.size() sets that all share p_layout
+        void allocate(VkDescriptorSetLayout p_layout,
+                      std::span<VkDescriptorSet> p_sets);
+
+        //! @note Releases every set allocated so far in O(pools)
+        void reset();
+
+        void destroy();
+
+    private:
+        void allocate_sets(const VkDescriptorSetLayout* p_layouts,
+                           uint32_t p_count,
+                           VkDescriptorSet* p_sets);
+
+        VkDescriptorPool acquire_pool();
+
+        VkDescriptorPool create_pool(uint32_t p_set_count);
+
+    private:
+        VkDevice m_driver = nullptr;
+        uint32_t m_sets_per_pool = DefaultSetsPerPool;
+        std::vector<descriptor_pool_ratio> m_ratios;
+        VkDescriptorPool m_current_pool = nullptr;
+        std::vector<VkDescriptorPool> m_ready_pools;
+        std::vector<VkDescriptorPool> m_full_pools;
+    };
+};
@@ -0,0 +1,102 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <array>
+#include <span>
+#include <vulkan-cpp/vk_descriptor_cache.hpp>
+
+namespace vk {
+
+    /*
+
+        Descriptor set frequencies
+            - Every pipeline layout follows the same convention, sets are
+       ordered by how often their contents change
+            - GLOBAL (set 0): per-frame data such as the camera, bound once
+       per frame
+            - MATERIAL (set 1): textures and material parameters, bound when
+       the material changes
+            - OBJECT (set 2): per-object or dynamic data, bound per draw
+            - Because pipelines only differ in the higher sets, switching
+       pipelines keeps the lower sets bound
+    */
+    enum descriptor_frequency : uint8_t {
+        GLOBAL = 0,
+        MATERIAL = 1,
+        OBJECT = 2
+    };
+
+    static constexpr uint32_t DescriptorFrequencyCount = 3;
+
+    //! @note Set layouts for each frequency, a null entry means the pipeline
+    //! does not use that set
+    struct frequency_set_layouts {
+        VkDescriptorSetLayout Global = nullptr;
+        VkDescriptorSetLayout Material = nullptr;
+        VkDescriptorSetLayout Object = nullptr;
+    };
+
+    //! @note Returns the set layouts in set order. Unused frequencies are
+    //! filled with the cache's empty layout, since pipeline layouts cannot
+    //! have holes between sets
+    std::array<VkDescriptorSetLayout, DescriptorFrequencyCount>
+    resolve_set_layouts(vk_descriptor_layout_cache& p_layout_cache,
+                        const frequency_set_layouts& p_layouts);
+
+    /*
+
+        vk_descriptor_binder
+            - Tracks which descriptor set is bound to each frequency while
+       recording a command buffer, and skips vkCmdBindDescriptorSets when the
+       set (and its dynamic offsets) is already bound
+            - When the pipeline layout changes, only the sets that are no
+       longer compatible with the new layout get rebound
+
+        Usage
+
+        vk_descriptor_binder binder;
+        binder.begin(command_buffer);
+        binder.bind(pipeline_layout, GLOBAL, frame_set);
+        for (draw : draws) {
+            binder.bind(draw.PipelineLayout, MATERIAL, draw.MaterialSet);
+            binder.bind(draw.PipelineLayout, OBJECT, object_set, offsets);
+            ...
+        }
+    */
+    class vk_descriptor_binder {
+    public:
+        static constexpr uint32_t MaxDynamicOffsets = 4;
+
+        vk_descriptor_binder() = default;
+
+        //! @note Forgets every bound set, call at the start of recording
+        void begin(const VkCommandBuffer& p_command_buffer);
+
+        void bind(VkPipelineLayout p_pipeline_layout,
+                  descriptor_frequency p_frequency,
+                  VkDescriptorSet p_descriptor_set,
+                  std::span<const uint32_t> p_dynamic_offsets = {});
+
+        //! @note Number of vkCmdBindDescriptorSets issued since begin()
+        uint32_t binds() const { return m_binds; }
+
+        //! @note Number of redundant binds skipped since begin()
+        uint32_t skipped() const { return m_skipped; }
+
+    private:
+        struct bound_set {
+            VkDescriptorSet DescriptorSet = nullptr;
+            std::array<uint32_t, MaxDynamicOffsets> DynamicOffsets{};
+            uint32_t DynamicOffsetCount = 0;
+        };
+
+        void use_pipeline_layout(VkPipelineLayout p_pipeline_layout);
+
+    private:
+        VkCommandBuffer m_command_buffer = nullptr;
+        VkPipelineLayout m_pipeline_layout = nullptr;
+        std::array<bound_set, DescriptorFrequencyCount> m_bound_sets{};
+        uint32_t m_binds = 0;
+        uint32_t m_skipped = 0;
+    };
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vulkan-cpp/vk_buffer.hpp>
+#include <vulkan-cpp/vk_driver.hpp>
+
+namespace vk {
+
+    /*
+
+        vk_descriptor_buffer
+            - One host-visible VK_EXT_descriptor_buffer that every descriptor
+       set of the descriptor buffer backend suballocates its sets from
+            - bind() binds it once per command buffer at buffer index
+       BufferIndex, sets then only select their region with
+       vkCmdSetDescriptorBufferOffsetsEXT, which is the cheap part of the
+       extension. Rebinding descriptor buffers is what it is meant to avoid
+            - Regions are handed out linearly and only come back with
+       destroy(), sets are expected to live as long as the buffer
+
+        Usage
+
+        vk_descriptor_buffer descriptor_buffer(64 * 1024);
+        vk_descriptor_set material_set(descriptor_buffer, 1, material_layout);
+        ...
+        // once per command buffer, before binding any of its sets
+        descriptor_buffer.bind(command_buffer);
+        material_set.bind(command_buffer, 0, pipeline_layout, MATERIAL);
+    */
+    class vk_descriptor_buffer {
+    public:
+        //! @note The only descriptor buffer bound, so it is always index 0
+        static constexpr uint32_t BufferIndex = 0;
+
+        vk_descriptor_buffer() = default;
+        //! @note Requires device_features::DescriptorBuffer
+        vk_descriptor_buffer(uint32_t p_size_in_bytes);
+
+        //! @note Returns the offset of a region of p_size_in_bytes aligned to
+        //! descriptorBufferOffsetAlignment, or UINT64_MAX when the buffer is
+        //! full
+        VkDeviceSize allocate(VkDeviceSize p_size_in_bytes);
+
+        //! @note Host pointer to p_offset, the buffer stays mapped
+        uint8_t* mapped(VkDeviceSize p_offset) const {
+            return m_mapped + p_offset;
+        }
+
+        void bind(const VkCommandBuffer& p_command_buffer) const;
+
+        bool is_valid() const { return m_buffer.BufferHandler != nullptr; }
+
+        VkDeviceSize used_bytes() const { return m_used; }
+
+        void destroy();
+
+    private:
+        VkDevice m_driver = nullptr;
+        buffer_properties m_buffer{};
+        uint8_t* m_mapped = nullptr;
+        VkDeviceAddress m_address = 0;
+        VkBufferUsageFlags m_usage = 0;
+        VkDeviceSize m_alignment = 1;
+        VkDeviceSize m_used = 0;
+    };
+};
@@ -0,0 +1,170 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+#include <span>
+#include <unordered_map>
+#include <vulkan-cpp/vk_driver.hpp>
+#include <vulkan-cpp/vk_descriptor_allocator.hpp>
+
+namespace vk {
+
+    /*
+
+        vk_descriptor_layout_cache
+            - Dedupes VkDescriptorSetLayout's by their binding list, so two
+       materials that declare the same bindings share one layout handle
+            - Dedupes VkPipelineLayout's by their set layouts and push constant
+       ranges, so pipelines built from the same layouts share one pipeline
+       layout and stay compatible for descriptor binds
+            - Owns every handle it returns, they are destroyed by destroy()
+
+        Usage
+
+        std::array<VkDescriptorSetLayoutBinding, 2> bindings = { ... };
+        VkDescriptorSetLayout layout = layout_cache.create_layout(bindings);
+        VkPipelineLayout pipeline_layout =
+            layout_cache.create_pipeline_layout({ &layout, 1 });
+    */
+    class vk_descriptor_layout_cache {
+        struct layout_key {
+            VkDescriptorSetLayoutCreateFlags Flags = 0;
+            //! @note Kept sorted by binding, so the order bindings were
+            //! declared in does not matter
+            std::vector<VkDescriptorSetLayoutBinding> Bindings;
+            //! @note Empty, or one entry per binding in the order of Bindings
+            std::vector<VkDescriptorBindingFlags> BindingFlags;
+
+            bool operator==(const layout_key& p_other) const;
+        };
+
+        struct layout_key_hash {
+            size_t operator()(const layout_key& p_key) const;
+        };
+
+        struct pipeline_layout_key {
+            std::vector<VkDescriptorSetLayout> SetLayouts;
+            std::vector<VkPushConstantRange> PushConstants;
+
+            bool operator==(const pipeline_layout_key& p_other) const;
+        };
+
+        struct pipeline_layout_key_hash {
+            size_t operator()(const pipeline_layout_key& p_key) const;
+        };
+
+    public:
+        vk_descriptor_layout_cache();
+
+        //! @note p_binding_flags is either empty or has one entry per binding
+        //! (ie UPDATE_AFTER_BIND / PARTIALLY_BOUND for bindless arrays)
+        VkDescriptorSetLayout create_layout(
+          std::span<const VkDescriptorSetLayoutBinding> p_bindings,
+          VkDescriptorSetLayoutCreateFlags p_flags = 0,
+          std::span<const VkDescriptorBindingFlags> p_binding_flags = {});
+
+        VkPipelineLayout create_pipeline_layout(
+          std::span<const VkDescriptorSetLayout> p_set_layouts,
+          std::span<const VkPushConstantRange> p_push_constants = {});
+
+        //! @note Bindings p_layout was created with, sorted by binding
+        std::span<const VkDescriptorSetLayoutBinding> bindings(
+          VkDescriptorSetLayout p_layout) const;
+
+        //! @note True when descriptor sets bound for set p_set (and every
+        //! set below it) stay valid when switching between the two pipeline
+        //! layouts, which Vulkan guarantees for identical push constant
+        //! ranges and identical set layouts up to p_set
+        bool is_compatible(VkPipelineLayout p_a,
+                           VkPipelineLayout p_b,
+                           uint32_t p_set) const;
+
+        //! @note Create flags p_layout was created with
+        VkDescriptorSetLayoutCreateFlags layout_flags(
+          VkDescriptorSetLayout p_layout) const;
+
+        //! @note The cache created last. Check has_layout_cache() first when
+        //! one may not exist yet
+        static vk_descriptor_layout_cache& layout_cache();
+
+        static bool has_layout_cache() { return s_instance != nullptr; }
+
+        void destroy();
+
+    private:
+        static vk_descriptor_layout_cache* s_instance;
+        VkDevice m_driver = nullptr;
+        std::unordered_map<layout_key, VkDescriptorSetLayout, layout_key_hash>
+          m_layouts;
+        std::unordered_map<VkDescriptorSetLayout, layout_key> m_layout_keys;
+        std::unordered_map<pipeline_layout_key,
+                           VkPipelineLayout,
+                           pipeline_layout_key_hash>
+          m_pipeline_layouts;
+        std::unordered_map<VkPipelineLayout, pipeline_layout_key>
+          m_pipeline_layout_keys;
+    };
+
+    //! @note A single resource written to a binding of a cached descriptor
+    //! set. Buffers fill Buffer/Offset/Range, images fill ImageView/Sampler
+    struct descriptor_resource {
+        uint32_t Binding = 0;
+        VkDescriptorType Type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        VkBuffer Buffer = nullptr;
+        VkDeviceSize Offset = 0;
+        VkDeviceSize Range = VK_WHOLE_SIZE;
+        VkImageView ImageView = nullptr;
+        VkSampler Sampler = nullptr;
+        VkImageLayout ImageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        bool operator==(const descriptor_resource& p_other) const;
+    };
+
+    /*
+
+        vk_descriptor_set_cache
+            - Returns the same VkDescriptorSet every time the same layout gets
+       requested with the same resources, so repeated materials reuse their set
+       instead of allocating and rewriting a new one
+            - Sets come from a vk_descriptor_allocator. After that allocator is
+       reset every cached set is invalid, so clear() has to be called with it
+    */
+    class vk_descriptor_set_cache {
+        struct set_key {
+            VkDescriptorSetLayout Layout = nullptr;
+            std::vector<descriptor_resource> Resources;
+
+            bool operator==(const set_key& p_other) const;
+        };
+
+        struct set_key_hash {
+            size_t operator()(const set_key& p_key) const;
+        };
+
+    public:
+        vk_descriptor_set_cache() = default;
+        vk_descriptor_set_cache(vk_descriptor_allocator& p_allocator);
+
+        VkDescriptorSet get(VkDescriptorSetLayout p_layout,
+                            std::span<const descriptor_resource> p_resources);
+
+        void clear() { m_sets.clear(); }
+
+        size_t size() const { return m_sets.size(); }
+
+        uint64_t hits() const { return m_hits; }
+
+        uint64_t misses() const { return m_misses; }
+
+    private:
+        void write(VkDescriptorSet p_set,
+                   std::span<const descriptor_resource> p_resources);
+
+    private:
+        VkDevice m_driver = nullptr;
+        vk_descriptor_allocator* m_allocator = nullptr;
+        std::unordered_map<set_key, VkDescriptorSet, set_key_hash> m_sets;
+        uint64_t m_hits = 0;
+        uint64_t m_misses = 0;
+    };
+};
@@ -5,6 +5,10 @@
 #include <vulkan-cpp/vk_vertex_buffer.hpp>
 #include <vulkan-cpp/vk_uniform_buffer.hpp>
 #include <vulkan-cpp/vk_texture.hpp>
+#include <vulkan-cpp/vk_descriptor_allocator.hpp>
+#include <vulkan-cpp/vk_descriptor_cache.hpp>
+#include <vulkan-cpp/vk_descriptor_template.hpp>
+#include <vulkan-cpp/vk_descriptor_buffer.hpp>
 #include <renderer/mesh.hpp>
 #include <vulkan-cpp/vk_vertex_buffer.hpp>
 
@@ -123,24 +127,63 @@ namespace vk {
           uint32_t p_descriptor_count,
           const std::initializer_list<VkDescriptorSetLayoutBinding>& p_layouts);
 
+        //! @note Allocates the sets from p_allocator instead of creating a
+        //! pool sized for exactly p_descriptor_count sets
+        vk_descriptor_set(
+          vk_descriptor_allocator& p_allocator,
+          uint32_t p_descriptor_count,
+          const std::initializer_list<VkDescriptorSetLayoutBinding>& p_layouts);
+
+        //! @note Uses an existing layout (ie from vk_descriptor_layout_cache)
+        //! that this descriptor set does not take ownership of
+        vk_descriptor_set(vk_descriptor_allocator& p_allocator,
+                          uint32_t p_descriptor_count,
+                          VkDescriptorSetLayout p_layout);
+
+        //! @note Push descriptor backend, p_layout has to be created with
+        //! VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR. Nothing is
+        //! allocated, bind() pushes the bindings inline with
+        //! vkCmdPushDescriptorSetKHR. Requires device_features::PushDescriptor
+        vk_descriptor_set(uint32_t p_descriptor_count,
+                          VkDescriptorSetLayout p_layout);
+
+        //! @note Descriptor buffer backend, p_layout has to be created with
+        //! VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT. The sets
+        //! are written straight into a region of p_descriptor_buffer, which
+        //! has to be bound to the command buffer before bind(). Buffers
+        //! written to them need SHADER_DEVICE_ADDRESS usage and a real range,
+        //! VK_WHOLE_SIZE cannot be resolved into a descriptor
+        vk_descriptor_set(vk_descriptor_buffer& p_descriptor_buffer,
+                          uint32_t p_descriptor_count,
+                          VkDescriptorSetLayout p_layout);
+
         //! @note Does cleanup for descriptor set
         void destroy();
 
+        //! @note p_set is the set number in p_pipeline_layout the
+        //! descriptors are bound, pushed or offset at, see
+        //! descriptor_frequency
         void bind(const VkCommandBuffer& p_command_buffer,
                   uint32_t p_frame_index,
-                  const VkPipelineLayout& p_pipeline_layout);
+                  const VkPipelineLayout& p_pipeline_layout,
+                  uint32_t p_set = 0);
 
         // Updating specific groups of descriptor sets
         //! @note Reason these are getting called for every descriptor set
         //! @note Its because they need to be applied when doing camera
         //! transforms, etc.
+        //! @note Each set is written through a descriptor update template
+        //! once all of its bindings have been provided
         void update_uniforms(
           const std::span<vk_uniform_buffer>& p_uniform_buffer);
         void update_vertex(const vk_vertex_buffer& p_vertex_buffer);
         void update_texture(const vk_texture* p_texture);
 
         // void update_test_descriptors(const std::initializer_list<VkWriteDescriptorSet>& p_write_descriptors);
-        void update_test_descriptors(const std::span<vk_uniform_buffer>& p_uniforms, vk_vertex_buffer& p_vertex, vk_texture& p_texture);
+        void update_test_descriptors(
+          const std::span<vk_uniform_buffer>& p_uniforms,
+          vk_vertex_buffer& p_vertex,
+          vk_texture& p_texture);
 
         VkDescriptorPool get_pool() const { return m_descriptor_pool; }
         VkDescriptorSetLayout get_layout() const {
@@ -153,11 +196,41 @@ namespace vk {
             return m_descriptor_sets[p_index];
         }
 
+    private:
+        void create_layout(
+          const std::initializer_list<VkDescriptorSetLayoutBinding>& p_layouts);
+
+        void create_update_template(
+          std::span<const VkDescriptorSetLayoutBinding> p_bindings);
+
+        void flush(size_t p_index);
+
+        void create_descriptor_buffer(
+          vk_descriptor_buffer& p_descriptor_buffer);
+
+        void write_descriptor_buffer(size_t p_index);
+
+        void push_descriptors(const VkCommandBuffer& p_command_buffer,
+                              const VkPipelineLayout& p_pipeline_layout,
+                              size_t p_index,
+                              uint32_t p_set);
+
     private:
         uint32_t m_descriptor_count = 0;
         VkDevice m_driver = nullptr;
+        bool m_owns_layout = true;
+        bool m_push_descriptors = false;
         VkDescriptorPool m_descriptor_pool = nullptr;
         VkDescriptorSetLayout m_descriptor_set_layout = nullptr;
         std::vector<VkDescriptorSet> m_descriptor_sets;
+        vk_descriptor_update_template m_update_template;
+        std::vector<descriptor_template_data> m_template_data;
+
+        // only used by the descriptor buffer backend, the sets take up
+        // m_descriptor_count strides starting at m_descriptor_buffer_offset
+        vk_descriptor_buffer* m_descriptor_buffer = nullptr;
+        VkDeviceSize m_descriptor_buffer_offset = 0;
+        VkDeviceSize m_set_stride = 0;
+        std::vector<VkDeviceSize> m_binding_offsets;
     };
 };
\ No newline at end of file
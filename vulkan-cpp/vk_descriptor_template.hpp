@@ -0,0 +1,126 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <array>
+#include <span>
+#include <vulkan-cpp/vk_driver.hpp>
+
+namespace vk {
+
+    //! @note One descriptor worth of data inside descriptor_template_data.
+    //! Every entry has the same stride, so a binding can hold either kind
+    union descriptor_template_entry {
+        VkDescriptorBufferInfo Buffer;
+        VkDescriptorImageInfo Image;
+    };
+
+    /*
+
+        descriptor_template_data
+            - Packed, fixed-size block of descriptor infos that
+       vkUpdateDescriptorSetWithTemplate reads directly, so updating a set
+       needs no VkWriteDescriptorSet arrays and no heap allocations
+            - Entries are laid out in the order of the layout bindings (sorted
+       by binding), a binding with descriptorCount > 1 takes that many entries
+    */
+    struct descriptor_template_data {
+        static constexpr uint32_t MaxEntries = 16;
+
+        std::array<descriptor_template_entry, MaxEntries> Entries{};
+        //! @note Bit i is set once Entries[i] has been written
+        uint32_t WrittenMask = 0;
+    };
+
+    //! @note Where the descriptors of one layout binding live inside of
+    //! descriptor_template_data::Entries
+    struct descriptor_template_slot {
+        uint32_t Binding = 0;
+        VkDescriptorType Type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        uint32_t FirstEntry = 0;
+        uint32_t Count = 0;
+    };
+
+    /*
+
+        vk_descriptor_update_template
+            - Builds a VkDescriptorUpdateTemplate from the bindings of a
+       descriptor set layout
+            - update() writes every binding of a set in a single call from a
+       descriptor_template_data
+
+        Usage
+
+        vk_descriptor_update_template update_template(layout, bindings);
+        descriptor_template_data data{};
+        update_template.write_buffer(data, 0, uniform_buffer, 0, size);
+        update_template.write_image(data, 1, image_view, sampler);
+        update_template.update(descriptor_set, data);
+    */
+    class vk_descriptor_update_template {
+    public:
+        vk_descriptor_update_template() = default;
+        //! @note With p_create_template = false only the slot table is built,
+        //! for descriptor buffer layouts that are not written through
+        //! vkUpdateDescriptorSetWithTemplate
+        vk_descriptor_update_template(
+          VkDescriptorSetLayout p_layout,
+          std::span<const VkDescriptorSetLayoutBinding> p_bindings,
+          bool p_create_template = true);
+
+        //! @note Writes a buffer to p_binding (at p_array_element) of p_data
+        void write_buffer(descriptor_template_data& p_data,
+                          uint32_t p_binding,
+                          VkBuffer p_buffer,
+                          VkDeviceSize p_offset = 0,
+                          VkDeviceSize p_range = VK_WHOLE_SIZE,
+                          uint32_t p_array_element = 0) const;
+
+        //! @note Writes an image/sampler pair to p_binding of p_data
+        void write_image(
+          descriptor_template_data& p_data,
+          uint32_t p_binding,
+          VkImageView p_image_view,
+          VkSampler p_sampler,
+          VkImageLayout p_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+          uint32_t p_array_element = 0) const;
+
+        //! @note True once every entry of p_data has been written, the
+        //! template always updates every binding so partial data is invalid.
+        //! Never true for a layout that did not fit
+        bool complete(const descriptor_template_data& p_data) const {
+            return !m_invalid and p_data.WrittenMask == m_entries_mask;
+        }
+
+        //! @note Binding of the first layout binding with p_type, or
+        //! UINT32_MAX if the layout does not have one
+        uint32_t find_binding(VkDescriptorType p_type) const;
+
+        void update(VkDescriptorSet p_set,
+                    const descriptor_template_data& p_data) const;
+
+        std::span<const descriptor_template_slot> slots() const {
+            return { m_slots.data(), m_slot_count };
+        }
+
+        bool is_valid() const {
+            return !m_invalid and m_update_template != nullptr;
+        }
+
+        void destroy();
+
+    private:
+        int32_t entry_index(uint32_t p_binding,
+                            uint32_t p_array_element) const;
+
+    private:
+        VkDevice m_driver = nullptr;
+        VkDescriptorUpdateTemplate m_update_template = nullptr;
+        std::array<descriptor_template_slot,
+                   descriptor_template_data::MaxEntries>
+          m_slots{};
+        uint32_t m_slot_count = 0;
+        uint32_t m_entries_mask = 0;
+        //! @note The layout needs more than MaxEntries descriptors
+        bool m_invalid = false;
+    };
+};
@@ -3,6 +3,95 @@
 #include <vulkan-cpp/vk_physical_driver.hpp>
 
 namespace vk {
+    //! @note Optional device features that were enabled when creating the
+    //! logical device. Check these before using a code path that needs them.
+    struct device_features {
+        bool Synchronization2 = false;
+        bool HostImageCopy = false;
+        //! @note UPDATE_AFTER_BIND + PARTIALLY_BOUND sampled image arrays with
+        //! non-uniform indexing, required by vk_bindless_texture_table
+        bool DescriptorIndexing = false;
+        //! @note VK_EXT_descriptor_buffer together with bufferDeviceAddress
+        bool DescriptorBuffer = false;
+        //! @note VK_KHR_push_descriptor
+        bool PushDescriptor = false;
+        //! @note Core in 1.3, render without VkRenderPass/VkFramebuffer
+        //! objects through vkCmdBeginRendering
+        bool DynamicRendering = false;
+        //! @note Extended dynamic state 1 + 2, core in 1.3: cull mode, front
+        //! face, topology, depth test/write/compare, depth bias and primitive
+        //! restart can be set while recording
+        bool ExtendedDynamicState = false;
+        //! @note VK_EXT_extended_dynamic_state3 with polygon mode and the color
+        //! blend enable/equation/write mask
+        bool ExtendedDynamicState3 = false;
+        //! @note VK_EXT_vertex_input_dynamic_state
+        bool VertexInputDynamicState = false;
+        //! @note VK_EXT_shader_object, only enabled together with dynamic
+        //! rendering. Shader objects take every piece of state from the
+        //! command buffer, which makes the extended dynamic state 3 and
+        //! vertex input commands available to them as well
+        bool ShaderObject = false;
+        //! @note VK_EXT_graphics_pipeline_library, only enabled on devices
+        //! that can link libraries without link time optimization cheaply
+        //! (graphicsPipelineLibraryFastLinking)
+        bool GraphicsPipelineLibrary = false;
+    };
+
+    //! @note VK_EXT_host_image_copy entry points, only loaded when
+    //! device_features::HostImageCopy is enabled
+    struct host_image_copy_dispatch {
+        PFN_vkCopyMemoryToImageEXT CopyMemoryToImage = nullptr;
+        PFN_vkTransitionImageLayoutEXT TransitionImageLayout = nullptr;
+    };
+
+    //! @note VK_EXT_descriptor_buffer entry points, only loaded when
+    //! device_features::DescriptorBuffer is enabled
+    struct descriptor_buffer_dispatch {
+        PFN_vkGetDescriptorSetLayoutSizeEXT GetDescriptorSetLayoutSize =
+          nullptr;
+        PFN_vkGetDescriptorSetLayoutBindingOffsetEXT
+          GetDescriptorSetLayoutBindingOffset = nullptr;
+        PFN_vkGetDescriptorEXT GetDescriptor = nullptr;
+        PFN_vkCmdBindDescriptorBuffersEXT CmdBindDescriptorBuffers = nullptr;
+        PFN_vkCmdSetDescriptorBufferOffsetsEXT CmdSetDescriptorBufferOffsets =
+          nullptr;
+    };
+
+    //! @note VK_KHR_push_descriptor entry points, only loaded when
+    //! device_features::PushDescriptor is enabled
+    struct push_descriptor_dispatch {
+        PFN_vkCmdPushDescriptorSetKHR CmdPushDescriptorSet = nullptr;
+    };
+
+    //! @note VK_EXT_extended_dynamic_state3 and
+    //! VK_EXT_vertex_input_dynamic_state entry points, each only loaded when
+    //! its device_features flag is enabled
+    struct dynamic_state_dispatch {
+        PFN_vkCmdSetPolygonModeEXT CmdSetPolygonMode = nullptr;
+        PFN_vkCmdSetColorBlendEnableEXT CmdSetColorBlendEnable = nullptr;
+        PFN_vkCmdSetColorBlendEquationEXT CmdSetColorBlendEquation = nullptr;
+        PFN_vkCmdSetColorWriteMaskEXT CmdSetColorWriteMask = nullptr;
+        PFN_vkCmdSetVertexInputEXT CmdSetVertexInput = nullptr;
+    };
+
+    //! @note VK_EXT_shader_object entry points, only loaded when
+    //! device_features::ShaderObject is enabled. Also holds the dynamic state
+    //! commands shader objects need that pipelines always bake in
+    struct shader_object_dispatch {
+        PFN_vkCreateShadersEXT CreateShaders = nullptr;
+        PFN_vkDestroyShaderEXT DestroyShader = nullptr;
+        PFN_vkCmdBindShadersEXT CmdBindShaders = nullptr;
+        PFN_vkCmdSetRasterizationSamplesEXT CmdSetRasterizationSamples =
+          nullptr;
+        PFN_vkCmdSetSampleMaskEXT CmdSetSampleMask = nullptr;
+        PFN_vkCmdSetAlphaToCoverageEnableEXT CmdSetAlphaToCoverageEnable =
+          nullptr;
+        PFN_vkCmdSetAlphaToOneEnableEXT CmdSetAlphaToOneEnable = nullptr;
+        PFN_vkCmdSetDepthClampEnableEXT CmdSetDepthClampEnable = nullptr;
+        PFN_vkCmdSetLogicOpEnableEXT CmdSetLogicOpEnable = nullptr;
+    };
+
     class vk_driver {
         struct queue_family_indices {
             uint32_t Graphics = -1;
@@ -42,8 +131,52 @@ namespace vk {
 
         static VkFormat depth_format();
 
+        const device_features& enabled_features() const {
+            return m_enabled_features;
+        }
+
+        const host_image_copy_dispatch& host_image_copy() const {
+            return m_host_image_copy;
+        }
+
+        const descriptor_buffer_dispatch& descriptor_buffer() const {
+            return m_descriptor_buffer;
+        }
+
+        const push_descriptor_dispatch& push_descriptor() const {
+            return m_push_descriptor;
+        }
+
+        const dynamic_state_dispatch& dynamic_state() const {
+            return m_dynamic_state;
+        }
+
+        const shader_object_dispatch& shader_object() const {
+            return m_shader_object;
+        }
+
+        //! @note Descriptor sizes and offset alignment of the descriptor
+        //! buffer, only filled in when device_features::DescriptorBuffer is set
+        const VkPhysicalDeviceDescriptorBufferPropertiesEXT&
+        descriptor_buffer_properties() const {
+            return m_descriptor_buffer_properties;
+        }
+
+        //! @note True when images of p_format and p_usage can be written
+        //! straight from host memory, and doing so does not cost the device
+        //! optimal access to them
+        bool supports_host_image_copy(VkFormat p_format,
+                                      VkImageUsageFlags p_usage) const;
+
         void destroy();
 
+    private:
+        void load_descriptor_buffer_dispatch();
+
+        void load_dynamic_state_dispatch();
+
+        void load_shader_object_dispatch();
+
     private:
         static vk_driver* s_instance;
         VkDevice m_driver = nullptr;
@@ -52,5 +185,13 @@ namespace vk {
         device_queues m_device_queues;
 
         queue_family_indices m_queue_indices;
+        device_features m_enabled_features{};
+        host_image_copy_dispatch m_host_image_copy{};
+        descriptor_buffer_dispatch m_descriptor_buffer{};
+        push_descriptor_dispatch m_push_descriptor{};
+        dynamic_state_dispatch m_dynamic_state{};
+        shader_object_dispatch m_shader_object{};
+        VkPhysicalDeviceDescriptorBufferPropertiesEXT
+          m_descriptor_buffer_properties{};
     };
 };
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <span>
+#include <vulkan-cpp/vk_driver.hpp>
+#include <vulkan-cpp/vk_pipeline.hpp>
+
+namespace vk {
+
+    /*
+
+        vk_dynamic_state
+            - Sets the per-draw state of pipelines created with
+       pipeline_description::DynamicState while recording, so switching cull
+       mode, depth state, blending or vertex layout never switches pipelines
+            - Remembers what was last set on the command buffer and skips
+       commands that would not change anything
+            - State the device cannot set dynamically stays baked into the
+       pipeline, the matching setters then do nothing
+            - Recording for shader objects (vk_shader::bind_shader_objects)
+       there is no pipeline to bake anything, so every setter records and
+       apply() also sets the state pipelines always bake in
+
+        Usage
+
+        vk_dynamic_state dynamic_state;
+        dynamic_state.begin(command_buffer);
+        pipeline.bind(command_buffer);
+        for (draw : draws) {
+            dynamic_state.set_raster(draw.Raster);
+            dynamic_state.set_depth(draw.Depth);
+            dynamic_state.set_blend(draw.Blend);
+            ...
+        }
+    */
+    class vk_dynamic_state {
+    public:
+        vk_dynamic_state() = default;
+
+        //! @note Forgets all state that was set, call at the start of
+        //! recording. Dynamic state is not inherited between command buffers.
+        //! p_shader_objects requires device_features::ShaderObject
+        void begin(const VkCommandBuffer& p_command_buffer,
+                   bool p_shader_objects = false);
+
+        //! @note Shader objects need the viewport and scissor set with their
+        //! counts, pipelines the plain versions
+        void set_viewport(VkExtent2D p_extent);
+
+        void set_topology(VkPrimitiveTopology p_topology,
+                          bool p_primitive_restart = false);
+
+        void set_raster(const pipeline_raster_state& p_raster);
+
+        void set_depth(const pipeline_depth_state& p_depth);
+
+        //! @note Applies p_blend to the first p_attachment_count color
+        //! attachments
+        void set_blend(const pipeline_blend_state& p_blend,
+                       uint32_t p_attachment_count = 1);
+
+        //! @note Always recorded, vertex layouts are not compared
+        void set_vertex_input(
+          std::span<const VkVertexInputBindingDescription> p_bindings,
+          std::span<const VkVertexInputAttributeDescription> p_attributes);
+
+        //! @note Sets every dynamic piece of state from p_description, ie the
+        //! description the draw would have needed a pipeline for otherwise
+        void apply(const pipeline_description& p_description);
+
+        bool uses_shader_objects() const { return m_shader_objects; }
+
+        //! @note Number of state commands recorded since begin()
+        uint32_t commands() const { return m_commands; }
+
+        //! @note Number of redundant state commands skipped since begin()
+        uint32_t skipped() const { return m_skipped; }
+
+    private:
+        //! @note Multisample, rasterizer discard, depth bounds, stencil, depth
+        //! clamp and logic op state, fixed to what every vk_pipeline bakes in
+        void set_shader_object_state(VkSampleCountFlagBits p_samples);
+
+        //! @note Records p_set when p_current is not set yet or differs from
+        //! p_value, then remembers p_value
+        template<typename T, typename UFunction>
+        void set_if_changed(T& p_current,
+                            const T& p_value,
+                            bool& p_valid,
+                            const UFunction& p_set) {
+            if (p_valid and p_current == p_value) {
+                m_skipped++;
+                return;
+            }
+            p_set();
+            p_current = p_value;
+            p_valid = true;
+            m_commands++;
+        }
+
+    private:
+        struct tracked_state {
+            VkPrimitiveTopology Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+            bool PrimitiveRestart = false;
+            pipeline_raster_state Raster{};
+            pipeline_depth_state Depth{};
+            pipeline_blend_state Blend{};
+            uint32_t BlendAttachments = 0;
+            VkSampleCountFlagBits Samples = VK_SAMPLE_COUNT_1_BIT;
+
+            bool TopologyValid = false;
+            bool PrimitiveRestartValid = false;
+            bool CullModeValid = false;
+            bool FrontFaceValid = false;
+            bool DepthBiasValid = false;
+            bool LineWidthValid = false;
+            bool PolygonModeValid = false;
+            bool DepthTestValid = false;
+            bool DepthWriteValid = false;
+            bool DepthCompareValid = false;
+            bool BlendValid = false;
+            bool SamplesValid = false;
+        };
+
+        VkCommandBuffer m_command_buffer = nullptr;
+        device_features m_features{};
+        dynamic_state_dispatch m_dispatch{};
+        shader_object_dispatch m_shader_object{};
+        bool m_shader_objects = false;
+        tracked_state m_state{};
+        uint32_t m_commands = 0;
+        uint32_t m_skipped = 0;
+    };
+};
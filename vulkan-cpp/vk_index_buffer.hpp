@@ -18,6 +18,12 @@ namespace vk {
 
         void draw(const VkCommandBuffer& p_command_buffer);
 
+        //! @note Draws p_index_count indices starting at p_first_index, ie
+        //! one chunk of the buffer
+        void draw(const VkCommandBuffer& p_command_buffer,
+                  uint32_t p_first_index,
+                  uint32_t p_index_count);
+
         void destroy();
 
     private:
@@ -0,0 +1,143 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+#include <span>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+namespace vk {
+
+    //! @note What secondary command buffers need to know about the render
+    //! pass (or dynamic rendering) of the primary that executes them
+    struct secondary_inheritance {
+        //! @note Null when the primary uses dynamic rendering
+        VkRenderPass RenderPass = nullptr;
+        VkFramebuffer Framebuffer = nullptr;
+        VkFormat ColorFormat = VK_FORMAT_UNDEFINED;
+        VkFormat DepthFormat = VK_FORMAT_UNDEFINED;
+        VkExtent2D Extent{};
+        //! @note Secondaries draw with shader objects, which only take the
+        //! viewport and scissor counts as dynamic state
+        bool ShaderObjects = false;
+    };
+
+    //! @note Begins p_command_buffer as a secondary that continues the pass
+    //! p_inheritance describes. Dynamic state is not inherited, so the
+    //! viewport and scissor are set to the inherited extent, through
+    //! vkCmdSetViewportWithCount/vkCmdSetScissorWithCount when
+    //! p_inheritance.ShaderObjects is set
+    void begin_secondary(const VkCommandBuffer& p_command_buffer,
+                         const secondary_inheritance& p_inheritance,
+                         VkCommandBufferUsageFlags p_usage = 0);
+
+    //! @note Range of draws (or indices) a chunk records
+    struct chunk_range {
+        uint32_t First = 0;
+        uint32_t Count = 0;
+    };
+
+    //! @note Splits p_count items into p_chunk_count contiguous ranges of
+    //! nearly equal size and returns range p_chunk
+    chunk_range split_chunk(uint32_t p_chunk,
+                            uint32_t p_chunk_count,
+                            uint32_t p_count);
+
+    //! @note Records chunk p_chunk into p_command_buffer
+    using secondary_record_function =
+      std::function<void(const VkCommandBuffer& p_command_buffer,
+                         uint32_t p_chunk)>;
+
+    /*
+
+        vk_parallel_recorder
+            - Records the chunks of a frame into secondary command buffers on
+       several threads, which the primary then executes in chunk order
+            - Every thread owns one VkCommandPool per slot (ie per swapchain
+       image), pools are never shared so recording takes no locks. Chunk i
+       is always recorded by thread i % thread_count()
+            - The calling thread records chunks as well, record() returns once
+       every chunk is recorded
+            - Secondaries inherit nothing but the render pass, so each chunk
+       has to bind its own pipeline, descriptors and buffers. The viewport and
+       scissor are set to the inherited extent before the chunk is recorded
+            - Recording a slot again resets its pools, the slot's previous
+       secondaries must not be pending anymore
+
+        Usage
+
+        vk_parallel_recorder recorder(swapchain.queue_family(),
+                                      swapchain.image_size());
+        swapchain.record_parallel(
+          recorder, chunk_count, [&](const VkCommandBuffer& p_command_buffer,
+                                     uint32_t p_chunk) {
+              chunk_range draws = split_chunk(p_chunk, chunk_count, count);
+              ...
+          });
+    */
+    class vk_parallel_recorder {
+    public:
+        static constexpr uint32_t MaxThreads = 8;
+
+        //! @note p_queue_family has to match the pool of the primaries
+        //! executing the secondaries. p_thread_count = 0 uses one thread per
+        //! core, capped at MaxThreads, the calling thread counts as one
+        vk_parallel_recorder(uint32_t p_queue_family,
+                             uint32_t p_slot_count,
+                             uint32_t p_thread_count = 0);
+
+        //! @note Returns the recorded secondaries in chunk order. They stay
+        //! valid until p_slot is recorded again
+        std::span<const VkCommandBuffer> record(
+          uint32_t p_slot,
+          const secondary_inheritance& p_inheritance,
+          uint32_t p_chunk_count,
+          const secondary_record_function& p_callable,
+          VkCommandBufferUsageFlags p_usage = 0);
+
+        uint32_t thread_count() const { return m_thread_count; }
+
+        //! @note Stops the threads and destroys every pool, along with the
+        //! secondaries allocated from them
+        void destroy();
+
+    private:
+        struct thread_pool {
+            VkCommandPool CommandPool = nullptr;
+            std::vector<VkCommandBuffer> CommandBuffers;
+        };
+
+        void worker_loop(uint32_t p_thread);
+
+        void record_chunks(uint32_t p_thread);
+
+    private:
+        VkDevice m_driver = nullptr;
+        uint32_t m_slot_count = 0;
+        uint32_t m_thread_count = 0;
+        // indexed by thread * m_slot_count + slot, only that thread uses it
+        std::vector<thread_pool> m_pools;
+        std::vector<std::thread> m_workers;
+        // indexed by slot then chunk, each entry is written by the thread
+        // recording it. One vector per slot, so record() of one slot leaves
+        // the spans returned for the others alone
+        std::vector<std::vector<VkCommandBuffer>> m_recorded;
+
+        // the job record() hands to the workers
+        uint32_t m_slot = 0;
+        uint32_t m_chunk_count = 0;
+        VkCommandBufferUsageFlags m_usage = 0;
+        const secondary_inheritance* m_inheritance = nullptr;
+        const secondary_record_function* m_callable = nullptr;
+
+        // shared with the worker threads
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::condition_variable m_finished_condition;
+        uint64_t m_generation = 0;
+        uint32_t m_remaining = 0;
+        bool m_stop = false;
+    };
+};
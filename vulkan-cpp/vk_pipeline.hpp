@@ -5,7 +5,10 @@
 // #include <vulkan-cpp/vk_descriptor_set.hpp>
 #include <vulkan-cpp/vk_uniform_buffer.hpp>
 #include <vulkan-cpp/vk_shader.hpp>
+#include <vulkan-cpp/vk_descriptor_cache.hpp>
 #include <span>
+#include <vector>
+#include <algorithm>
 
 namespace vk {
 
@@ -116,22 +119,250 @@ namespace vk {
         VkFormat Format = VkFormat::VK_FORMAT_UNDEFINED;
     };
 
+    //! @note Rasterizer state of a pipeline_description
+    struct pipeline_raster_state {
+        VkPolygonMode PolygonMode = VK_POLYGON_MODE_FILL;
+        VkCullModeFlags CullMode = VK_CULL_MODE_NONE;
+        VkFrontFace FrontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        bool DepthBiasEnable = false;
+        float DepthBiasConstant = 0.f;
+        float DepthBiasSlope = 0.f;
+        float LineWidth = 1.f;
+
+        bool operator==(const pipeline_raster_state&) const = default;
+    };
+
+    struct pipeline_depth_state {
+        bool TestEnable = true;
+        bool WriteEnable = true;
+        VkCompareOp CompareOp = VK_COMPARE_OP_LESS;
+
+        bool operator==(const pipeline_depth_state&) const = default;
+    };
+
+    //! @note Blend state shared by every color attachment, defaults to
+    //! alpha blending
+    struct pipeline_blend_state {
+        bool Enable = true;
+        VkBlendFactor SrcColor = VK_BLEND_FACTOR_SRC_ALPHA;
+        VkBlendFactor DstColor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        VkBlendOp ColorOp = VK_BLEND_OP_ADD;
+        VkBlendFactor SrcAlpha = VK_BLEND_FACTOR_ONE;
+        VkBlendFactor DstAlpha = VK_BLEND_FACTOR_ZERO;
+        VkBlendOp AlphaOp = VK_BLEND_OP_ADD;
+        VkColorComponentFlags WriteMask =
+          VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+          VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+        bool operator==(const pipeline_blend_state&) const = default;
+    };
+
+    /*
+
+        pipeline_description
+            - Every piece of state that goes into a VkPipeline: shaders,
+       vertex input, fixed-function state, layout and render targets
+            - Two descriptions that compare equal build identical pipelines,
+       which is what vk_pipeline_registry keys its pipelines on
+            - Defaults match what vk_pipeline has always baked in (alpha
+       blending, depth LESS, no culling), opaque geometry should turn blending
+       off and cull back faces
+            - With DynamicState set, raster/depth/blend state and vertex input
+       move to the command buffer (as far as the device supports), so one
+       pipeline per shader covers all of those combinations
+
+        Usage
+
+        pipeline_description opaque = {
+            .VertexModule = shader.get_vertex_module(),
+            .FragmentModule = shader.get_fragment_module(),
+            .Layout = pipeline_layout,
+            .RenderPass = renderpass,
+        };
+        opaque.Raster.CullMode = VK_CULL_MODE_BACK_BIT;
+        opaque.Blend.Enable = false;
+    */
+    struct pipeline_description {
+        static constexpr uint32_t MaxColorAttachments = 4;
+
+        VkShaderModule VertexModule = nullptr;
+        VkShaderModule FragmentModule = nullptr;
+        //! @note shader_feature bits both stages are specialized with, see
+        //! shader_variant::SpecializationConstants
+        uint32_t SpecializationConstants = 0;
+        std::vector<VkVertexInputBindingDescription> VertexBindings;
+        std::vector<VkVertexInputAttributeDescription> VertexAttributes;
+        VkPrimitiveTopology Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        bool PrimitiveRestart = false;
+        pipeline_raster_state Raster{};
+        pipeline_depth_state Depth{};
+        pipeline_blend_state Blend{};
+        VkSampleCountFlagBits Samples = VK_SAMPLE_COUNT_1_BIT;
+        VkPipelineLayout Layout = nullptr;
+        //! @note Left null, the pipeline is created for dynamic rendering
+        //! into attachments of ColorFormats/DepthFormat instead
+        VkRenderPass RenderPass = nullptr;
+        uint32_t Subpass = 0;
+        //! @note Formats of the render targets, one per color attachment.
+        //! Pipelines for different formats are never shared. With a render
+        //! pass and no formats the subpass is assumed to have a single color
+        //! attachment
+        std::vector<VkFormat> ColorFormats;
+        VkFormat DepthFormat = VK_FORMAT_UNDEFINED;
+        VkPipelineCreateFlags Flags = 0;
+        //! @note Leaves every piece of state the device can set while
+        //! recording dynamic, it then has to be set per draw through
+        //! vk_dynamic_state. The baked values of that state are ignored
+        bool DynamicState = false;
+
+        //! @note Copy with the state that is dynamic on this device reset to
+        //! defaults, so descriptions that only differ in dynamic state share
+        //! one pipeline. Returns an unchanged copy without DynamicState
+        pipeline_description canonical() const;
+
+        //! @note True if either stage is one of p_modules
+        bool uses_any(std::span<const VkShaderModule> p_modules) const {
+            return std::ranges::find(p_modules, VertexModule) !=
+                     p_modules.end() or
+                   std::ranges::find(p_modules, FragmentModule) !=
+                     p_modules.end();
+        }
+
+        uint32_t color_attachment_count() const {
+            if (ColorFormats.empty() and RenderPass != nullptr) {
+                return 1;
+            }
+            return std::min(static_cast<uint32_t>(ColorFormats.size()),
+                            MaxColorAttachments);
+        }
+
+        bool operator==(const pipeline_description& p_other) const;
+    };
+
+    struct pipeline_description_hash {
+        size_t operator()(const pipeline_description& p_description) const;
+    };
+
+    /*
+
+        pipeline_create_info
+            - Owns every state struct a VkGraphicsPipelineCreateInfo points at
+       for one pipeline_description, so several of them can be handed to a
+       single vkCreateGraphicsPipelines call
+            - get() links the structs together, the returned create info is
+       only valid while this object stays alive and is not moved. The vertex
+       input arrays are read straight from the description, which has to
+       outlive it too
+    */
+    class pipeline_create_info {
+        //! @note Viewport and scissor plus everything extended dynamic state
+        //! 1, 2, 3 and dynamic vertex input can cover
+        static constexpr uint32_t MaxDynamicStates = 17;
+
+    public:
+        pipeline_create_info(const pipeline_description& p_description);
+
+        VkGraphicsPipelineCreateInfo get();
+
+    private:
+        std::array<VkPipelineShaderStageCreateInfo, 2> m_shader_stages{};
+        specialization_constants m_specialization_constants;
+        VkSpecializationInfo m_specialization{};
+        VkPipelineVertexInputStateCreateInfo m_vertex_input{};
+        VkPipelineInputAssemblyStateCreateInfo m_input_assembly{};
+        VkPipelineViewportStateCreateInfo m_viewport{};
+        VkPipelineRasterizationStateCreateInfo m_rasterizer{};
+        VkPipelineMultisampleStateCreateInfo m_multisampling{};
+        VkPipelineDepthStencilStateCreateInfo m_depth_stencil{};
+        std::array<VkPipelineColorBlendAttachmentState,
+                   pipeline_description::MaxColorAttachments>
+          m_color_blend_attachments{};
+        VkPipelineColorBlendStateCreateInfo m_color_blending{};
+        std::array<VkDynamicState, MaxDynamicStates> m_dynamic_states{};
+        VkPipelineDynamicStateCreateInfo m_dynamic_state{};
+        //! @note Only chained in when the description has no render pass
+        std::array<VkFormat, pipeline_description::MaxColorAttachments>
+          m_color_formats{};
+        VkPipelineRenderingCreateInfo m_rendering{};
+        VkGraphicsPipelineCreateInfo m_create_info{};
+    };
+
     class vk_pipeline {
     public:
+        vk_pipeline() = default;
+
         vk_pipeline(
           const VkRenderPass& p_renderpass,
           vk_shader& p_shader_src,
-          const VkDescriptorSetLayout& p_descriptor_sets);
+          const VkDescriptorSetLayout& p_descriptor_sets,
+          std::span<const VkPushConstantRange> p_push_constants = {});
+
+        //! @note Gets its pipeline layout from p_layout_cache, so pipelines
+        //! built from the same set layouts share one VkPipelineLayout
+        vk_pipeline(
+          vk_descriptor_layout_cache& p_layout_cache,
+          const VkRenderPass& p_renderpass,
+          vk_shader& p_shader_src,
+          std::span<const VkDescriptorSetLayout> p_set_layouts,
+          std::span<const VkPushConstantRange> p_push_constants = {});
+
+        //! @note Builds the pipeline p_description describes. The pipeline
+        //! layout is borrowed from the description and is not destroyed here
+        vk_pipeline(const pipeline_description& p_description,
+                    VkPipelineCache p_pipeline_cache = nullptr);
+
+        //! @note Wraps a pipeline that was created elsewhere, ie by
+        //! vk_pipeline_compiler. Only the pipeline is destroyed by destroy()
+        vk_pipeline(VkPipelineLayout p_pipeline_layout, VkPipeline p_pipeline);
 
         void bind(const VkCommandBuffer& p_command_buffer);
 
+        //! @note Writes p_size bytes at p_offset of the push constant block,
+        //! the range has to be covered by one passed in at construction
+        void push_constants(const VkCommandBuffer& p_command_buffer,
+                            VkShaderStageFlags p_stages,
+                            uint32_t p_offset,
+                            uint32_t p_size,
+                            const void* p_data);
+
+        //! @note Per-draw data (ie object_push_constants) that would otherwise
+        //! need a uniform buffer write and a descriptor per object
+        template<typename T>
+        void push_constants(const VkCommandBuffer& p_command_buffer,
+                            VkShaderStageFlags p_stages,
+                            const T& p_data,
+                            uint32_t p_offset = 0) {
+            // 128 bytes is the smallest maxPushConstantsSize allowed
+            static_assert(sizeof(T) <= 128,
+                          "push constant block is larger than the "
+                          "guaranteed 128 bytes");
+            push_constants(p_command_buffer,
+                           p_stages,
+                           p_offset,
+                           static_cast<uint32_t>(sizeof(T)),
+                           &p_data);
+        }
+
         void destroy();
 
         VkPipelineLayout get_layout() const { return m_pipeline_layout; }
 
+        //! @note Changes when the registry swaps in a rebuilt or optimized
+        //! pipeline, which is what cached recordings key on
+        VkPipeline handle() const { return m_pipeline; }
+
+    private:
+        void create_pipeline(const VkRenderPass& p_renderpass,
+                             vk_shader& p_shader_src);
+
+        void create_pipeline(const pipeline_description& p_description,
+                             VkPipelineCache p_pipeline_cache);
+
     private:
         VkDevice m_driver = nullptr;
-        VkPipelineLayout m_pipeline_layout;
-        VkPipeline m_pipeline;
+        bool m_owns_layout = true;
+        VkPipelineCreateFlags m_create_flags = 0;
+        VkPipelineLayout m_pipeline_layout = nullptr;
+        VkPipeline m_pipeline = nullptr;
     };
 };
\ No newline at end of file
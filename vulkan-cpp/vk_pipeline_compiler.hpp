@@ -0,0 +1,90 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <vulkan-cpp/vk_driver.hpp>
+#include <vulkan-cpp/vk_pipeline.hpp>
+#include <vulkan-cpp/vk_pipeline_library.hpp>
+
+namespace vk {
+
+    //! @note A pipeline finished by vk_pipeline_compiler. Pipeline is null
+    //! when the driver failed to compile Description
+    struct compiled_pipeline {
+        pipeline_description Description;
+        VkPipeline Pipeline = nullptr;
+    };
+
+    /*
+
+        vk_pipeline_compiler
+            - Compiles pipelines on a pool of worker threads, so creating new
+       variants never blocks the thread that records frames
+            - Each worker takes up to MaxBatchSize queued descriptions and
+       creates them with a single vkCreateGraphicsPipelines call
+            - Shader modules and pipeline layouts referenced by submitted
+       descriptions have to stay alive until their pipeline is collected
+            - Given a vk_pipeline_library, workers instead link the
+       description's library parts with link time optimization, which reuses
+       the parts compiled for the fast link
+
+        Usage
+
+        vk_pipeline_compiler compiler(pipeline_cache);
+        compiler.submit(description);
+        ...
+        // every frame
+        for (compiled_pipeline& compiled : compiler.collect()) {
+            ...
+        }
+    */
+    class vk_pipeline_compiler {
+    public:
+        static constexpr uint32_t MaxBatchSize = 8;
+        static constexpr uint32_t MaxThreads = 4;
+
+        //! @note p_thread_count = 0 picks one thread per spare core, capped
+        //! at MaxThreads. p_library has to outlive the compiler
+        vk_pipeline_compiler(VkPipelineCache p_pipeline_cache,
+                             uint32_t p_thread_count = 0,
+                             vk_pipeline_library* p_library = nullptr);
+
+        void submit(const pipeline_description& p_description);
+
+        //! @note Hands over every pipeline finished since the last call, the
+        //! caller owns the returned pipelines
+        std::vector<compiled_pipeline> collect();
+
+        //! @note Descriptions submitted but not collected yet
+        uint32_t pending();
+
+        //! @note Stops the workers, pipelines that were never collected are
+        //! destroyed
+        void destroy();
+
+    private:
+        void worker_loop();
+
+        void compile_batch(std::vector<pipeline_description>& p_batch);
+
+        void link_batch(std::vector<pipeline_description>& p_batch);
+
+    private:
+        VkDevice m_driver = nullptr;
+        VkPipelineCache m_pipeline_cache = nullptr;
+        vk_pipeline_library* m_library = nullptr;
+        std::vector<std::thread> m_workers;
+
+        // shared with the worker threads
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_stop = false;
+        std::deque<pipeline_description> m_requests;
+        std::vector<compiled_pipeline> m_compiled;
+        uint32_t m_pending = 0;
+    };
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <array>
+#include <mutex>
+#include <unordered_map>
+#include <vulkan-cpp/vk_driver.hpp>
+#include <vulkan-cpp/vk_pipeline.hpp>
+
+namespace vk {
+
+    //! @note The four independently compiled parts of a graphics pipeline
+    enum class pipeline_library_part : uint8_t {
+        VertexInput = 0,
+        PreRasterization = 1,
+        FragmentShader = 2,
+        FragmentOutput = 3
+    };
+
+    static constexpr uint32_t PipelineLibraryPartCount = 4;
+
+    /*
+
+        vk_pipeline_library
+            - Splits every pipeline_description into its vertex input,
+       pre-rasterization (vertex shader), fragment shader and fragment output
+       parts, and compiles each part once as a VK_EXT_graphics_pipeline_library
+       library
+            - Parts are keyed by only the state they read, so a new combination
+       of shaders and state that were already used costs a link instead of a
+       full compile
+            - link() without p_optimize is the fast link, cheap enough for the
+       render thread. With p_optimize the parts are linked with link time
+       optimization, which takes about as long as a full compile but produces
+       the same code a monolithic pipeline would
+            - link() is safe to call from several threads at once, the lock
+       only covers looking parts up and adding them, parts are compiled
+       outside of it
+
+        Usage
+
+        vk_pipeline_library library(pipeline_cache);
+        VkPipeline fast = library.link(description);
+        ...
+        // later, off the render thread
+        VkPipeline optimized = library.link(description, true);
+    */
+    class vk_pipeline_library {
+    public:
+        vk_pipeline_library() = default;
+        //! @note Requires device_features::GraphicsPipelineLibrary
+        vk_pipeline_library(VkPipelineCache p_pipeline_cache);
+
+        //! @note Returns null when a part or the link failed. The caller owns
+        //! the returned pipeline, the parts stay owned by the library
+        VkPipeline link(const pipeline_description& p_description,
+                        bool p_optimize = false);
+
+        //! @note Forgets every part compiled from one of p_modules and
+        //! returns them. The caller destroys them once no link that may be
+        //! reading them is still running
+        std::vector<VkPipeline> evict(
+          std::span<const VkShaderModule> p_modules);
+
+        //! @note Number of parts compiled so far
+        size_t parts();
+
+        bool is_valid() const { return m_driver != nullptr; }
+
+        //! @note Pipelines linked from the parts may outlive them
+        void destroy();
+
+    private:
+        //! @note Returns the part p_description needs, compiling it if it does
+        //! not exist yet. Locks m_mutex itself
+        VkPipeline get_part(const pipeline_description& p_description,
+                            pipeline_library_part p_part);
+
+        //! @note p_key is already the part_key() of the description
+        VkPipeline compile_part(const pipeline_description& p_key,
+                                pipeline_library_part p_part);
+
+    private:
+        VkDevice m_driver = nullptr;
+        VkPipelineCache m_pipeline_cache = nullptr;
+        std::mutex m_mutex;
+        std::array<std::unordered_map<pipeline_description,
+                                      VkPipeline,
+                                      pipeline_description_hash>,
+                   PipelineLibraryPartCount>
+          m_parts;
+    };
+};
@@ -0,0 +1,193 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <vulkan-cpp/vk_driver.hpp>
+#include <vulkan-cpp/vk_pipeline.hpp>
+#include <vulkan-cpp/vk_pipeline_compiler.hpp>
+#include <vulkan-cpp/vk_pipeline_library.hpp>
+#include <vulkan-cpp/logger.hpp>
+
+namespace vk {
+
+    /*
+
+        vk_pipeline_registry
+            - Hands out one vk_pipeline per distinct pipeline_description,
+       requesting the same state again returns the pipeline that already
+       exists instead of compiling a new one
+            - Variants are only compiled the first time they are requested,
+       through a shared VkPipelineCache so the driver can reuse work between
+       variants of the same shaders
+            - Descriptions with DynamicState are keyed without their dynamic
+       state, so they all resolve to one pipeline
+            - get() compiles on the calling thread, request() hands the
+       variant to a vk_pipeline_compiler and returns a fallback (or nothing)
+       until update() picks up the finished pipeline
+            - With graphics pipeline libraries both fast-link the variant
+       from vk_pipeline_library parts right away instead, and (with
+       p_optimized_relink) the compiler relinks it with link time optimization
+       in the background. update() swaps the optimized pipeline in, the fast
+       one is destroyed MaxFramesInFlight calls to update() later since
+       command buffers still in flight may use it
+            - rebuild() recompiles every pipeline using a reloaded shader
+       module in the background, update() then swaps the new pipeline into
+       the vk_pipeline handed out for the old one, the old pipeline is
+       retired the same way
+            - evict() drops every pipeline built from shader modules
+       vk_shader::evict_unused() let go of, so a later module that reuses
+       the handle can not match them. Pipelines referenced through get(), or
+       requested since the previous update(), are reported by used_modules()
+       so the shader keeps their modules, and are never evicted
+            - Owns every pipeline it returns, they are destroyed by destroy()
+
+        Usage
+
+        vk_pipeline_registry pipelines;
+        pipeline_description opaque = { ... };
+        opaque.Blend.Enable = false;
+        opaque.Raster.CullMode = VK_CULL_MODE_BACK_BIT;
+        vk_pipeline& opaque_pipeline = pipelines.get(opaque);
+
+        // every frame, variants that are still compiling draw with fallback
+        pipelines.update();
+        pipelines.evict(shader.evict_unused(pipelines.used_modules()));
+        pipelines.request(variant, opaque_pipeline).bind(command_buffer);
+
+        // once opaque_pipeline is not bound anymore
+        pipelines.release(opaque_pipeline);
+    */
+    class vk_pipeline_registry {
+        struct retired_pipeline {
+            vk_pipeline Pipeline;
+            uint64_t Frame = 0;
+        };
+
+        struct pipeline_use {
+            //! @note get() calls not matched by release() yet
+            uint32_t References = 0;
+            uint64_t LastRequested = 0;
+        };
+
+    public:
+        //! @note p_compile_threads is forwarded to vk_pipeline_compiler.
+        //! p_optimized_relink only matters with graphics pipeline libraries
+        vk_pipeline_registry(uint32_t p_compile_threads = 0,
+                             bool p_optimized_relink = true);
+
+        //! @note Compiles on the calling thread if the variant does not exist
+        //! yet. Every call holds a reference until release(), evict() never
+        //! drops a referenced pipeline so it stays valid until destroy()
+        vk_pipeline& get(const pipeline_description& p_description);
+
+        //! @note Drops a reference get() handed out
+        void release(const vk_pipeline& p_pipeline);
+
+        //! @note Never blocks. Returns nullptr while the variant compiles in
+        //! the background, in which case the draw should be skipped. The
+        //! pointer is only meant for the frame it was requested in, request
+        //! again every frame
+        vk_pipeline* request(const pipeline_description& p_description);
+
+        //! @note Returns p_fallback while the variant compiles, or when it
+        //! failed to compile
+        vk_pipeline& request(const pipeline_description& p_description,
+                             vk_pipeline& p_fallback);
+
+        //! @note Adds pipelines finished in the background to the registry
+        //! and destroys pipelines retired MaxFramesInFlight calls ago, call
+        //! once per frame before recording. Returns true when a
+        //! pipeline handed out earlier was replaced, command buffers
+        //! recorded with it have to be recorded again
+        bool update();
+
+        //! @note Recompiles every pipeline built from a module in p_remap
+        //! with its replacement, see vk_shader::reload(). The old pipelines
+        //! stay in use until update() swaps the new ones in
+        void rebuild(const shader_module_remap& p_remap);
+
+        //! @note Retires every pipeline built from one of p_modules, see
+        //! vk_shader::evict_unused(). Compiles still running for them are
+        //! discarded by update(), library parts compiled from them are
+        //! destroyed once no compile is running anymore
+        void evict(std::span<const VkShaderModule> p_modules);
+
+        //! @note Modules of pipelines still referenced through get(), or
+        //! requested since the previous update(). Pass them to
+        //! vk_shader::evict_unused() so it keeps their permutations
+        std::vector<VkShaderModule> used_modules() const;
+
+        bool contains(const pipeline_description& p_description) const {
+            return m_pipelines.contains(p_description);
+        }
+
+        size_t size() const { return m_pipelines.size(); }
+
+        uint64_t hits() const { return m_hits; }
+
+        uint64_t misses() const { return m_misses; }
+
+        //! @note Variants requested but not compiled yet, or fast-linked
+        //! variants waiting for their optimized relink
+        size_t pending() const { return m_pending.size(); }
+
+        bool uses_pipeline_library() const { return m_library != nullptr; }
+
+        //! @note Fast-linked variants replaced by their optimized relink
+        uint64_t optimized() const { return m_optimized; }
+
+        void destroy();
+
+    private:
+        //! @note p_description is already the registry key, see
+        //! pipeline_description::canonical()
+        vk_pipeline& get_canonical(const pipeline_description& p_description);
+
+        vk_pipeline* request_canonical(
+          const pipeline_description& p_description);
+
+        //! @note Fast-links p_description and queues its optimized relink,
+        //! returns nullptr if linking failed
+        vk_pipeline* link_canonical(const pipeline_description& p_description);
+
+    private:
+        VkDevice m_driver = nullptr;
+        VkPipelineCache m_pipeline_cache = nullptr;
+        bool m_optimized_relink = true;
+        //! @note Null when the device has no graphics pipeline libraries
+        logger::scope<vk_pipeline_library> m_library;
+        vk_pipeline_compiler m_compiler;
+        std::unordered_map<pipeline_description,
+                           vk_pipeline,
+                           pipeline_description_hash>
+          m_pipelines;
+        std::unordered_set<pipeline_description, pipeline_description_hash>
+          m_pending;
+        //! @note Variants the driver failed to compile, never resubmitted
+        std::unordered_set<pipeline_description, pipeline_description_hash>
+          m_failed;
+        //! @note Rebuilt description -> key of the pipeline it replaces, its
+        //! node is re-keyed in place once the rebuild finishes
+        std::unordered_map<pipeline_description,
+                           pipeline_description,
+                           pipeline_description_hash>
+          m_rebuilds;
+        //! @note Rebuilds made obsolete by a newer rebuild before finishing
+        std::unordered_set<pipeline_description, pipeline_description_hash>
+          m_superseded;
+        //! @note Pipelines replaced by an optimized relink or a rebuild, kept
+        //! until the frames that may have recorded them are done
+        std::vector<retired_pipeline> m_retired;
+        //! @note Library parts of evicted modules, links in the background
+        //! may still read them
+        std::vector<VkPipeline> m_evicted_parts;
+        //! @note Keyed by address, which survives rebuilds and relinks
+        std::unordered_map<const vk_pipeline*, pipeline_use> m_uses;
+        uint64_t m_frame = 0;
+        uint64_t m_hits = 0;
+        uint64_t m_misses = 0;
+        uint64_t m_optimized = 0;
+    };
+};
@@ -21,6 +21,10 @@ namespace vk {
 
         uint32_t read_acquire_image();
 
+        //! @note Acquires the next image, signaling p_acquired_semaphore once
+        //! it can be rendered to
+        uint32_t read_acquire_image(VkSemaphore p_acquired_semaphore);
+
         /*
         Specify whether you want to submit to the command buffer in either async
         or synchronization mode
@@ -28,8 +32,17 @@ namespace vk {
         void submit_to(const VkCommandBuffer& p_command_buffer,
                        submission_type submission_t);
 
+        //! @note Submits p_command_buffer once p_wait_semaphore signals,
+        //! then signals p_signal_semaphore and p_fence when it completes
+        void submit_to(const VkCommandBuffer& p_command_buffer,
+                       VkSemaphore p_wait_semaphore,
+                       VkSemaphore p_signal_semaphore,
+                       VkFence p_fence);
+
         void present(uint32_t p_frame_index);
 
+        void present(uint32_t p_frame_index, VkSemaphore p_wait_semaphore);
+
         void destroy();
 
         operator VkQueue() { return m_queue; }
@@ -1,12 +1,78 @@
 #pragma once
 #include <vulkan-cpp/vk_driver.hpp>
 #include <string>
+#include <string_view>
 #include <span>
+#include <array>
 #include <initializer_list>
+#include <unordered_map>
 
 namespace vk {
+    class vk_shader_bundle;
+
     enum class shader_load_type { File = 0, Text = 1 };
 
+    /*
+
+        Shader features
+            - Optional pieces of a shader, a variant key is the set of
+       features a draw wants enabled
+            - Feature bit i is declared in GLSL as
+       layout(constant_id = i) const bool NAME = false; so one SPIR-V binary
+       covers every combination and disabled features are compiled out when
+       the pipeline is created
+            - Features that cannot be a specialization constant (ie they change
+       the shader interface) are compiled offline with -DNAME into
+       <name>_<hex bits>.spv next to the base binary, see shaders/compile.sh
+    */
+    enum shader_feature : uint32_t {
+        ALPHA_TEST = 1 << 0,
+        VERTEX_COLORS = 1 << 1
+    };
+
+    static constexpr uint32_t MaxShaderFeatures = 32;
+
+    //! @note GLSL name of feature bit i, permutations are compiled with
+    //! -D<name>=true for each of their bits
+    static constexpr std::array<std::string_view, 2> ShaderFeatureNames = {
+        "ALPHA_TEST",
+        "VERTEX_COLORS"
+    };
+
+    //! @note Combination of shader_feature bits
+    using shader_variant_key = uint32_t;
+
+    //! @note Binary of the permutation p_bits of p_filename, ie
+    //! shaders/vert.spv with bits 0x3 -> shaders/vert_3.spv
+    std::string permutation_filename(const std::string& p_filename,
+                                     uint32_t p_bits);
+
+    //! @note One VkBool32 constant per shader_feature bit, constant_id i
+    //! reads bit i. Pipelines and shader objects both specialize through
+    //! this, so a variant compiles the same way on either path
+    struct specialization_constants {
+        specialization_constants(uint32_t p_bits = 0);
+
+        //! @note Points into this object, keep it alive until the create
+        //! call returns
+        VkSpecializationInfo get() const;
+
+        std::array<VkSpecializationMapEntry, MaxShaderFeatures> Entries{};
+        std::array<VkBool32, MaxShaderFeatures> Data{};
+    };
+
+    //! @note Old module -> the module that replaced it, returned by
+    //! vk_shader::reload() for vk_pipeline_registry::rebuild()
+    using shader_module_remap =
+      std::unordered_map<VkShaderModule, VkShaderModule>;
+
+    //! @note What a pipeline_description needs to build one variant
+    struct shader_variant {
+        VkShaderModule VertexModule = nullptr;
+        VkShaderModule FragmentModule = nullptr;
+        uint32_t SpecializationConstants = 0;
+    };
+
     /*
     struct shader_vetex_attribute {
         std::string Name="Undefined";
@@ -24,6 +90,16 @@ namespace vk {
         vk_shader(const std::string& p_vert_filename,
                   const std::string& p_frag_filename);
 
+        //! @note Creates both modules in parallel from SPIR-V inside the
+        //! mapped p_bundle, no copies are made, and takes the vertex input
+        //! from the vertex entry. The names are the shaders' .spv paths,
+        //! permutations are looked up in p_bundle under their
+        //! permutation_filename() and reload() keeps reading from disk.
+        //! p_bundle has to outlive the shader
+        vk_shader(const vk_shader_bundle& p_bundle,
+                  std::string_view p_vert_name,
+                  std::string_view p_frag_name);
+
         // VkPipeline get_graphics_pipeline() { return m_graphics_pipeline; }
 
         VkShaderModule get_vertex_module() const {
@@ -33,6 +109,79 @@ namespace vk {
             return m_fragment_shader_module;
         }
 
+        //! @note Features in p_mask are specialization constants of this
+        //! shader, every other feature selects a precompiled permutation
+        void set_specialized_features(uint32_t p_mask) {
+            m_specialized_features = p_mask;
+        }
+
+        //! @note Loads the permutation p_key needs the first time it is
+        //! asked for. Falls back to the base modules (with a warning) if the
+        //! permutation binary does not exist
+        shader_variant variant(shader_variant_key p_key);
+
+        //! @note Ages the cached permutations and destroys shader objects
+        //! retired MaxFramesInFlight calls ago, call once per frame. Retired
+        //! modules are only read while creating pipelines, they are
+        //! destroyed as soon as p_compiles_pending is false, ie
+        //! vk_pipeline_registry::pending() == 0
+        void begin_frame(bool p_compiles_pending = false);
+
+        //! @note Drops permutations that were not asked for in the last
+        //! p_max_unused_frames frames, along with their shader objects, and
+        //! returns their modules for vk_pipeline_registry::evict(). The
+        //! modules are retired like the ones reload() replaces, since
+        //! pipelines still compiling in the background may read them.
+        //! Permutations with a module in p_in_use count as used this frame,
+        //! see vk_pipeline_registry::used_modules()
+        std::vector<VkShaderModule> evict_unused(
+          std::span<const VkShaderModule> p_in_use = {},
+          uint32_t p_max_unused_frames = MaxUnusedFrames);
+
+        //! @note Permutations currently loaded, not counting the base modules
+        size_t variant_count() const { return m_permutations.size(); }
+
+        //! @note Loads the binaries again, along with every loaded
+        //! permutation, and recreates the shader objects if there were any.
+        //! Returns which modules replaced which. The old modules and shader
+        //! objects are retired, see begin_frame(), pipelines being rebuilt
+        //! and command buffers in flight may still use them
+        shader_module_remap reload();
+
+        const std::string& vertex_filename() const {
+            return m_vertex_filename;
+        }
+        const std::string& fragment_filename() const {
+            return m_fragment_filename;
+        }
+
+        //! @note Creates linked vertex and fragment VkShaderEXT objects for
+        //! p_key from the same SPIR-V and specialization constants a
+        //! pipeline built from variant(p_key) uses. The set layouts and push
+        //! constants must match the pipeline layout descriptors are bound
+        //! with, and are kept for the variants bound later. Returns false
+        //! without device_features::ShaderObject, pipelines built from the
+        //! modules are the fallback then
+        bool create_shader_objects(
+          std::span<const VkDescriptorSetLayout> p_set_layouts,
+          std::span<const VkPushConstantRange> p_push_constants = {},
+          shader_variant_key p_key = 0);
+
+        bool has_shader_objects() const { return m_shader_objects_enabled; }
+
+        //! @note Binds the vertex and fragment shader objects of p_key,
+        //! creating them the first time the variant is bound, and unbinds
+        //! the tessellation and geometry stages. All state has to be set
+        //! through vk_dynamic_state before drawing. Creating is not thread
+        //! safe, create the variants with create_shader_objects() before
+        //! recording on several threads
+        void bind_shader_objects(const VkCommandBuffer& p_command_buffer,
+                                 shader_variant_key p_key = 0);
+
+        //! @note nullptr until the objects of p_key have been created
+        VkShaderEXT get_vertex_object(shader_variant_key p_key = 0) const;
+        VkShaderEXT get_fragment_object(shader_variant_key p_key = 0) const;
+
         void destroy();
 
         void set_window_size(uint32_t p_width, uint32_t p_height) {
@@ -46,7 +195,35 @@ namespace vk {
         std::span<VkVertexInputAttributeDescription> get_vertex_attributes() { return m_attribute_descriptions; }
         std::span<VkVertexInputBindingDescription> get_vertex_bind_attributes() { return m_binding_attribute_descriptions; }
 
+    public:
+        static constexpr uint32_t MaxUnusedFrames = 600;
+
     private:
+        struct permutation {
+            VkShaderModule VertexModule = nullptr;
+            VkShaderModule FragmentModule = nullptr;
+            // shader objects are created from the code, not the modules, the
+            // spans point either into these or into the shader bundle
+            std::vector<char> VertexCode;
+            std::vector<char> FragmentCode;
+            std::span<const char> VertexSpirv;
+            std::span<const char> FragmentSpirv;
+            uint64_t LastUsed = 0;
+        };
+
+        struct retired_object {
+            VkShaderEXT Object = nullptr;
+            uint64_t Frame = 0;
+        };
+
+        struct shader_object_pair {
+            VkShaderEXT Vertex = nullptr;
+            VkShaderEXT Fragment = nullptr;
+        };
+
+        const shader_object_pair& shader_objects(shader_variant_key p_key);
+        shader_object_pair create_shader_object_pair(shader_variant_key p_key);
+
         void load_from_file(const std::string& p_filename);
         void load_from_text(const std::string& p_filename);
 
@@ -54,6 +231,32 @@ namespace vk {
         vk_driver m_driver;
         VkShaderModule m_vertex_shader_module = nullptr;
         VkShaderModule m_fragment_shader_module = nullptr;
+        // kept around so shader objects can be created from the same code,
+        // the spans point either into these or into a shader bundle
+        std::vector<char> m_vertex_code;
+        std::vector<char> m_fragment_code;
+        std::span<const char> m_vertex_spirv;
+        std::span<const char> m_fragment_spirv;
+        std::string m_vertex_filename;
+        std::string m_fragment_filename;
+        // permutations are read from here instead of disk when set
+        const vk_shader_bundle* m_bundle = nullptr;
+
+        // keyed by the feature bits that are not specialization constants
+        uint32_t m_specialized_features = ~0u;
+        std::unordered_map<uint32_t, permutation> m_permutations;
+        uint64_t m_frame = 0;
+
+        // keyed by the full variant key, permutation and specialization bits
+        std::unordered_map<shader_variant_key, shader_object_pair>
+          m_shader_objects;
+        bool m_shader_objects_enabled = false;
+
+        // kept for creating variants on demand and for reload()
+        std::vector<VkDescriptorSetLayout> m_object_set_layouts;
+        std::vector<VkPushConstantRange> m_object_push_constants;
+        std::vector<VkShaderModule> m_retired_modules;
+        std::vector<retired_object> m_retired_objects;
         VkExtent2D m_window_size{};
 
         std::vector<VkVertexInputAttributeDescription> m_attribute_descriptions;
@@ -0,0 +1,131 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vk {
+
+    /*
+
+        Shader bundle file layout, every offset is from the start of the file
+       and 4 byte aligned so SPIR-V can be read in place
+            - shader_bundle_header
+            - shader_bundle_entry[EntryCount], sorted by NameHash
+            - per entry: SPIR-V code, then its reflection data
+       (VkVertexInputBindingDescription[] and
+       VkVertexInputAttributeDescription[])
+    */
+    struct shader_bundle_header {
+        static constexpr uint32_t BundleMagic = 0x42534b56; // "VKSB"
+        static constexpr uint32_t BundleVersion = 1;
+
+        uint32_t Magic = BundleMagic;
+        uint32_t Version = BundleVersion;
+        uint32_t EntryCount = 0;
+        uint32_t Reserved = 0;
+    };
+
+    struct shader_bundle_entry {
+        uint64_t NameHash = 0;
+        uint32_t Stage = 0;
+        uint32_t CodeOffset = 0;
+        uint32_t CodeSize = 0;
+        uint32_t BindingOffset = 0;
+        uint32_t BindingCount = 0;
+        uint32_t AttributeOffset = 0;
+        uint32_t AttributeCount = 0;
+        uint32_t Reserved = 0;
+    };
+
+    //! @note FNV-1a, stable between runs and platforms unlike std::hash
+    constexpr uint64_t shader_bundle_hash(std::string_view p_name) {
+        uint64_t hash = 0xcbf29ce484222325;
+        for (char c : p_name) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 0x100000001b3;
+        }
+        return hash;
+    }
+
+    //! @note One shader packed by vk_shader_bundle::write()
+    struct shader_bundle_source {
+        //! @note What the shader is looked up by, ie its .spv path
+        std::string Name;
+        std::string Filename;
+        VkShaderStageFlagBits Stage = VK_SHADER_STAGE_VERTEX_BIT;
+        //! @note Vertex input the shader expects, vertex shaders only
+        std::vector<VkVertexInputBindingDescription> VertexBindings;
+        std::vector<VkVertexInputAttributeDescription> VertexAttributes;
+    };
+
+    /*
+
+        vk_shader_bundle
+            - Every shader of the application in one file, mapped into memory
+       once instead of opening and copying a .spv per stage
+            - SPIR-V is handed to vkCreateShaderModule straight from the
+       mapping, lookups are a binary search over the name hashes
+            - Shaders created from the bundle read from the mapping, so the
+       bundle has to outlive them
+            - Permutations are packed under their permutation_filename(), ie
+       shaders/vert_2.spv, and vk_shader::variant() looks them up here
+
+        Usage
+
+        if (!vk_shader_bundle::is_up_to_date("shaders/shaders.bundle",
+                                             sources)) {
+            vk_shader_bundle::write("shaders/shaders.bundle", sources);
+        }
+        vk_shader_bundle bundle("shaders/shaders.bundle");
+        vk_shader shader(bundle, "shaders/vert.spv", "shaders/frag.spv");
+    */
+    class vk_shader_bundle {
+    public:
+        vk_shader_bundle() = default;
+        vk_shader_bundle(const std::string& p_filename);
+
+        //! @note Returns nullptr when p_name is not in the bundle
+        const shader_bundle_entry* find(std::string_view p_name) const;
+
+        std::span<const char> code(const shader_bundle_entry& p_entry) const;
+
+        std::span<const VkVertexInputBindingDescription> vertex_bindings(
+          const shader_bundle_entry& p_entry) const;
+
+        std::span<const VkVertexInputAttributeDescription> vertex_attributes(
+          const shader_bundle_entry& p_entry) const;
+
+        bool is_valid() const { return m_data != nullptr; }
+
+        //! @note Packs p_sources into p_filename, returns false if a source
+        //! cannot be read or two names share a hash
+        static bool write(const std::string& p_filename,
+                          std::span<const shader_bundle_source> p_sources);
+
+        //! @note True when p_filename exists and is newer than every source
+        static bool is_up_to_date(
+          const std::string& p_filename,
+          std::span<const shader_bundle_source> p_sources);
+
+        //! @note Unmaps the file, shaders created from it must be destroyed
+        //! first
+        void destroy();
+
+    private:
+        //! @note Checks every entry lies inside the mapping, holds whole
+        //! SPIR-V words and points m_entries at the entry table
+        bool validate();
+
+    private:
+        const char* m_data = nullptr;
+        size_t m_size = 0;
+        std::span<const shader_bundle_entry> m_entries;
+#if defined(_WIN32)
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+#endif
+    };
+};
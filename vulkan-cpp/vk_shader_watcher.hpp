@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <vulkan-cpp/vk_shader.hpp>
+
+namespace vk {
+
+    /*
+
+        vk_shader_watcher
+            - Watches shader sources and binaries on a background thread
+       (inotify, Linux only, elsewhere nothing is ever reported)
+            - A changed GLSL source gets recompiled into its binary on that
+       thread with the external compiler (glslc from the Vulkan SDK by
+       default), compile errors are logged and the old binary is kept
+            - Permutation binaries next to a watched binary (see
+       permutation_filename()) are recompiled from the same source with the
+       -D defines of their feature bits, and reported like the base binary
+            - changed() hands the binaries rewritten since the last call to
+       the render thread, which reloads the vk_shader's using them at a frame
+       boundary
+
+        Usage
+
+        vk_shader_watcher watcher;
+        watcher.watch_source("shaders/shader.vert", "shaders/vert.spv");
+        watcher.watch_source("shaders/shader.frag", "shaders/frag.spv");
+        ...
+        // every frame, before pipelines.update()
+        std::vector<std::string> changed = watcher.changed();
+        if (vk_shader_watcher::is_changed(changed, shader)) {
+            pipelines.rebuild(shader.reload());
+        }
+    */
+    class vk_shader_watcher {
+    public:
+        vk_shader_watcher(const std::string& p_compiler = "glslc");
+
+        //! @note p_binary is reported by changed() whenever it is rewritten,
+        //! and p_source gets compiled into it whenever it is saved
+        void watch_source(const std::string& p_source,
+                          const std::string& p_binary);
+
+        //! @note Only reports the binaries of p_shader and their
+        //! permutations, for binaries built by something else
+        void watch(const vk_shader& p_shader);
+
+        //! @note Binaries rewritten since the last call
+        std::vector<std::string> changed();
+
+        //! @note True when p_shader loads one of p_changed, or one of
+        //! p_changed is a permutation of its binaries
+        static bool is_changed(const std::vector<std::string>& p_changed,
+                               const vk_shader& p_shader);
+
+        //! @note Stops the watcher thread, has to be called before the
+        //! watcher goes away
+        void destroy();
+
+    private:
+        void watch_directory(const std::string& p_file);
+
+        void watcher_loop();
+
+        void on_file_written(const std::string& p_file);
+
+        //! @note Compiles p_source into p_binary with a define per bit of
+        //! p_features
+        void compile(const std::string& p_source,
+                     const std::string& p_binary,
+                     uint32_t p_features = 0);
+
+    private:
+        std::string m_compiler;
+        int m_inotify = -1;
+        std::thread m_thread;
+        std::atomic<bool> m_stop = false;
+
+        // shared with the watcher thread
+        std::mutex m_mutex;
+        //! @note Watch descriptor -> directory it watches
+        std::unordered_map<int, std::string> m_directories;
+        //! @note Source -> binary it compiles into
+        std::unordered_map<std::string, std::string> m_sources;
+        std::unordered_set<std::string> m_binaries;
+        std::unordered_set<std::string> m_changed;
+    };
+};
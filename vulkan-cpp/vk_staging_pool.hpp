@@ -0,0 +1,96 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+#include <span>
+#include <vulkan-cpp/vk_buffer.hpp>
+#include <vulkan-cpp/vk_driver.hpp>
+
+namespace vk {
+
+    /*
+
+        vk_staging_pool
+            - Shared pool of host-visible staging buffers used for uploading
+       data to device-local resources (textures, etc)
+            - Staging buffers are only needed until the copy that reads from
+       them has finished executing on the GPU
+
+        Usage
+
+        buffer_properties staging = pool.acquire(image_size);
+        write(staging, pixels, image_size);
+
+        VkFence fence = pool.acquire_fence();
+        ... record copy from staging, vkQueueSubmit(..., fence)
+        pool.release(staging, fence);
+
+        Once the fence signals the staging buffer goes back into the free list
+        and gets reused by the next acquire call. Nothing holds on to a second
+        copy of the texels for the whole lifetime of the texture.
+    */
+    class vk_staging_pool {
+        struct pending_submission {
+            VkFence Fence = nullptr;
+            std::vector<buffer_properties> Buffers;
+        };
+
+    public:
+        //! @note Maximum bytes of unused staging memory the pool keeps around
+        //! for reuse. Anything above this gets freed when it is reclaimed.
+        static constexpr uint32_t DefaultRetainedBytes = 64 * 1024 * 1024;
+
+        vk_staging_pool() = default;
+        vk_staging_pool(uint32_t p_max_retained_bytes);
+
+        //! @note Returns a host-visible buffer of at least p_size_in_bytes
+        buffer_properties acquire(uint32_t p_size_in_bytes);
+
+        //! @note Returns an unsignaled fence that can be used to submit the
+        //! copy reading from acquired staging buffers
+        VkFence acquire_fence();
+
+        //! @note Staging buffers are returned to the pool as soon as p_fence
+        //! signals. The pool takes ownership of p_fence.
+        void release(const buffer_properties& p_buffer, VkFence p_fence);
+        void release(std::span<const buffer_properties> p_buffers,
+                     VkFence p_fence);
+
+        //! @note For staging buffers whose copy is known to have finished
+        //! already, ie by waiting on a fence the pool does not own
+        void release(std::span<const buffer_properties> p_buffers);
+
+        //! @note Moves staging buffers whose fence has signaled back to the
+        //! free list
+        void reclaim();
+
+        //! @note Frees all unused staging memory
+        void trim();
+
+        uint32_t retained_bytes() const { return m_retained_bytes; }
+
+        //! @note The pool created last, uploads go through it. Check
+        //! has_pool_context() first when one may not exist yet
+        static vk_staging_pool& pool_context();
+
+        static bool has_pool_context() { return s_instance != nullptr; }
+
+        void destroy();
+
+    private:
+        //! @note Back into the free list, or freed when the pool already
+        //! retains m_max_retained_bytes
+        void recycle(const buffer_properties& p_buffer);
+
+        void free_buffer(const buffer_properties& p_buffer);
+
+    private:
+        static vk_staging_pool* s_instance;
+        VkDevice m_driver = nullptr;
+        uint32_t m_max_retained_bytes = DefaultRetainedBytes;
+        uint32_t m_retained_bytes = 0;
+        std::vector<buffer_properties> m_free_buffers;
+        std::vector<pending_submission> m_pending;
+        std::vector<VkFence> m_free_fences;
+    };
+};
@@ -0,0 +1,127 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <vector>
+#include <functional>
+#include <renderer/hash.hpp>
+#include <vulkan-cpp/vk_parallel_recorder.hpp>
+
+namespace vk {
+
+    //! @note Records a chunk's draws for p_slot into p_command_buffer
+    using static_chunk_record_function =
+      std::function<void(const VkCommandBuffer& p_command_buffer,
+                         uint32_t p_slot)>;
+
+    /*
+
+        vk_static_chunk_cache
+            - Keeps the secondary command buffers of static scene chunks
+       across frames, so a frame only records the chunks that changed and
+       executes the rest as they are
+            - A chunk is recorded once per slot. Chunks that bind per-frame
+       data (ie the per-frame uniform set) use the frame slot,
+       vk_swapchain::frame_index(), as slot
+            - A chunk is recorded again when it is marked dirty, when the state
+       given to set_state() changes (a hash of the pipelines, descriptor sets
+       and buffers it uses) or when the inheritance changes, ie after a resize
+            - Replaced command buffers may still be pending in frames in
+       flight, they are only reused MaxFramesInFlight frames later
+            - Chunks are recorded without a framebuffer, so one recording is
+       valid for every swapchain image
+
+        Usage
+
+        vk_static_chunk_cache cache(swapchain.queue_family(),
+                                    swapchain_configs::MaxFramesInFlight);
+        uint32_t chunk = cache.add([&](const VkCommandBuffer& p_command_buffer,
+                                       uint32_t p_slot) { ... });
+        // every frame
+        cache.set_state(
+          chunk, vk_static_chunk_cache::state_hash(pipeline.handle(), set));
+        VkCommandBuffer command_buffer = swapchain.begin_frame(true);
+        cache.execute(command_buffer,
+                      swapchain.frame_inheritance(),
+                      swapchain.frame_index());
+        swapchain.execute_parallel(recorder, dynamic_chunks, record_dynamic);
+        swapchain.end_frame();
+    */
+    class vk_static_chunk_cache {
+    public:
+        static constexpr uint32_t InvalidChunk = UINT32_MAX;
+
+        vk_static_chunk_cache() = default;
+        vk_static_chunk_cache(uint32_t p_queue_family, uint32_t p_slot_count);
+
+        //! @note The chunk is recorded by the first execute() of each slot
+        uint32_t add(const static_chunk_record_function& p_record,
+                     size_t p_state = 0);
+
+        void remove(uint32_t p_chunk);
+
+        void mark_dirty(uint32_t p_chunk);
+
+        void mark_all_dirty();
+
+        //! @note Marks p_chunk dirty when p_state differs from the state it
+        //! was last given
+        void set_state(uint32_t p_chunk, size_t p_state);
+
+        //! @note Records the chunks that are dirty for p_slot, then executes
+        //! every chunk in the order they were added. Call once per frame,
+        //! between vk_swapchain::begin_frame(true) and end_frame()
+        void execute(const VkCommandBuffer& p_command_buffer,
+                     const secondary_inheritance& p_inheritance,
+                     uint32_t p_slot);
+
+        //! @note Chunk recordings made by the last execute()
+        uint32_t recorded() const { return m_recorded; }
+
+        //! @note Chunks currently in the cache
+        uint32_t size() const { return m_size; }
+
+        //! @note State to pass to set_state(), from the handles a chunk uses
+        template<typename... UHandles>
+        static size_t state_hash(const UHandles&... p_handles) {
+            size_t seed = 0;
+            hash_combine(seed, p_handles...);
+            return seed;
+        }
+
+        void destroy();
+
+    private:
+        struct chunk {
+            static_chunk_record_function Record;
+            size_t State = 0;
+            bool Active = false;
+            // indexed by slot, a null command buffer needs recording
+            std::vector<VkCommandBuffer> CommandBuffers;
+        };
+
+        struct retired_command_buffer {
+            VkCommandBuffer CommandBuffer = nullptr;
+            uint64_t Frame = 0;
+        };
+
+        //! @note Drops every recording of p_chunk, they are reused once no
+        //! frame in flight can execute them anymore
+        void retire(chunk& p_chunk);
+
+        VkCommandBuffer acquire_command_buffer();
+
+    private:
+        VkDevice m_driver = nullptr;
+        VkCommandPool m_command_pool = nullptr;
+        uint32_t m_slot_count = 0;
+        std::vector<chunk> m_chunks;
+        std::vector<uint32_t> m_free_chunks;
+        std::vector<VkCommandBuffer> m_free_command_buffers;
+        std::vector<retired_command_buffer> m_retired_command_buffers;
+        std::vector<VkCommandBuffer> m_executed;
+        secondary_inheritance m_inheritance{};
+        uint64_t m_frame = 0;
+        uint32_t m_size = 0;
+        uint32_t m_recorded = 0;
+    };
+};
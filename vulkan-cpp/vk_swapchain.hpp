@@ -6,6 +6,7 @@
 #include <vulkan-cpp/logger.hpp>
 #include <vulkan-cpp/vk_buffer.hpp>
 #include <vulkan-cpp/vk_command_buffer.hpp>
+#include <vulkan-cpp/vk_parallel_recorder.hpp>
 
 namespace vk {
     struct swapchain_configs {
@@ -15,53 +16,41 @@ namespace vk {
     public:
         // static uint32_t FrameIndex = 0;
         vk_swapchain() = default;
+        //! @note With p_dynamic_rendering (and device support) no
+        //! VkRenderPass or VkFramebuffer's get created, the frame renders
+        //! through vkCmdBeginRendering and get_renderpass() returns nullptr.
+        //! Pipelines then have to be built from the swapchain formats. Only
+        //! the begin_frame()/end_frame() loop is available then, the per
+        //! image command buffers record() and present() use are not created
         vk_swapchain(vk_physical_driver& p_physical,
                      const vk_driver& p_driver,
-                     const VkSurfaceKHR& p_surface);
+                     const VkSurfaceKHR& p_surface,
+                     bool p_dynamic_rendering = false);
         ~vk_swapchain() {}
 
         void set_background_color(const std::array<float, 4>& p_color) {
             m_color = { p_color[0], p_color[1], p_color[2], p_color[3] };
         }
 
+        //! @note Secondaries recorded for this swapchain draw with shader
+        //! objects, see secondary_inheritance::ShaderObjects. Only takes
+        //! effect with dynamic rendering
+        void set_shader_objects(bool p_enabled) {
+            m_shader_objects = p_enabled;
+        }
+
         void resize(uint32_t p_width, uint32_t p_height);
 
         template<typename UFunction>
         void record(const UFunction& p_callable) {
+            if (m_swapchain_command_buffers.empty()) {
+                console_log_error("vk_swapchain::record has no per image "
+                                  "command buffers with dynamic rendering, "
+                                  "use begin_frame() instead!!!");
+                return;
+            }
+
             console_log_info("vk_swapchain::record Begin recording!!!");
-            // VkClearValue clear_value = {};
-            // clear_value.color = m_color;
-            std::array<VkClearValue, 2> clear_values = {};
-            clear_values[0].color = m_color;
-            clear_values[1].depthStencil = { 1.0f, 0 };
-
-            // VkImageSubresourceRange image_range = {
-            //     .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-            //     .baseMipLevel = 0,
-            //     .levelCount = 1,
-            //     .baseArrayLayer = 0,
-            //     .layerCount = 1
-            // };
-
-            VkRenderPassBeginInfo renderpass_begin_info = {
-                .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-                .pNext = nullptr,
-                .renderPass = m_swapchain_renderpass,
-                .renderArea = {
-                    .offset = {
-                        .x = 0,
-                        .y = 0
-                    },
-                    .extent = {
-                        .width = m_swapchain_size.width,
-                        .height = m_swapchain_size.height
-                    },
-                },
-                // .clearValueCount = 1,
-                // .pClearValues = &clear_value
-                .clearValueCount = static_cast<uint32_t>(clear_values.size()),
-                .pClearValues = clear_values.data()
-            };
 
             for (uint32_t i = 0; i < m_swapchain_command_buffers.size(); i++) {
                 m_swapchain_command_buffers[i].begin(
@@ -85,13 +74,11 @@ namespace vk {
                 vkCmdSetScissor(
                   m_swapchain_command_buffers[i].handle(), 0, 1, &scissor);
 
-                renderpass_begin_info.framebuffer = m_swapchain_framebuffers[i];
+                begin_pass(m_swapchain_command_buffers[i], i, false);
 
-                vkCmdBeginRenderPass(m_swapchain_command_buffers[i],
-                                     &renderpass_begin_info,
-                                     VK_SUBPASS_CONTENTS_INLINE);
                 p_callable(m_swapchain_command_buffers[i].handle());
-                vkCmdEndRenderPass(m_swapchain_command_buffers[i]);
+
+                end_pass(m_swapchain_command_buffers[i], i);
                 m_swapchain_command_buffers[i].end();
             }
 
@@ -99,6 +86,44 @@ namespace vk {
               "vk_swapchain::record finished recording successfully!!!");
         }
 
+        //! @note Like record(), but p_callable records p_chunk_count chunks
+        //! into secondary command buffers on p_recorder's threads, which each
+        //! primary executes in chunk order. p_recorder needs a slot per
+        //! swapchain image
+        void record_parallel(vk_parallel_recorder& p_recorder,
+                             uint32_t p_chunk_count,
+                             const secondary_record_function& p_callable);
+
+        //! @note Waits until the frame slot submitted MaxFramesInFlight
+        //! frames ago has finished, resets its transient command pool in
+        //! bulk, acquires the next image and returns the slot's command
+        //! buffer. It is begun for a single submit, with the viewport,
+        //! scissor and pass of the acquired image set. With p_secondaries
+        //! the pass contents come from execute_parallel()
+        VkCommandBuffer begin_frame(bool p_secondaries = false);
+
+        //! @note Records p_chunk_count chunks on p_recorder's threads into
+        //! secondaries for this frame and executes them. Only valid between
+        //! begin_frame(true) and end_frame(), p_recorder needs
+        //! MaxFramesInFlight slots
+        void execute_parallel(vk_parallel_recorder& p_recorder,
+                              uint32_t p_chunk_count,
+                              const secondary_record_function& p_callable);
+
+        //! @note Closes the pass, submits the frame signaling the slot's
+        //! fence and presents the acquired image
+        void end_frame();
+
+        //! @note What secondaries executed in the frame begin_frame() is
+        //! recording inherit, ie for vk_static_chunk_cache::execute()
+        secondary_inheritance frame_inheritance() const {
+            return inheritance(m_current_image_index);
+        }
+
+        //! @note Frame in flight slot begin_frame() is recording, between 0
+        //! and MaxFramesInFlight
+        uint32_t frame_index() const { return m_frame_index; }
+
         vk_queue* current_queue() { return &m_swapchain_queue; }
 
         //! TODO: Probably want to do this better
@@ -106,6 +131,9 @@ namespace vk {
         //! called
         //! @note I put a variable to keep track of our current frame, this will
         //! be used when uniforms are in need to be updated
+        //! @note Passes the swapchain image, which is what record() indexes
+        //! by. Between begin_frame() and end_frame() per-frame data is
+        //! indexed by frame_index() instead
         template<typename UCallable>
         void update_uniforms(const UCallable& p_callable) {
             p_callable(m_current_image_index);
@@ -124,6 +152,13 @@ namespace vk {
             //     recreate();
             // }
 
+            if (m_swapchain_command_buffers.empty()) {
+                console_log_error("vk_swapchain::present has no per image "
+                                  "command buffers with dynamic rendering, "
+                                  "use end_frame() instead!!!");
+                return;
+            }
+
             m_swapchain_queue.wait_idle();
 
             uint32_t frame_idx = m_swapchain_queue.read_acquire_image();
@@ -161,6 +196,20 @@ namespace vk {
 
         VkRenderPass get_renderpass() const { return m_swapchain_renderpass; }
 
+        bool uses_dynamic_rendering() const { return m_dynamic_rendering; }
+
+        //! @note Formats of the attachments record() renders into, what
+        //! pipelines used with dynamic rendering have to be created with
+        VkFormat color_format() const {
+            return m_surface_data.SurfaceFormat.format;
+        }
+
+        VkFormat depth_format() const { return vk_driver::depth_format(); }
+
+        //! @note Queue family the swapchain command buffers are allocated
+        //! for, secondaries they execute have to use the same one
+        uint32_t queue_family() const { return m_queue_family; }
+
         VkExtent2D get_extent() const { return m_swapchain_size; }
 
         uint32_t current_frame() const { return m_current_image_index; }
@@ -174,7 +223,12 @@ namespace vk {
         //! vk_swapchain::current_active_comand_buffer() whenever we need to
         //! deal with transition_image_layout
         //! @note vk_texture will essentially be usedf to
+        //! @note With dynamic rendering this is the command buffer
+        //! begin_frame() is recording
         VkCommandBuffer current_active_comand_buffer() const {
+            if (m_swapchain_command_buffers.empty()) {
+                return m_frames[m_frame_index].CommandBuffer;
+            }
             return m_swapchain_command_buffers[m_current_image_index].handle();
         }
 
@@ -191,9 +245,7 @@ namespace vk {
         }
 
         static VkCommandBuffer current_active_buffer() {
-            return s_instance
-              ->m_swapchain_command_buffers[s_instance->m_current_image_index]
-              .handle();
+            return s_instance->current_active_comand_buffer();
         }
 
     private:
@@ -202,6 +254,34 @@ namespace vk {
 
         void select_swapchain_surface_formats();
 
+        //! @note Pools, fences and semaphores of every frame in flight
+        void create_frames();
+
+        void destroy_frames();
+
+        //! @note What secondaries executed in image p_index inherit
+        secondary_inheritance inheritance(uint32_t p_index) const;
+
+        //! @note Begins the render pass (or dynamic rendering) for image
+        //! p_index, with p_secondaries its contents come from
+        //! vkCmdExecuteCommands
+        void begin_pass(const VkCommandBuffer& p_command_buffer,
+                        uint32_t p_index,
+                        bool p_secondaries);
+
+        void end_pass(const VkCommandBuffer& p_command_buffer,
+                      uint32_t p_index);
+
+        //! @note Transitions image p_index to attachment layouts and begins
+        //! rendering into it (and its depth image) with vkCmdBeginRendering
+        void begin_rendering(const VkCommandBuffer& p_command_buffer,
+                             uint32_t p_index,
+                             VkRenderingFlags p_flags = 0);
+
+        //! @note Ends rendering and transitions image p_index for present
+        void end_rendering(const VkCommandBuffer& p_command_buffer,
+                           uint32_t p_index);
+
     private:
         // change swapchain background color
         VkClearColorValue m_color = { 0.5f, 0.5f, 0.5f, 0.f };
@@ -226,6 +306,7 @@ namespace vk {
         VkExtent2D m_swapchain_size;
         surface_properties m_surface_data{};
         VkQueue m_present_queue;
+        uint32_t m_queue_family = 0;
 
         // submit stuff
         std::deque<std::function<void(VkCommandBuffer)>> m_deletion_stuff;
@@ -248,10 +329,26 @@ namespace vk {
         // swapchain queue
         vk_queue m_swapchain_queue;
 
+        bool m_dynamic_rendering = false;
+        bool m_shader_objects = false;
         VkRenderPass m_swapchain_renderpass = nullptr;
         std::vector<VkFramebuffer> m_swapchain_framebuffers;
 
         // just to know which image to fetch
         uint32_t m_current_image_index = 0;
+
+        //! @note Everything begin_frame() recycles once Fence signals
+        struct frame_context {
+            VkCommandPool CommandPool = nullptr;
+            VkCommandBuffer CommandBuffer = nullptr;
+            VkFence Fence = nullptr;
+            VkSemaphore ImageAcquired = nullptr;
+        };
+
+        std::array<frame_context, swapchain_configs::MaxFramesInFlight>
+          m_frames{};
+        // per image, the image is presented once its rendering signals it
+        std::vector<VkSemaphore> m_render_completed_semaphores;
+        uint32_t m_frame_index = 0;
     };
 };
\ No newline at end of file
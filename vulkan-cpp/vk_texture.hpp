@@ -1,10 +1,67 @@
 #pragma once
 #include <string>
+#include <vector>
 #include <vulkan-cpp/vk_buffer.hpp>
 #include <vulkan-cpp/vk_driver.hpp>
-#include <vulkan-cpp/vk_command_buffer.hpp>
+#include <vulkan-cpp/vk_upload_batch.hpp>
 
 namespace vk {
+    int bytes_per_texture_format(VkFormat p_format);
+
+    //! @note p_max_lod of 0 only ever samples the first mip level, use
+    //! VK_LOD_CLAMP_NONE for textures with mip maps
+    VkSampler create_sampler(VkFilter MinFilter,
+                             VkFilter MaxFilter,
+                             VkSamplerAddressMode AddressMode,
+                             float p_max_lod = 0.0f);
+
+    VkImageView create_image_view(VkImage Image,
+                                  VkFormat Format,
+                                  VkImageAspectFlags AspectFlags,
+                                  uint32_t p_mip_levels = 1,
+                                  uint32_t p_array_layers = 1,
+                                  VkImageViewType p_view_type =
+                                    VK_IMAGE_VIEW_TYPE_2D);
+
+    image_data create_image2d(uint32_t p_width,
+                              uint32_t p_height,
+                              VkFormat p_format,
+                              VkImageUsageFlags p_usage,
+                              VkMemoryPropertyFlagBits p_property,
+                              uint32_t p_mip_levels = 1,
+                              uint32_t p_array_layers = 1);
+
+    //! @note TRANSFER_DST and SAMPLED usage for textures. HOST_TRANSFER gets
+    //! added when p_format can be uploaded through VK_EXT_host_image_copy
+    VkImageUsageFlags texture_usage_flags(VkFormat p_format);
+
+    //! @note Writes p_pixels into a single subresource of p_image straight
+    //! from host memory and leaves it in SHADER_READ_ONLY_OPTIMAL. No staging
+    //! buffer, command buffer or queue submission is involved.
+    //! @note Returns false when p_image was not created with HOST_TRANSFER
+    //! usage, the caller then has to go through vk_upload_batch
+    bool copy_memory_to_image(const image_data& p_image,
+                              VkFormat p_format,
+                              const void* p_pixels,
+                              uint32_t p_mip_level = 0,
+                              uint32_t p_array_layer = 0);
+
+    //! @note Number of mips in a full chain down to 1x1
+    uint32_t mip_level_count(uint32_t p_width, uint32_t p_height);
+
+    //! @note 2x2 box filter over RGBA8 texels, returns the next mip level.
+    //! Odd edges get clamped.
+    std::vector<uint8_t> downsample_rgba8(const uint8_t* p_pixels,
+                                          uint32_t p_width,
+                                          uint32_t p_height);
+
+    //! @note Returns the synchronization2 barrier with the stage and access
+    //! masks needed for transitioning p_image from p_old to p_new
+    VkImageMemoryBarrier2 image_memory_barrier2(VkImage p_image,
+                                                VkFormat p_format,
+                                                VkImageLayout p_old,
+                                                VkImageLayout p_new);
+
     /*
         Texture Mapping in Vulkan
 
@@ -53,27 +110,18 @@ namespace vk {
         * update_texture_image
 
     2. update_texture_image
-        * creating staging buffer
+        * acquire staging buffer from vk_staging_pool
         * map buffer
-        * transition_img_layout
-        * copy_buffer_to_image_layout
-        * transition_image_layout
-        * destroy staging buffer
-
-    3. transition_image_layout
-        * begin_command_bufer
-        * image_memory_barrier
-        * submit_copy_command_buffer
-
-    4. copy_buffer_to_image
-        * begin command buffer
-        * vkCmdCopyBufferToImage
-        * submit_copy_command_buffer
-
-    5. submit_copy_command_buffer (just submits to the queue)
-        - end_command_buffer
-        - submit to queue
-        - wait idle (or do VkFence stuff here)
+        * record upload into vk_upload_batch
+
+    3. vk_upload_batch::submit
+        * one vkCmdPipelineBarrier2 (UNDEFINED -> TRANSFER_DST) for all images
+        * vkCmdCopyBufferToImage for every image
+        * one vkCmdPipelineBarrier2 (TRANSFER_DST -> SHADER_READ_ONLY) for all
+          images
+        * single submission to the graphics queue, staging buffers go back to
+          the pool once the submission's fence signals
+
         NOTE HERE: There was an error when I tried to learn how to get textures
     working, and this is because I was submitting to the wrong queue. Instead of
     submitting to presentation queue, you submit through the graphics queue
@@ -87,6 +135,14 @@ namespace vk {
         //! TODO: NEED to do a better way of doing this.
         vk_texture(const std::string& p_filename);
 
+        //! @note Loads the texture and records its upload into p_batch, so a
+        //! group of textures can be uploaded with a single submission
+        vk_texture(const std::string& p_filename, vk_upload_batch& p_batch);
+
+        //! @note Takes ownership of an image that already has been created
+        //! and uploaded elsewhere (atlases, etc)
+        vk_texture(const image_data& p_image);
+
         /*
 
             1. CreateImage
@@ -101,48 +157,35 @@ namespace vk {
         // image_data& p_image_data, uint32_t p_width, uint32_t p_height,
         // VkFormat p_format, const void* p_pixels);
 
+        //! @note Uploads immediately. Uses VK_EXT_host_image_copy when the
+        //! image supports it, otherwise a single queue submission
         void update_texture(image_data& p_image_data,
                             uint32_t p_width,
                             uint32_t p_height,
                             VkFormat p_format,
                             const void* p_pixels);
 
-        // functions used by update texture
-
-        // functions for transition image layout
-        void transition_image_layout(VkImage& p_image,
-                                     VkFormat p_format,
-                                     VkImageLayout p_old,
-                                     VkImageLayout p_new);
-        void image_memory_barrier(VkCommandBuffer& p_command_buffer,
-                                  VkImage& p_image,
-                                  VkFormat p_format,
-                                  VkImageLayout p_old,
-                                  VkImageLayout p_new);
-
-        // functions for copy buffer to image
-        void copy_buffer_to_image(VkImage& p_image,
-                                  VkBuffer& p_buffer,
-                                  uint32_t p_width,
-                                  uint32_t p_height);
+        //! @note Records the upload into p_batch. Nothing gets submitted until
+        //! vk_upload_batch::submit is called
+        void update_texture(vk_upload_batch& p_batch,
+                            image_data& p_image_data,
+                            VkFormat p_format,
+                            const void* p_pixels);
 
         image_data data() const { return m_texture_image; }
 
         void destroy();
 
-        vk_command_buffer* get_command_buffer() {
-            return &m_copy_command_buffer;
-        }
-
         VkImageView image_view() const { return m_texture_image.ImageView; }
 
         VkSampler sampler() const { return m_texture_image.Sampler; }
 
+    private:
+        void load_from_file(const std::string& p_filename,
+                            vk_upload_batch& p_batch);
+
     private:
         vk_driver m_driver;
-        buffer_properties m_staging_buffer;
         image_data m_texture_image;
-        vk_command_buffer m_copy_command_buffer;
-        VkQueue m_graphics_queue = nullptr;
     };
 };
\ No newline at end of file
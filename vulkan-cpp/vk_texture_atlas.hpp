@@ -0,0 +1,173 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <span>
+#include <unordered_map>
+#include <glm/glm.hpp>
+#include <vulkan-cpp/vk_buffer.hpp>
+#include <vulkan-cpp/vk_texture.hpp>
+#include <vulkan-cpp/vk_upload_batch.hpp>
+#include <vulkan-cpp/uniforms.hpp>
+
+namespace vk {
+
+    enum atlas_layout : uint8_t {
+        //! @note Rectangle pack textures into pages, each page is one layer
+        ATLAS = 0,
+        //! @note Every texture gets its own layer of a 2D array texture
+        ARRAY = 1
+    };
+
+    struct atlas_packer_properties {
+        //! @note Width and height of every layer
+        uint32_t PageSize = 2048;
+        //! @note Number of mips that are generated without neighbouring
+        //! textures bleeding into each other
+        uint32_t MipLevels = 4;
+        atlas_layout Layout = atlas_layout::ATLAS;
+    };
+
+    //! @note Where a texture ended up inside of the packed array texture
+    struct atlas_region {
+        uint32_t Layer = 0;
+        glm::vec2 UvOffset = glm::vec2(0.f);
+        glm::vec2 UvScale = glm::vec2(1.f);
+    };
+
+    //! @note Push constant block read by shaders/atlas.frag. Sits right after
+    //! the vertex stage's object_push_constants
+    struct atlas_draw_constants {
+        static constexpr uint32_t Offset = sizeof(object_push_constants);
+
+        uint32_t Layer = 0;
+    };
+
+    //! @note Remaps mesh UVs in [0, 1] into p_region of the atlas. The atlas
+    //! is sampled with CLAMP_TO_EDGE, so wrapping UVs cannot repeat. Meshes
+    //! that tile have to keep their own texture
+    void remap_uvs(std::span<vertex> p_vertices, const atlas_region& p_region);
+
+    /*
+
+        texture_atlas
+            - Result of texture_atlas_packer::pack
+            - One VK_IMAGE_VIEW_TYPE_2D_ARRAY image, view and sampler that is
+       shared by every texture that was packed into it, so a prop-heavy scene
+       only writes a single combined image sampler descriptor
+
+        Shaders sample it with a sampler2DArray (see shaders/atlas.frag), the
+       UVs are remapped on the mesh with remap_uvs() and the layer is pushed
+       per draw
+
+        atlas_region crate = atlas.region("crate");
+        atlas_draw_constants constants = { .Layer = crate.Layer };
+        pipeline.push_constants(command_buffer,
+                                VK_SHADER_STAGE_FRAGMENT_BIT,
+                                constants,
+                                atlas_draw_constants::Offset);
+    */
+    class texture_atlas {
+    public:
+        texture_atlas() = default;
+
+        bool contains(const std::string& p_name) const {
+            return m_regions.contains(p_name);
+        }
+
+        atlas_region region(const std::string& p_name) const {
+            return m_regions.at(p_name);
+        }
+
+        //! @note Can be passed to vk_descriptor_set::update_texture like any
+        //! other texture
+        const vk_texture& texture() const { return m_texture; }
+
+        uint32_t layer_count() const { return m_layer_count; }
+
+        void destroy() { m_texture.destroy(); }
+
+    private:
+        friend class texture_atlas_packer;
+        vk_texture m_texture;
+        uint32_t m_layer_count = 0;
+        std::unordered_map<std::string, atlas_region> m_regions;
+    };
+
+    /*
+
+        texture_atlas_packer
+            - Import-time packer that combines small RGBA8 textures into one
+       2D array texture
+            - Textures are shelf packed tallest first. Every rectangle starts on
+       and is padded to a multiple of 2^(MipLevels - 1) texels, so each of the
+       generated mips still has at least one texel of gutter between textures
+            - Gutters get filled by extruding the edge texels of the texture
+       they surround, so bilinear filtering never blends in a neighbour
+
+        Usage
+
+        texture_atlas_packer packer({ .PageSize = 1024 });
+        packer.add("crate", "textures/crate.png");
+        packer.add("barrel", "textures/barrel.png");
+
+        vk_upload_batch batch = vk_upload_batch();
+        texture_atlas atlas = packer.pack(batch);
+        batch.submit();
+
+        remap_uvs(crate_vertices, atlas.region("crate"));
+    */
+    class texture_atlas_packer {
+        struct source_texture {
+            std::string Name;
+            uint32_t Width = 0;
+            uint32_t Height = 0;
+            std::vector<uint8_t> Pixels;
+        };
+
+        struct placement {
+            uint32_t Layer = 0;
+            uint32_t X = 0;
+            uint32_t Y = 0;
+        };
+
+    public:
+        texture_atlas_packer() = default;
+        texture_atlas_packer(const atlas_packer_properties& p_properties);
+
+        //! @note Returns false if p_filename could not be loaded
+        bool add(const std::string& p_name, const std::string& p_filename);
+
+        //! @note p_pixels is RGBA8 and gets copied
+        void add(const std::string& p_name,
+                 const uint8_t* p_pixels,
+                 uint32_t p_width,
+                 uint32_t p_height);
+
+        //! @note Creates the array texture and records its upload into
+        //! p_batch. The texture is ready to sample after p_batch.submit()
+        texture_atlas pack(vk_upload_batch& p_batch);
+
+    private:
+        uint32_t alignment() const {
+            return 1u << (m_properties.MipLevels - 1);
+        }
+
+        //! @note Returns the number of pages needed. Textures that do not fit
+        //! inside of a page are placed on layer UINT32_MAX
+        uint32_t shelf_pack(std::vector<placement>& p_placements);
+
+        void blit_padded(std::vector<uint8_t>& p_page,
+                         uint32_t p_page_size,
+                         const source_texture& p_texture,
+                         const placement& p_placement,
+                         uint32_t p_slot_width,
+                         uint32_t p_slot_height,
+                         uint32_t p_padding);
+
+    private:
+        atlas_packer_properties m_properties;
+        std::vector<source_texture> m_textures;
+    };
+};
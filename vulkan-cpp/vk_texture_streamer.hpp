@@ -0,0 +1,258 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <vulkan-cpp/vk_buffer.hpp>
+#include <vulkan-cpp/vk_driver.hpp>
+#include <vulkan-cpp/vk_upload_batch.hpp>
+
+namespace vk {
+
+    using streamed_texture_id = uint32_t;
+
+    //! @note Mip level that gives roughly one texel per pixel when the texture
+    //! is sampled with p_uv_per_pixel, which is max(|dUV/dx|, |dUV/dy|)
+    uint32_t mip_from_uv_derivative(float p_uv_per_pixel,
+                                    uint32_t p_texture_size);
+
+    //! @note Mip level needed for an object of p_object_radius at p_distance
+    //! from the camera, assuming the texture is mapped once across the object
+    uint32_t mip_from_distance(float p_distance,
+                               float p_object_radius,
+                               float p_fov_y,
+                               uint32_t p_viewport_height,
+                               uint32_t p_texture_size);
+
+    struct streaming_stats {
+        uint64_t BudgetBytes = 0;
+        uint64_t ResidentBytes = 0;
+        uint64_t RequestedBytes = 0;
+        uint32_t TextureCount = 0;
+        uint32_t FullyResidentCount = 0;
+        uint32_t PendingLoads = 0;
+        uint32_t PendingUploads = 0;
+        uint32_t PendingDestroys = 0;
+        //! @note Running totals since the streamer got created
+        uint64_t MipsLoaded = 0;
+        uint64_t MipsEvicted = 0;
+    };
+
+    /*
+
+        vk_texture_streamer
+            - Keeps textures resident only down to the mip level they are
+       actually sampled at, rather than every texture being all-or-nothing like
+       vk_texture
+            - Each texture's resident image only contains the mip chain from
+       its resident base mip down to 1x1
+
+        Usage
+
+        vk_texture_streamer streamer(512 * 1024 * 1024);
+        streamed_texture_id bricks = streamer.add("textures/bricks.jpg");
+
+        // every frame
+        streamer.request_mip(bricks, mip_from_distance(...));
+        streamer.update();
+
+        if (streamer.is_resident(bricks)) {
+            image_data image = streamer.data(bricks);
+        }
+
+        How streaming works
+
+        1. request_* calls record the most detailed mip each texture needs
+        this frame
+        2. update() fits the requested mips inside the VRAM budget. Textures
+        that were requested least recently lose detail first
+        3. Textures that have to give up detail are recreated with fewer
+        mips right away, the mips they keep are copied from the resident image
+        on the GPU so eviction never touches the file
+        4. Textures that gain detail get loaded by a worker thread, which
+        decodes the file and builds the mip chain from the new base mip. The
+        render thread never waits on file IO
+        5. update() uploads finished mip chains and evictions with a single
+        vk_upload_batch submission without waiting for it. A later update()
+        swaps the new images in once the submission's fence signaled, until
+        then the textures keep sampling their previous image. The previous
+        image is destroyed MaxFramesInFlight frames after the swap, once no
+        in-flight frame samples it
+
+        Image views change whenever residency changes, so whoever samples the
+        texture has to re-write their descriptors in the residency callback.
+    */
+    class vk_texture_streamer {
+        struct streamed_texture {
+            std::string Filename;
+            uint32_t Width = 0;
+            uint32_t Height = 0;
+            uint32_t MipCount = 0;
+            //! @note Mip level of the original texture that is the first mip
+            //! of Image. MipCount means nothing is resident yet
+            uint32_t ResidentMip = 0;
+            //! @note Most detailed mip requested since the last update()
+            uint32_t RequestedMip = 0;
+            bool LoadPending = false;
+            //! @note A new image is being uploaded, it replaces Image once
+            //! the upload finished
+            bool UploadPending = false;
+            uint64_t LastRequestedFrame = 0;
+            image_data Image;
+        };
+
+        //! @note Carries its own copy of the filename so the worker thread
+        //! never has to read m_textures
+        struct load_request {
+            streamed_texture_id Id = 0;
+            uint32_t BaseMip = 0;
+            std::string Filename;
+        };
+
+        struct loaded_mip_chain {
+            streamed_texture_id Id = 0;
+            uint32_t BaseMip = 0;
+            uint32_t Width = 0;
+            uint32_t Height = 0;
+            //! @note Tightly packed RGBA8 mips, from BaseMip down to 1x1
+            std::vector<std::vector<uint8_t>> Mips;
+        };
+
+        struct retired_image {
+            image_data Image;
+            uint64_t DestroyFrame = 0;
+        };
+
+        //! @note Image starting at mip BaseMip, made resident once the upload
+        //! writing it finished
+        struct staged_image {
+            streamed_texture_id Id = 0;
+            uint32_t BaseMip = 0;
+            image_data Image;
+        };
+
+        struct pending_upload {
+            vk_upload_batch Batch;
+            std::vector<staged_image> Images;
+        };
+
+    public:
+        static constexpr VkFormat Format = VK_FORMAT_R8G8B8A8_UNORM;
+        //! @note Upper bound on mip chains uploaded by a single update()
+        static constexpr uint32_t MaxUploadsPerUpdate = 8;
+        //! @note Textures start out with mips no larger than this resident
+        static constexpr uint32_t InitialResidentSize = 64;
+
+        vk_texture_streamer() = default;
+        vk_texture_streamer(uint64_t p_budget_bytes);
+
+        //! @note The worker thread holds on to this
+        vk_texture_streamer(const vk_texture_streamer&) = delete;
+        vk_texture_streamer(vk_texture_streamer&&) = delete;
+        vk_texture_streamer& operator=(const vk_texture_streamer&) = delete;
+        vk_texture_streamer& operator=(vk_texture_streamer&&) = delete;
+
+        //! @note Only reads the image header, pixels get loaded on the worker
+        //! thread once update() schedules them
+        streamed_texture_id add(const std::string& p_filename);
+
+        //! @note Lowers the detail the texture is kept at. Requests from the
+        //! same frame are combined by keeping the most detailed one
+        void request_mip(streamed_texture_id p_id, uint32_t p_mip);
+
+        void request_by_distance(streamed_texture_id p_id,
+                                 float p_distance,
+                                 float p_object_radius,
+                                 float p_fov_y,
+                                 uint32_t p_viewport_height);
+
+        void request_by_uv_derivative(streamed_texture_id p_id,
+                                      float p_uv_per_pixel);
+
+        //! @note Call once per frame from the thread that owns the graphics
+        //! queue
+        void update();
+
+        //! @note Invoked from update() whenever a texture's image view and
+        //! sampler have been replaced
+        void on_residency_changed(
+          const std::function<void(streamed_texture_id, const image_data&)>&
+            p_callback) {
+            m_residency_changed = p_callback;
+        }
+
+        void set_budget(uint64_t p_budget_bytes) {
+            m_budget_bytes = p_budget_bytes;
+        }
+
+        bool is_resident(streamed_texture_id p_id) const {
+            return m_textures[p_id].Image.ImageView != nullptr;
+        }
+
+        uint32_t resident_mip(streamed_texture_id p_id) const {
+            return m_textures[p_id].ResidentMip;
+        }
+
+        image_data data(streamed_texture_id p_id) const {
+            return m_textures[p_id].Image;
+        }
+
+        streaming_stats stats() const;
+
+        void destroy();
+
+    private:
+        void worker_loop();
+
+        loaded_mip_chain load_mip_chain(const load_request& p_request);
+
+        //! @note Returns the most detailed mip per texture that keeps the sum
+        //! of all textures inside the budget
+        std::vector<uint32_t> fit_to_budget();
+
+        //! @note Returns false when the worker failed to load the mip chain
+        bool integrate(loaded_mip_chain& p_chain, pending_upload& p_upload);
+
+        //! @note Stages an image starting at p_base_mip to replace the
+        //! resident one, copied from the mips it already has
+        void evict(streamed_texture_id p_id,
+                   uint32_t p_base_mip,
+                   pending_upload& p_upload);
+
+        //! @note Swaps in the images of uploads that finished, returns the
+        //! textures whose residency changed
+        std::vector<streamed_texture_id> complete_uploads();
+
+        void retire(const image_data& p_image);
+
+        void destroy_image(const image_data& p_image);
+
+    private:
+        vk_driver m_driver;
+        uint64_t m_budget_bytes = 0;
+        uint64_t m_frame = 0;
+        uint64_t m_mips_loaded = 0;
+        uint64_t m_mips_evicted = 0;
+        std::vector<streamed_texture> m_textures;
+        std::vector<retired_image> m_retired_images;
+        std::vector<pending_upload> m_pending_uploads;
+        //! @note Batches of finished uploads, reused so their command pools
+        //! are not recreated every update()
+        std::vector<vk_upload_batch> m_free_batches;
+        std::function<void(streamed_texture_id, const image_data&)>
+          m_residency_changed;
+
+        // shared with the worker thread
+        std::thread m_worker;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_stop = false;
+        std::deque<load_request> m_load_requests;
+        std::vector<loaded_mip_chain> m_loaded;
+    };
+};
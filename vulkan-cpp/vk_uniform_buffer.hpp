@@ -13,6 +13,10 @@ namespace vk {
 
         void update(const void* p_data, size_t p_size_in_bytes);
 
+        uint32_t size_bytes() const {
+            return m_uniform_buffer_data.AllocateDeviceSize;
+        }
+
         operator VkBuffer() { return m_uniform_buffer_data.BufferHandler; }
 
         operator VkBuffer() const {
@@ -0,0 +1,131 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <vulkan-cpp/vk_buffer.hpp>
+#include <vulkan-cpp/vk_driver.hpp>
+#include <vulkan-cpp/vk_command_buffer.hpp>
+
+namespace vk {
+
+    /*
+
+        vk_upload_batch
+            - Records image uploads for a group of textures into a single
+       command buffer
+            - All layout transitions happen in one barrier batch before the
+       copies and one barrier batch after them, so uploading N textures costs a
+       single queue submission rather than three submissions per texture
+
+        Usage
+
+        vk_upload_batch batch = vk_upload_batch();
+        vk_texture bricks("textures/bricks.jpg", batch);
+        vk_texture viking_room("models/viking_room.png", batch);
+        batch.submit();
+        batch.destroy();
+
+        // or without blocking, whoever uses the images checks back later
+        batch.submit_async();
+        ...
+        if (batch.is_complete()) { ... }
+
+        Recorded commands look like the following
+
+        1. vkCmdPipelineBarrier2 (UNDEFINED -> TRANSFER_DST for all images)
+        2. vkCmdCopyBufferToImage (one per image), vkCmdCopyImage (one per
+       copy())
+        3. vkCmdPipelineBarrier2 (TRANSFER_DST -> SHADER_READ_ONLY for all
+       images)
+
+        Devices without synchronization2 record the same batches with
+       vkCmdPipelineBarrier and submit with vkQueueSubmit
+    */
+    class vk_upload_batch {
+        struct image_upload {
+            VkImage Image = nullptr;
+            VkFormat Format = VK_FORMAT_UNDEFINED;
+            uint32_t Width = 0;
+            uint32_t Height = 0;
+            uint32_t MipLevel = 0;
+            uint32_t ArrayLayer = 0;
+            VkBuffer Staging = nullptr;
+        };
+
+        struct image_copy {
+            VkImage Source = nullptr;
+            uint32_t SourceMip = 0;
+            VkImage Destination = nullptr;
+            uint32_t DestinationMip = 0;
+            uint32_t Width = 0;
+            uint32_t Height = 0;
+        };
+
+    public:
+        vk_upload_batch();
+
+        //! @note Copies p_pixels into staging memory right away, so the
+        //! caller is free to release p_pixels once this returns. Needs a
+        //! vk_staging_pool, without one an error is logged and nothing added
+        //! @note p_pixels only contains the pixels for p_mip_level, its
+        //! extent gets derived from the image's width and height
+        //! @note Images created with HOST_TRANSFER usage get written right
+        //! away through VK_EXT_host_image_copy and nothing is recorded
+        void add(const image_data& p_image,
+                 VkFormat p_format,
+                 const void* p_pixels,
+                 uint32_t p_mip_level = 0,
+                 uint32_t p_array_layer = 0);
+
+        //! @note Copies mip p_source_mip of p_source into mip
+        //! p_destination_mip of p_destination on the GPU, both are color
+        //! images of the same format sampled by shaders. p_source goes back
+        //! to SHADER_READ_ONLY_OPTIMAL afterwards, so it can be sampled until
+        //! p_destination replaces it, ie when a texture drops its most
+        //! detailed mips
+        void copy(const image_data& p_source,
+                  uint32_t p_source_mip,
+                  const image_data& p_destination,
+                  uint32_t p_destination_mip);
+
+        //! @note Submits every recorded upload at once and waits until the
+        //! upload finished. Staging buffers are handed back to vk_staging_pool
+        void submit();
+
+        //! @note Submits every recorded upload at once without waiting, the
+        //! images can only be used once is_complete() returns true. Nothing
+        //! can be added until then
+        void submit_async();
+
+        //! @note Polls the fence of submit_async(), once it signaled the
+        //! staging buffers go back to vk_staging_pool. True when nothing is
+        //! in flight
+        bool is_complete();
+
+        //! @note Blocks until the submission of submit_async() finished
+        void wait();
+
+        size_t size() const { return m_uploads.size() + m_copies.size(); }
+
+        bool empty() const { return m_uploads.empty() and m_copies.empty(); }
+
+        void destroy();
+
+    private:
+        //! @note Records the barriers and copies of every upload
+        void record();
+
+        void submit_commands(VkFence p_fence);
+
+    private:
+        vk_driver m_driver;
+        VkQueue m_graphics_queue = nullptr;
+        bool m_synchronization2 = false;
+        vk_command_buffer m_command_buffer;
+        //! @note Created by the first submission
+        VkFence m_fence = nullptr;
+        bool m_in_flight = false;
+        std::vector<image_upload> m_uploads;
+        std::vector<image_copy> m_copies;
+        std::vector<buffer_properties> m_staging_buffers;
+    };
+};